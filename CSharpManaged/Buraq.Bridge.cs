@@ -1,45 +1,889 @@
 using System;
+using System.Buffers.Binary;
+using System.Collections.Concurrent;
 using System.IO;
-using System.Net;
+using System.IO.MemoryMappedFiles;
+using System.IO.Pipes;
+using System.Management.Automation.Runspaces;
 using System.Net.Sockets;
+using System.Runtime.Versioning;
+using System.Security.Cryptography;
+using System.Text;
+using System.Text.Json;
+using System.Threading;
+using System.Threading.Channels;
 using System.Threading.Tasks;
 using Buraq.PS; // Your namespace containing PowerShellManager
 
 namespace Buraq.Bridge
 {
+    // Keep in sync with app/clients/PSClient/BridgeProtocol.h
+    enum MessageType : byte
+    {
+        Run = 1,
+        Cancel = 2,
+        Output = 3,
+        Error = 4,
+        Progress = 5,
+        Completed = 6,
+        Configure = 7,
+        Hello = 8,
+        Ring = 9,
+        BulkOutput = 10,
+        Records = 11,
+        ErrorRecords = 12,
+    }
+
+    [Flags]
+    enum RunFlags : byte
+    {
+        None = 0,
+        // Run on the session runspace of the connection, which keeps its state between runs
+        Sticky = 1,
+    }
+
+    // Payload of a Configure frame
+    sealed record BridgeConfiguration(int PoolSize, string[] Modules);
+
+    enum RunStatus
+    {
+        Succeeded = 0,
+        Failed = 1,
+        Cancelled = 2,
+    }
+
+    readonly record struct Frame(MessageType Type, byte Flags, long RequestId, byte[] Payload);
+
+    // Memory mapped file made by the app, through which large outputs skip the socket.
+    // Keep the layout in sync with app/clients/PSClient/SharedRing.h
+    sealed unsafe class SharedRing : IDisposable
+    {
+        private const uint Magic = 0x52515242;
+        private const uint Version = 1;
+        private const int CapacityOffset = 8;
+        private const int TailOffset = 64;
+        private const int DataOffset = 128;
+
+        private readonly MemoryMappedFile _file;
+        private readonly MemoryMappedViewAccessor _view;
+        private readonly byte* _base;
+        private readonly long _capacity;
+
+        // Offset of the next block; offsets below the tail the app publishes may be overwritten
+        private long _head;
+
+        private SharedRing(MemoryMappedFile file, MemoryMappedViewAccessor view, byte* pointer, long capacity)
+        {
+            _file = file;
+            _view = view;
+            _base = pointer;
+            _capacity = capacity;
+        }
+
+        public long Capacity => _capacity;
+
+        // Returns null if the file is missing or not a ring
+        public static SharedRing? Open(string path)
+        {
+            MemoryMappedFile? file = null;
+            MemoryMappedViewAccessor? view = null;
+            try
+            {
+                var stream = new FileStream(path, FileMode.Open, FileAccess.ReadWrite,
+                    FileShare.ReadWrite | FileShare.Delete);
+                long length = stream.Length;
+                file = MemoryMappedFile.CreateFromFile(stream, null, 0, MemoryMappedFileAccess.ReadWrite,
+                    HandleInheritability.None, leaveOpen: false);
+                view = file.CreateViewAccessor(0, 0, MemoryMappedFileAccess.ReadWrite);
+
+                byte* pointer = null;
+                view.SafeMemoryMappedViewHandle.AcquirePointer(ref pointer);
+                pointer += view.PointerOffset;
+
+                long capacity = *(long*)(pointer + CapacityOffset);
+                if (*(uint*)pointer == Magic && *(uint*)(pointer + 4) == Version && capacity > 0 &&
+                    DataOffset + capacity <= length)
+                {
+                    return new SharedRing(file, view, pointer, capacity);
+                }
+
+                view.SafeMemoryMappedViewHandle.ReleasePointer();
+                Console.WriteLine($"Ignoring {path}, it is not a shared ring.");
+            }
+            catch (Exception ex) when (ex is IOException or UnauthorizedAccessException or ArgumentException)
+            {
+                Console.WriteLine($"Cannot open the shared ring {path}: {ex.Message}");
+            }
+
+            view?.Dispose();
+            file?.Dispose();
+            return null;
+        }
+
+        // Encodes text into the next free block. False if the ring has no room for it right now.
+        public bool TryWrite(string text, int byteCount, out long offset)
+        {
+            offset = 0;
+            long tail = Volatile.Read(ref *(long*)(_base + TailOffset));
+
+            // A block never wraps, the end of the data area is skipped instead
+            long index = _head % _capacity;
+            long skip = index + byteCount > _capacity ? _capacity - index : 0;
+            if (byteCount > _capacity || _head + skip + byteCount - tail > _capacity)
+            {
+                return false;
+            }
+
+            offset = _head + skip;
+            Encoding.UTF8.GetBytes(text, new Span<byte>(_base + DataOffset + offset % _capacity, byteCount));
+            _head = offset + byteCount;
+            return true;
+        }
+
+        public void Dispose()
+        {
+            _view.SafeMemoryMappedViewHandle.ReleasePointer();
+            _view.Dispose();
+            _file.Dispose();
+        }
+    }
+
+    // Every message is a 16 byte little endian header (u32 payload length, u64 request id,
+    // u8 type, u8 flags, u16 reserved) followed by the payload.
+    sealed class FrameStream
+    {
+        public const int HeaderSize = 16;
+        public const int MaxPayload = 64 * 1024 * 1024;
+
+        // Long texts are cut into several frames of at most this many chars
+        private const int MaxTextChunk = 256 * 1024;
+
+        // Texts of at least this many chars go through the shared ring when there is one
+        private const int MinBulkChars = 4 * 1024;
+
+        private readonly Stream _stream;
+
+        // Frames of concurrent runs must not interleave on the stream
+        private readonly SemaphoreSlim _writeLock = new(1, 1);
+
+        // Filled in the order its BulkOutput frames are sent, so only used under _writeLock
+        private SharedRing? _ring;
+
+        public bool HasRing => Volatile.Read(ref _ring) != null;
+
+        public FrameStream(Stream stream)
+        {
+            _stream = stream;
+        }
+
+        // Returns null once the client closed the connection
+        public async Task<Frame?> ReadAsync()
+        {
+            var header = new byte[HeaderSize];
+            int read = await _stream.ReadAtLeastAsync(header, HeaderSize, throwOnEndOfStream: false);
+            if (read == 0)
+            {
+                return null;
+            }
+            if (read < HeaderSize)
+            {
+                throw new EndOfStreamException("Connection closed inside a frame header.");
+            }
+
+            uint length = BinaryPrimitives.ReadUInt32LittleEndian(header);
+            if (length > MaxPayload)
+            {
+                throw new InvalidDataException($"Frame of {length} bytes exceeds the limit.");
+            }
+
+            var payload = new byte[length];
+            await _stream.ReadExactlyAsync(payload);
+
+            return new Frame((MessageType)header[12], header[13],
+                BinaryPrimitives.ReadInt64LittleEndian(header.AsSpan(4)), payload);
+        }
+
+        public async Task WriteAsync(MessageType type, long requestId, ReadOnlyMemory<byte> payload, byte flags = 0)
+        {
+            byte[] frame = Encode(type, requestId, payload, flags);
+
+            await _writeLock.WaitAsync();
+            try
+            {
+                await _stream.WriteAsync(frame);
+                await _stream.FlushAsync();
+            }
+            finally
+            {
+                _writeLock.Release();
+            }
+        }
+
+        // Replaces the ring of the connection; null or a path that cannot be opened leaves it without one
+        public async Task SetRingAsync(string? path)
+        {
+            SharedRing? ring = path == null ? null : SharedRing.Open(path);
+
+            await _writeLock.WaitAsync();
+            try
+            {
+                _ring?.Dispose();
+                Volatile.Write(ref _ring, ring);
+            }
+            finally
+            {
+                _writeLock.Release();
+            }
+        }
+
+        public async Task WriteTextAsync(MessageType type, long requestId, string text, byte flags = 0)
+        {
+            if (text.Length >= MinBulkChars && HasRing && await TryWriteBulkAsync(type, requestId, text, flags))
+            {
+                return;
+            }
+
+            for (int start = 0; start < text.Length;)
+            {
+                int length = Math.Min(MaxTextChunk, text.Length - start);
+
+                // Each frame must be valid UTF-8 on its own, so surrogate pairs are not split
+                if (start + length < text.Length && char.IsHighSurrogate(text[start + length - 1]))
+                {
+                    length--;
+                }
+
+                await WriteAsync(type, requestId, Encoding.UTF8.GetBytes(text, start, length), flags);
+                start += length;
+            }
+        }
+
+        // Sends text as a BulkOutput frame pointing into the ring. False if there is no ring or no room in it.
+        private async Task<bool> TryWriteBulkAsync(MessageType type, long requestId, string text, byte flags)
+        {
+            int byteCount = Encoding.UTF8.GetByteCount(text);
+
+            await _writeLock.WaitAsync();
+            try
+            {
+                if (_ring is not { } ring || byteCount > ring.Capacity / 4 || !ring.TryWrite(text, byteCount, out long offset))
+                {
+                    return false;
+                }
+
+                var payload = new byte[sizeof(long) + sizeof(uint)];
+                BinaryPrimitives.WriteInt64LittleEndian(payload, offset);
+                BinaryPrimitives.WriteUInt32LittleEndian(payload.AsSpan(sizeof(long)), (uint)byteCount);
+
+                // Error records travel in the Error stream of the flags, as on the app side
+                byte stream = type == MessageType.Error ? (byte)RecordStream.Error : flags;
+                await _stream.WriteAsync(Encode(MessageType.BulkOutput, requestId, payload, stream));
+                await _stream.FlushAsync();
+                return true;
+            }
+            finally
+            {
+                _writeLock.Release();
+            }
+        }
+
+        private static byte[] Encode(MessageType type, long requestId, ReadOnlyMemory<byte> payload, byte flags)
+        {
+            var frame = new byte[HeaderSize + payload.Length];
+            BinaryPrimitives.WriteUInt32LittleEndian(frame, (uint)payload.Length);
+            BinaryPrimitives.WriteInt64LittleEndian(frame.AsSpan(4), requestId);
+            frame[12] = (byte)type;
+            frame[13] = flags;
+            payload.CopyTo(frame.AsMemory(HeaderSize));
+            return frame;
+        }
+
+        // Payload of Progress and Completed: an i32 followed by UTF-8 text
+        public Task WriteStatusAsync(MessageType type, long requestId, int value, string text)
+        {
+            var payload = new byte[4 + Encoding.UTF8.GetByteCount(text)];
+            BinaryPrimitives.WriteInt32LittleEndian(payload, value);
+            Encoding.UTF8.GetBytes(text, payload.AsSpan(4));
+            return WriteAsync(type, requestId, payload);
+        }
+    }
+
+    // Just enough of CBOR (RFC 8949) for result records: definite lengths, big endian heads
+    sealed class CborWriter
+    {
+        private byte[] _buffer = new byte[4096];
+
+        public int Length { get; private set; }
+
+        public ReadOnlyMemory<byte> Written => _buffer.AsMemory(0, Length);
+
+        public void Clear() => Length = 0;
+
+        public void WriteArrayHeader(int count) => WriteHead(4, (ulong)count);
+
+        public void WriteInt(long value)
+        {
+            if (value >= 0)
+            {
+                WriteHead(0, (ulong)value);
+            }
+            else
+            {
+                WriteHead(1, (ulong)(-1 - value));
+            }
+        }
+
+        public void WriteUInt(ulong value) => WriteHead(0, value);
+
+        public void WriteText(string text)
+        {
+            int count = Encoding.UTF8.GetByteCount(text);
+            WriteHead(3, (ulong)count);
+            Reserve(count);
+            Length += Encoding.UTF8.GetBytes(text, _buffer.AsSpan(Length));
+        }
+
+        public void WriteBytes(ReadOnlySpan<byte> bytes)
+        {
+            WriteHead(2, (ulong)bytes.Length);
+            Reserve(bytes.Length);
+            bytes.CopyTo(_buffer.AsSpan(Length));
+            Length += bytes.Length;
+        }
+
+        public void WriteTag(ulong tag) => WriteHead(6, tag);
+
+        public void WriteBool(bool value) => WriteByte(value ? (byte)0xF5 : (byte)0xF4);
+
+        public void WriteNull() => WriteByte(0xF6);
+
+        public void WriteDouble(double value)
+        {
+            Reserve(9);
+            _buffer[Length] = 0xFB;
+            BinaryPrimitives.WriteDoubleBigEndian(_buffer.AsSpan(Length + 1), value);
+            Length += 9;
+        }
+
+        // The shortest head that holds value, as deterministic encoding asks
+        private void WriteHead(int major, ulong value)
+        {
+            byte type = (byte)(major << 5);
+            Reserve(9);
+            Span<byte> head = _buffer.AsSpan(Length);
+            if (value < 24)
+            {
+                head[0] = (byte)(type | (byte)value);
+                Length += 1;
+            }
+            else if (value <= byte.MaxValue)
+            {
+                head[0] = (byte)(type | 24);
+                head[1] = (byte)value;
+                Length += 2;
+            }
+            else if (value <= ushort.MaxValue)
+            {
+                head[0] = (byte)(type | 25);
+                BinaryPrimitives.WriteUInt16BigEndian(head[1..], (ushort)value);
+                Length += 3;
+            }
+            else if (value <= uint.MaxValue)
+            {
+                head[0] = (byte)(type | 26);
+                BinaryPrimitives.WriteUInt32BigEndian(head[1..], (uint)value);
+                Length += 5;
+            }
+            else
+            {
+                head[0] = (byte)(type | 27);
+                BinaryPrimitives.WriteUInt64BigEndian(head[1..], value);
+                Length += 9;
+            }
+        }
+
+        private void WriteByte(byte value)
+        {
+            Reserve(1);
+            _buffer[Length++] = value;
+        }
+
+        private void Reserve(int count)
+        {
+            if (_buffer.Length - Length < count)
+            {
+                Array.Resize(ref _buffer, Math.Max(_buffer.Length * 2, Length + count));
+            }
+        }
+    }
+
+    // Encodes the records of one run as Records and ErrorRecords payloads, see BridgeProtocol.h.
+    // The property names of a type go out once per run, right before its first record.
+    sealed class RecordEncoder
+    {
+        private const int TypeItem = 0;
+        private const int RowItem = 1;
+
+        private readonly CborWriter _writer = new();
+        private readonly Dictionary<string, int> _types = new();
+
+        public int Length => _writer.Length;
+
+        // Valid until the next write or Clear
+        public ReadOnlyMemory<byte> Written => _writer.Written;
+
+        public void Clear() => _writer.Clear();
+
+        public void WriteObject(ObjectRecord record)
+        {
+            // Objects of one type name may still differ in properties, PSCustomObject and hashtables do
+            string key = record.TypeName + "\0" + string.Join("\0", record.Names);
+            if (!_types.TryGetValue(key, out int typeId))
+            {
+                typeId = _types.Count;
+                _types.Add(key, typeId);
+
+                _writer.WriteArrayHeader(4);
+                _writer.WriteInt(TypeItem);
+                _writer.WriteInt(typeId);
+                _writer.WriteText(record.TypeName);
+                _writer.WriteArrayHeader(record.Names.Length);
+                foreach (string name in record.Names)
+                {
+                    _writer.WriteText(name);
+                }
+            }
+
+            _writer.WriteArrayHeader(3);
+            _writer.WriteInt(RowItem);
+            _writer.WriteInt(typeId);
+            _writer.WriteArrayHeader(record.Values.Length);
+            foreach (object? value in record.Values)
+            {
+                WriteValue(value);
+            }
+        }
+
+        public void WriteError(ErrorDetails error)
+        {
+            _writer.WriteArrayHeader(8);
+            _writer.WriteText(error.Message);
+            _writer.WriteText(error.ErrorId);
+            _writer.WriteText(error.Category);
+            WriteValue(error.Target);
+            WriteValue(error.ExceptionType);
+            WriteValue(error.ScriptStackTrace);
+            _writer.WriteInt(error.Line);
+            _writer.WriteInt(error.Column);
+        }
+
+        private void WriteValue(object? value)
+        {
+            switch (value)
+            {
+                case null:
+                    _writer.WriteNull();
+                    break;
+                case string text:
+                    _writer.WriteText(text);
+                    break;
+                case bool flag:
+                    _writer.WriteBool(flag);
+                    break;
+                case long number:
+                    _writer.WriteInt(number);
+                    break;
+                case ulong number:
+                    _writer.WriteUInt(number);
+                    break;
+                case double number:
+                    _writer.WriteDouble(number);
+                    break;
+                case byte[] bytes:
+                    _writer.WriteBytes(bytes);
+                    break;
+                case DateTimeOffset time:
+                    // Epoch based date/time, seconds with the milliseconds as fraction
+                    _writer.WriteTag(1);
+                    _writer.WriteDouble(time.ToUnixTimeMilliseconds() / 1000.0);
+                    break;
+                default:
+                    _writer.WriteText(value.ToString() ?? "");
+                    break;
+            }
+        }
+    }
+
     class Program
     {
-        static async Task Main(string[] args)
+        // Set by the app that starts the bridge, see BridgeEndpoint in app/clients/PSClient/BridgeTransport.h
+        private const string EndpointVariable = "BURAQ_BRIDGE_ENDPOINT";
+        private const string TokenVariable = "BURAQ_BRIDGE_TOKEN";
+
+        static async Task<int> Main(string[] args)
         {
-            var listener = new TcpListener(IPAddress.Loopback, 12345);
-            listener.Start();
-            Console.WriteLine("PowerShell Host Server is listening on port 12345...");
+            string? endpoint = Environment.GetEnvironmentVariable(EndpointVariable);
+            string? token = Environment.GetEnvironmentVariable(TokenVariable);
+            if (string.IsNullOrEmpty(endpoint) || string.IsNullOrEmpty(token))
+            {
+                Console.Error.WriteLine($"{EndpointVariable} and {TokenVariable} must be set.");
+                return 2;
+            }
 
             // Create a single instance of your PowerShell manager.
             var psManager = new PowerShellManager();
+            byte[] expectedToken = Encoding.UTF8.GetBytes(token);
+
+            if (OperatingSystem.IsWindows())
+            {
+                await ServePipeAsync(endpoint, expectedToken, psManager);
+            }
+            else
+            {
+                await ServeUnixSocketAsync(endpoint, expectedToken, psManager);
+            }
+
+            return 0;
+        }
+
+        private static async Task ServePipeAsync(string name, byte[] token, PowerShellManager psManager)
+        {
+            Console.WriteLine($"PowerShell Host Server is listening on pipe {name}...");
 
             while (true)
             {
-                using (TcpClient client = await listener.AcceptTcpClientAsync())
+                // Other users cannot even open the pipe
+                var pipe = new NamedPipeServerStream(name, PipeDirection.InOut,
+                    NamedPipeServerStream.MaxAllowedServerInstances, PipeTransmissionMode.Byte,
+                    PipeOptions.Asynchronous | PipeOptions.CurrentUserOnly);
+                await pipe.WaitForConnectionAsync();
+
+                // Each connection is served on its own, so a long script never blocks the accept loop.
+                _ = HandleClientAsync(pipe, token, psManager);
+            }
+        }
+
+        [UnsupportedOSPlatform("windows")]
+        private static async Task ServeUnixSocketAsync(string path, byte[] token, PowerShellManager psManager)
+        {
+            // Left behind by a bridge that did not exit cleanly
+            File.Delete(path);
+
+            using var listener = new Socket(AddressFamily.Unix, SocketType.Stream, ProtocolType.Unspecified);
+            listener.Bind(new UnixDomainSocketEndPoint(path));
+            File.SetUnixFileMode(path, UnixFileMode.UserRead | UnixFileMode.UserWrite);
+            listener.Listen();
+            Console.WriteLine($"PowerShell Host Server is listening on {path}...");
+
+            try
+            {
+                while (true)
+                {
+                    Socket client = await listener.AcceptAsync();
+
+                    // Each connection is served on its own, so a long script never blocks the accept loop.
+                    _ = HandleClientAsync(new NetworkStream(client, ownsSocket: true), token, psManager);
+                }
+            }
+            finally
+            {
+                File.Delete(path);
+            }
+        }
+
+        // The app keeps one connection open for the whole session and sends many requests over it.
+        // Requests run concurrently, so the frames of different runs may interleave.
+        private static async Task HandleClientAsync(Stream stream, byte[] token, PowerShellManager psManager)
+        {
+            await using (stream)
+            {
+                var frames = new FrameStream(stream);
+
+                // Runs of this connection that have not completed, by request id
+                var runs = new ConcurrentDictionary<long, CancellationTokenSource>();
+
+                // Created by the first sticky run; sticky runs take turns on it
+                var session = new Lazy<Runspace>(psManager.CreateSessionRunspace);
+                var sessionLock = new SemaphoreSlim(1, 1);
+
+                try
                 {
-                    await using (NetworkStream stream = client.GetStream())
-                    using (var reader = new StreamReader(stream))
-                    using (var writer = new StreamWriter(stream))
+                    // Only the app that started this bridge knows the token
+                    if (await frames.ReadAsync() is not { Type: MessageType.Hello } hello ||
+                        !CryptographicOperations.FixedTimeEquals(hello.Payload, token))
+                    {
+                        Console.WriteLine("Closing a connection that did not start with the session token.");
+                        return;
+                    }
+
+                    while (await frames.ReadAsync() is { } frame)
                     {
-                        string? script = await reader.ReadLineAsync();
-                        if (script != null)
+                        switch (frame.Type)
                         {
-                            // Use the PowerShellManager to run the script.
-                            string result = psManager.RunScript(script);
+                            case MessageType.Run:
+                                string script = Encoding.UTF8.GetString(frame.Payload);
+                                bool sticky = ((RunFlags)frame.Flags).HasFlag(RunFlags.Sticky);
+                                var cancellation = new CancellationTokenSource();
+                                runs[frame.RequestId] = cancellation;
+                                _ = Task.Run(async () =>
+                                {
+                                    bool locked = false;
+                                    try
+                                    {
+                                        if (sticky)
+                                        {
+                                            await sessionLock.WaitAsync(cancellation.Token);
+                                            locked = true;
+                                        }
 
-                            Console.WriteLine("TcpClient: ", result);
+                                        await RunAsync(frames, psManager, frame.RequestId, script,
+                                            sticky ? session.Value : null, cancellation.Token);
+                                    }
+                                    catch (OperationCanceledException)
+                                    {
+                                        // Cancelled while waiting for the session
+                                        await frames.WriteStatusAsync(MessageType.Completed, frame.RequestId,
+                                            (int)RunStatus.Cancelled, "The script was cancelled before it started.");
+                                    }
+                                    catch (Exception ex) when (ex is IOException or ObjectDisposedException)
+                                    {
+                                        // The client went away
+                                    }
+                                    catch (Exception ex)
+                                    {
+                                        // The session runspace could not be opened
+                                        await TryFailAsync(frames, frame.RequestId, ex.Message);
+                                    }
+                                    finally
+                                    {
+                                        if (locked)
+                                        {
+                                            sessionLock.Release();
+                                        }
+                                        runs.TryRemove(frame.RequestId, out _);
+                                        cancellation.Dispose();
+                                    }
+                                });
+                                break;
 
-                            // Send the result back to the C++ client.
-                            await writer.WriteLineAsync(result);
-                            await writer.FlushAsync();
+                            case MessageType.Configure:
+                                try
+                                {
+                                    var configuration = JsonSerializer.Deserialize<BridgeConfiguration>(frame.Payload,
+                                        new JsonSerializerOptions { PropertyNameCaseInsensitive = true });
+                                    if (configuration != null)
+                                    {
+                                        psManager.Configure(configuration.PoolSize, configuration.Modules ?? []);
+                                    }
+                                }
+                                catch (JsonException ex)
+                                {
+                                    Console.WriteLine($"Ignoring a malformed configuration: {ex.Message}");
+                                }
+                                break;
+
+                            case MessageType.Ring:
+                                await frames.SetRingAsync(Encoding.UTF8.GetString(frame.Payload));
+                                break;
+
+                            case MessageType.Cancel:
+                                // The run may have completed in the meantime; its Completed frame tells the client
+                                if (runs.TryGetValue(frame.RequestId, out var run))
+                                {
+                                    Cancel(run);
+                                }
+                                break;
+
+                            default:
+                                Console.WriteLine($"Ignoring a {frame.Type} frame for request {frame.RequestId}.");
+                                break;
                         }
                     }
                 }
+                catch (Exception ex) when (ex is IOException or InvalidDataException)
+                {
+                    Console.WriteLine($"Client connection closed: {ex.Message}");
+                }
+                finally
+                {
+                    // Nobody is left to receive their output
+                    foreach (var run in runs.Values)
+                    {
+                        Cancel(run);
+                    }
+
+                    // Runs still writing fall back to the closed stream and stop
+                    await frames.SetRingAsync(null);
+
+                    if (session.IsValueCreated)
+                    {
+                        // Closed once the sticky run still going, if any, has stopped
+                        await sessionLock.WaitAsync();
+                        session.Value.Dispose();
+                    }
+                }
+            }
+        }
+
+        private static async Task TryFailAsync(FrameStream frames, long requestId, string error)
+        {
+            try
+            {
+                await frames.WriteTextAsync(MessageType.Error, requestId, error + "\n");
+                await frames.WriteStatusAsync(MessageType.Completed, requestId, (int)RunStatus.Failed, error);
+            }
+            catch (Exception ex) when (ex is IOException or ObjectDisposedException)
+            {
+                // The client went away
+            }
+        }
+
+        private static void Cancel(CancellationTokenSource run)
+        {
+            try
+            {
+                run.Cancel();
+            }
+            catch (ObjectDisposedException)
+            {
+                // Completed while being cancelled
+            }
+        }
+
+        // Records waiting to be sent per run; a full queue pauses the script until the client catches up
+        private const int MaxQueuedRecords = 1024;
+
+        // Consecutive records of one stream are sent together, up to this many chars, or bytes of
+        // encoded records, per frame
+        private const int MaxBatchChars = 64 * 1024;
+
+        // Batches through the shared ring cost no socket bandwidth and may grow larger
+        private const int MaxRingBatchChars = 1024 * 1024;
+
+        private static async Task RunAsync(FrameStream frames, PowerShellManager psManager, long requestId,
+            string script, Runspace? session, CancellationToken cancellation)
+        {
+            var records = Channel.CreateBounded<StreamRecord>(new BoundedChannelOptions(MaxQueuedRecords)
+            {
+                FullMode = BoundedChannelFullMode.Wait,
+                SingleReader = true,
+            });
+
+            // The script runs on its own thread while this one forwards what it writes
+            Task<bool> run = Task.Factory.StartNew(() =>
+            {
+                try
+                {
+                    // Use the PowerShellManager to run the script.
+                    // Waiting on a full queue ends with the cancellation, so a run can be stopped while the client is not reading
+                    return psManager.RunScript(script,
+                        record => records.Writer.WriteAsync(record, cancellation).AsTask().GetAwaiter().GetResult(),
+                        cancellation, session);
+                }
+                finally
+                {
+                    records.Writer.Complete();
+                }
+            }, TaskCreationOptions.LongRunning);
+
+            try
+            {
+                await SendRecordsAsync(frames, requestId, records.Reader);
+
+                try
+                {
+                    bool succeeded = await run;
+                    await frames.WriteStatusAsync(MessageType.Completed, requestId,
+                        (int)(succeeded ? RunStatus.Succeeded : RunStatus.Failed), "");
+                }
+                catch (OperationCanceledException)
+                {
+                    await frames.WriteStatusAsync(MessageType.Completed, requestId, (int)RunStatus.Cancelled,
+                        "The script was stopped.");
+                }
+                catch (Exception ex) when (ex is not (IOException or ObjectDisposedException))
+                {
+                    await frames.WriteTextAsync(MessageType.Error, requestId, ex.Message + "\n");
+                    await frames.WriteStatusAsync(MessageType.Completed, requestId, (int)RunStatus.Failed, ex.Message);
+                }
+            }
+            catch (Exception ex) when (ex is IOException or ObjectDisposedException)
+            {
+                // The client went away, its runs are reported as lost on its side.
+                // Keep draining so the script is not blocked forever on a full queue.
+                await foreach (var _ in records.Reader.ReadAllAsync())
+                {
+                }
+            }
+        }
+
+        // Sends the records of a run as they arrive. Whatever queued up while the previous frame
+        // was being written goes out in one frame, so chatty scripts produce few large frames and
+        // quiet ones get every record right away. Output frames hold one or more text records, each
+        // followed by a newline; objects and errors go out encoded as Records and ErrorRecords
+        // frames. Only the latest of several queued progress records is sent.
+        private static async Task SendRecordsAsync(FrameStream frames, long requestId, ChannelReader<StreamRecord> reader)
+        {
+            var batch = new StringBuilder();
+            var encoded = new RecordEncoder();
+            RecordStream batchStream = RecordStream.Output;
+            StreamRecord? progress = null;
+
+            async Task FlushAsync()
+            {
+                if (encoded.Length > 0)
+                {
+                    MessageType type = batchStream == RecordStream.Error ? MessageType.ErrorRecords : MessageType.Records;
+                    await frames.WriteAsync(type, requestId, encoded.Written);
+                    encoded.Clear();
+                }
+
+                if (batch.Length > 0)
+                {
+                    await frames.WriteTextAsync(MessageType.Output, requestId, batch.ToString(), (byte)batchStream);
+                    batch.Clear();
+                }
+
+                if (progress is { } latest)
+                {
+                    await frames.WriteStatusAsync(MessageType.Progress, requestId, latest.Percent, latest.Text);
+                    progress = null;
+                }
+            }
+
+            while (await reader.WaitToReadAsync())
+            {
+                while (reader.TryRead(out StreamRecord record))
+                {
+                    if (record.Stream == RecordStream.Progress)
+                    {
+                        progress = record;
+                        continue;
+                    }
+
+                    if ((batch.Length > 0 || encoded.Length > 0) && (record.Stream != batchStream ||
+                            batch.Length >= (frames.HasRing ? MaxRingBatchChars : MaxBatchChars) ||
+                            encoded.Length >= MaxBatchChars))
+                    {
+                        await FlushAsync();
+                    }
+
+                    batchStream = record.Stream;
+                    if (record.Stream == RecordStream.Object && record.Object != null)
+                    {
+                        encoded.WriteObject(record.Object);
+                    }
+                    else if (record.Stream == RecordStream.Error)
+                    {
+                        encoded.WriteError(record.Error ?? new ErrorDetails(record.Text, "", "", null, null, null, 0, 0));
+                    }
+                    else
+                    {
+                        batch.Append(record.Text).Append('\n');
+                    }
+                }
+
+                await FlushAsync();
             }
         }
     }
@@ -1,31 +1,452 @@
-﻿// Create an alias for the PowerShell class
+﻿﻿// Create an alias for the PowerShell class
 using System;
+using System.Collections;
+using System.Collections.Generic;
+using System.Linq;
+using System.Threading;
+using System.Threading.Tasks;
 using PowerShell = System.Management.Automation.PowerShell;
 using System.Management.Automation;
+using System.Management.Automation.Runspaces;
 
 namespace Buraq.PS
 {
+    // Keep the values below Error in sync with OutputStream in app/clients/PSClient/BridgeProtocol.h
+    public enum RecordStream : byte
+    {
+        Output = 0,
+        Warning = 1,
+        Verbose = 2,
+        Debug = 3,
+        Information = 4,
+        Error = 5,
+        Progress = 6,
+        // Output objects with properties, sent as typed records instead of text
+        Object = 7,
+    }
+
+    // Percent is only set for progress records, -1 when the activity has no percentage.
+    // Object records carry their properties in Object and error records their details in Error.
+    public readonly record struct StreamRecord(RecordStream Stream, string Text, int Percent = -1,
+        ObjectRecord? Object = null, ErrorDetails? Error = null);
+
+    /// <summary>
+    /// An output object flattened on the pipeline thread, while its properties can still be read.
+    /// Values are null, string, bool, long, ulong, double, DateTimeOffset or byte[].
+    /// </summary>
+    public sealed record ObjectRecord(string TypeName, string[] Names, object?[] Values);
+
+    // What is shown and filtered on of an ErrorRecord; Line and Column are 0 when unknown
+    public sealed record ErrorDetails(string Message, string ErrorId, string Category, string? Target,
+        string? ExceptionType, string? ScriptStackTrace, int Line, int Column);
+
+    // Turns what a pipeline writes into StreamRecords
+    internal static class Records
+    {
+        // Properties of an object beyond this many are left out
+        private const int MaxProperties = 64;
+
+        // Elements of a collection value shown before "...", like $FormatEnumerationLimit
+        private const int EnumerationLimit = 4;
+
+        // Scalars stay text, objects with properties become Object records
+        public static StreamRecord FromOutput(PSObject? item)
+        {
+            if (item == null)
+            {
+                return new StreamRecord(RecordStream.Output, "null");
+            }
+
+            object value = item.BaseObject;
+            if (IsScalar(value) || value is ErrorRecord)
+            {
+                return new StreamRecord(RecordStream.Output, item.ToString());
+            }
+
+            ObjectRecord? record = value is IDictionary dictionary ? FromDictionary(item, dictionary) : FromProperties(item);
+            return record == null
+                ? new StreamRecord(RecordStream.Output, item.ToString())
+                : new StreamRecord(RecordStream.Object, "", Object: record);
+        }
+
+        public static StreamRecord FromError(ErrorRecord error)
+        {
+            string message = error.ToString();
+            InvocationInfo? invocation = error.InvocationInfo;
+            return new StreamRecord(RecordStream.Error, message, Error: new ErrorDetails(message,
+                error.FullyQualifiedErrorId ?? "", error.CategoryInfo.Category.ToString(), TextOf(error.TargetObject),
+                error.Exception?.GetType().FullName, error.ScriptStackTrace,
+                invocation?.ScriptLineNumber ?? 0, invocation?.OffsetInLine ?? 0));
+        }
+
+        private static bool IsScalar(object value)
+        {
+            return value is string or char or bool or decimal or Enum or DateTime or DateTimeOffset or TimeSpan or Guid
+                or Uri || value.GetType().IsPrimitive;
+        }
+
+        private static ObjectRecord? FromProperties(PSObject item)
+        {
+            var names = new List<string>();
+            var values = new List<object?>();
+            foreach (PSPropertyInfo property in DisplayProperties(item))
+            {
+                if (names.Count == MaxProperties)
+                {
+                    break;
+                }
+                if (!property.IsGettable)
+                {
+                    continue;
+                }
+
+                names.Add(property.Name);
+                values.Add(ReadValue(() => property.Value));
+            }
+
+            return names.Count == 0 ? null : new ObjectRecord(TypeNameOf(item), names.ToArray(), values.ToArray());
+        }
+
+        // A hashtable shows as its keys, not as the properties of Hashtable
+        private static ObjectRecord FromDictionary(PSObject item, IDictionary dictionary)
+        {
+            var names = new List<string>();
+            var values = new List<object?>();
+            foreach (DictionaryEntry entry in dictionary)
+            {
+                if (names.Count == MaxProperties)
+                {
+                    break;
+                }
+
+                names.Add(TextOf(entry.Key) ?? "");
+                values.Add(ReadValue(() => entry.Value));
+            }
+
+            return new ObjectRecord(TypeNameOf(item), names.ToArray(), values.ToArray());
+        }
+
+        // The default display property set when the type has one, as Format-Table picks them, every property otherwise
+        private static IEnumerable<PSPropertyInfo> DisplayProperties(PSObject item)
+        {
+            if (item.Members["PSStandardMembers"] is PSMemberSet standard &&
+                standard.Members["DefaultDisplayPropertySet"] is PSPropertySet display)
+            {
+                return display.ReferencedPropertyNames
+                    .Select(name => item.Properties[name])
+                    .Where(property => property != null);
+            }
+
+            return item.Properties;
+        }
+
+        private static string TypeNameOf(PSObject item)
+        {
+            return item.TypeNames.Count > 0 ? item.TypeNames[0] : item.BaseObject.GetType().FullName ?? "";
+        }
+
+        // Getters and enumerators may throw, such a value is sent as null
+        private static object? ReadValue(Func<object?> read)
+        {
+            try
+            {
+                return ToWire(read());
+            }
+            catch (Exception)
+            {
+                return null;
+            }
+        }
+
+        private static object? ToWire(object? value)
+        {
+            if (value is PSObject wrapped)
+            {
+                value = wrapped.BaseObject;
+            }
+
+            switch (value)
+            {
+                case null:
+                    return null;
+                case string or bool or long or ulong or double or byte[] or DateTimeOffset:
+                    return value;
+                case int or short or sbyte or byte or ushort or uint:
+                    return Convert.ToInt64(value);
+                case float single:
+                    return (double)single;
+                case decimal number:
+                    return (double)number;
+                case DateTime time:
+                    // Near MinValue and MaxValue the local offset moves a time out of range
+                    return time.Kind == DateTimeKind.Utc || (time > DateTime.MinValue.AddDays(1) &&
+                                                             time < DateTime.MaxValue.AddDays(-1))
+                        ? new DateTimeOffset(time)
+                        : time.ToString("o");
+                case IEnumerable sequence and not IDictionary:
+                    return Enumerate(sequence);
+                default:
+                    return value.ToString();
+            }
+        }
+
+        private static string Enumerate(IEnumerable sequence)
+        {
+            var shown = new List<string>();
+            foreach (object? element in sequence)
+            {
+                if (shown.Count == EnumerationLimit)
+                {
+                    shown.Add("...");
+                    break;
+                }
+                shown.Add(TextOf(element) ?? "");
+            }
+
+            return "{" + string.Join(", ", shown) + "}";
+        }
+
+        private static string? TextOf(object? value)
+        {
+            try
+            {
+                return value?.ToString();
+            }
+            catch (Exception)
+            {
+                return value?.GetType().FullName;
+            }
+        }
+    }
+
+    /// <summary>
+    /// Runs scripts on a pool of runspaces that are opened ahead of time, with the configured
+    /// modules already imported, so a run does not pay for creating a runspace and loading modules.
+    /// Runs go to an idle runspace and wait when all of them are busy. Runspaces are reused, but
+    /// which one a run gets is not defined; a session runspace keeps its state for a whole workflow.
+    /// </summary>
     public class PowerShellManager
     {
-        public string RunScript(string script)
+        // A pool and the runs using it. A replaced pool is closed once its last run ends.
+        private sealed class Lease
+        {
+            public required RunspacePool Pool { get; init; }
+            public required InitialSessionState SessionState { get; init; }
+            public required Task Opened { get; init; }
+            public int PoolSize { get; init; }
+            public string[] Modules { get; init; } = [];
+
+            public int Users;
+            public bool Retired;
+        }
+
+        private readonly object _lock = new();
+        private Lease _lease;
+
+        public PowerShellManager(int poolSize = 4, IEnumerable<string>? modules = null)
+        {
+            _lease = CreateLease(poolSize, modules?.ToArray() ?? []);
+        }
+
+        /// <summary>
+        /// Replaces the pool when the size or the modules changed. Runs already going keep the old one.
+        /// </summary>
+        public void Configure(int poolSize, IReadOnlyCollection<string> modules)
+        {
+            poolSize = Math.Max(1, poolSize);
+            Lease old;
+            lock (_lock)
+            {
+                if (_lease.PoolSize == poolSize && _lease.Modules.SequenceEqual(modules))
+                {
+                    return;
+                }
+
+                old = _lease;
+                _lease = CreateLease(poolSize, modules.ToArray());
+                old.Retired = true;
+            }
+            Release(old, acquired: false);
+        }
+
+        /// <summary>
+        /// A runspace of its own for a session, with the same modules as the pool. Runs on it keep
+        /// their variables and imports for the next run; the caller must not run two scripts on it
+        /// at the same time, and disposes it when the session ends.
+        /// </summary>
+        public Runspace CreateSessionRunspace()
+        {
+            InitialSessionState sessionState;
+            lock (_lock)
+            {
+                sessionState = _lease.SessionState;
+            }
+
+            Runspace runspace = RunspaceFactory.CreateRunspace(sessionState);
+            runspace.Open();
+            return runspace;
+        }
+
+        private static Lease CreateLease(int poolSize, string[] modules)
+        {
+            InitialSessionState sessionState = InitialSessionState.CreateDefault();
+            if (modules.Length > 0)
+            {
+                sessionState.ImportPSModule(modules);
+            }
+
+            // Opens poolSize runspaces right away, so they are warm before the first run
+            RunspacePool pool = RunspaceFactory.CreateRunspacePool(poolSize, poolSize, sessionState, null);
+            return new Lease
+            {
+                Pool = pool,
+                SessionState = sessionState,
+                Opened = Task.Run(pool.Open),
+                PoolSize = poolSize,
+                Modules = modules,
+            };
+        }
+
+        private Lease Acquire()
+        {
+            lock (_lock)
+            {
+                _lease.Users++;
+                return _lease;
+            }
+        }
+
+        private void Release(Lease lease, bool acquired = true)
+        {
+            bool close;
+            lock (_lock)
+            {
+                if (acquired)
+                {
+                    lease.Users--;
+                }
+                close = lease.Retired && lease.Users == 0;
+            }
+
+            if (close)
+            {
+                // Waits for the pool to finish opening, if it still was
+                lease.Opened.ContinueWith(_ => lease.Pool.Dispose());
+            }
+        }
+
+        /// <summary>
+        /// Runs script and hands every record of every stream to onRecord as soon as it is written.
+        /// Records are removed from the PowerShell collections once handed out, so memory does not
+        /// grow with the amount of output. onRecord is called on the pipeline thread; blocking in it
+        /// pauses the script. Returns false if the script wrote any error.
+        /// Cancelling stops the pipeline and throws OperationCanceledException.
+        /// The script runs on session if given, from CreateSessionRunspace, and on the pool otherwise.
+        /// </summary>
+        public bool RunScript(string script, Action<StreamRecord> onRecord, CancellationToken cancellation = default,
+            Runspace? session = null)
+        {
+            Lease? lease = session == null ? Acquire() : null;
+            try
+            {
+                return RunScript(script, onRecord, cancellation, session, lease);
+            }
+            finally
+            {
+                if (lease != null)
+                {
+                    Release(lease);
+                }
+            }
+        }
+
+        private static bool RunScript(string script, Action<StreamRecord> onRecord, CancellationToken cancellation,
+            Runspace? session, Lease? lease)
         {
-            // Use the PowerShell class directly
             using (PowerShell ps = PowerShell.Create())
+            using (var output = new PSDataCollection<PSObject>())
             {
+                if (session != null)
+                {
+                    ps.Runspace = session;
+                }
+                else
+                {
+                    lease!.Opened.WaitAsync(cancellation).GetAwaiter().GetResult();
+                    ps.RunspacePool = lease.Pool;
+                }
+
                 ps.AddScript(script);
-                var results = ps.Invoke();
 
-                foreach (var item in results)
+                output.DataAdded += (_, _) =>
                 {
-                    Console.WriteLine(item.ToString());                    
-                }
-                
-                // 2. Added logic to process and return results
-                if (results.Count > 0)
+                    foreach (var item in output.ReadAll())
+                    {
+                        onRecord(Records.FromOutput(item));
+                    }
+                };
+                ps.Streams.Error.DataAdded += (_, _) =>
                 {
-                    return results[0]?.ToString() ?? "null";
+                    foreach (var error in ps.Streams.Error.ReadAll())
+                    {
+                        onRecord(Records.FromError(error));
+                    }
+                };
+                ps.Streams.Warning.DataAdded += (_, _) =>
+                {
+                    foreach (var warning in ps.Streams.Warning.ReadAll())
+                    {
+                        onRecord(new StreamRecord(RecordStream.Warning, warning.Message));
+                    }
+                };
+                ps.Streams.Verbose.DataAdded += (_, _) =>
+                {
+                    foreach (var verbose in ps.Streams.Verbose.ReadAll())
+                    {
+                        onRecord(new StreamRecord(RecordStream.Verbose, verbose.Message));
+                    }
+                };
+                ps.Streams.Debug.DataAdded += (_, _) =>
+                {
+                    foreach (var debug in ps.Streams.Debug.ReadAll())
+                    {
+                        onRecord(new StreamRecord(RecordStream.Debug, debug.Message));
+                    }
+                };
+                ps.Streams.Information.DataAdded += (_, _) =>
+                {
+                    foreach (var information in ps.Streams.Information.ReadAll())
+                    {
+                        onRecord(new StreamRecord(RecordStream.Information, information.ToString()));
+                    }
+                };
+                ps.Streams.Progress.DataAdded += (_, _) =>
+                {
+                    foreach (var progress in ps.Streams.Progress.ReadAll())
+                    {
+                        onRecord(new StreamRecord(RecordStream.Progress,
+                            $"{progress.Activity}: {progress.StatusDescription}", progress.PercentComplete));
+                    }
+                };
+
+                cancellation.ThrowIfCancellationRequested();
+
+                // BeginStop, because Stop() waits for the pipeline and would block the canceller
+                using (cancellation.Register(() => ps.BeginStop(null, null)))
+                {
+                    try
+                    {
+                        ps.Invoke<PSObject, PSObject>(null, output);
+                    }
+                    catch (Exception) when (cancellation.IsCancellationRequested)
+                    {
+                        // PipelineStoppedException, or the cancellation thrown out of onRecord
+                        throw new OperationCanceledException(cancellation);
+                    }
                 }
-                return "No output";
+
+                cancellation.ThrowIfCancellationRequested();
+                return !ps.HadErrors;
             }
         }
     }
@@ -0,0 +1,186 @@
+//
+// Created by talik on 10/18/2026.
+//
+
+// Times pslang::tokenize against the four QRegularExpressions the highlighter
+// used before it, over a large generated script. Both sides only collect the
+// spans they would colour, so the numbers leave QSyntaxHighlighter out.
+//
+//   tokenizer_bench [lines] [rounds]
+
+#include <algorithm>
+#include <cstdio>
+#include <iterator>
+#include <limits>
+#include <vector>
+#include <QElapsedTimer>
+#include <QRegularExpression>
+#include <QString>
+#include <QStringList>
+
+#include "PSTokenizer.h"
+
+namespace
+{
+    struct Span
+    {
+        qsizetype offset;
+        qsizetype length;
+    };
+
+    QStringList generateScript(const int lines)
+    {
+        // A mix of what scripts are made of, block comments and here-strings included
+        static const char* const pattern[] = {
+            "# Collects the sites of every user listed in the input file",
+            "param([string]$Path = \"C:\\Users\\$env:USERNAME\\sites.csv\", [int]$Limit = 500)",
+            "Install-Module -Name Microsoft.Online.SharePoint.PowerShell -Scope CurrentUser -Force",
+            "Connect-SPOService -Url \"https://contoso-admin.sharepoint.com\" -Credential $credential",
+            "$sites = Get-SPOsite -Limit All | Where-Object { $_.Url -like \"*$($user.Name)*\" }",
+            "foreach ($site in $sites) {",
+            "    Set-SPOUser -Site $site.Url -LoginName $user.Mail -IsSiteCollectionAdmin $true",
+            "    Write-Output \"Updated `t$($site.Url) for $($user.DisplayName) at $(Get-Date -Format 'o')\"",
+            "}",
+            "<# Block comments may span lines",
+            "   and hold \"quotes\" and $variables that are not coloured #>",
+            "$report = @\"",
+            "Sites: $($sites.Count)",
+            "\"@",
+            "Get-ChildItem -Path $Path -Recurse -Filter *.ps1 | ForEach-Object { echo $_.FullName } # list",
+            "if ($Limit -gt 0x1F4 -and $sites.Count -le 1.5e3) { ls; ps | Select-Object -First 10 }",
+        };
+        constexpr int patternLines = int(std::size(pattern));
+
+        QStringList script;
+        script.reserve(lines);
+        for (int i = 0; i < lines; ++i)
+        {
+            script.append(QString::fromLatin1(pattern[i % patternLines]));
+        }
+        return script;
+    }
+
+    // What SyntaxHighlighter::highlightBlock did per line before the tokenizer
+    class RegexPath
+    {
+    public:
+        void run(const QStringList& script, std::vector<Span>& spans) const
+        {
+            bool inBlockComment = false;
+            for (const QString& text : script)
+            {
+                qsizetype start = 0;
+                if (inBlockComment)
+                {
+                    const qsizetype end = text.indexOf(QStringLiteral("#>"));
+                    if (end < 0)
+                    {
+                        spans.push_back({0, text.size()});
+                        continue;
+                    }
+                    start = end + 2;
+                    spans.push_back({0, start});
+                    inBlockComment = false;
+                }
+
+                for (const QRegularExpression* regex : {&m_keywords, &m_variables, &m_strings})
+                {
+                    for (auto it = regex->globalMatch(text, start); it.hasNext();)
+                    {
+                        const auto match = it.next();
+                        spans.push_back({match.capturedStart(), match.capturedLength()});
+                    }
+                }
+
+                if (const qsizetype blockComment = text.indexOf(QStringLiteral("<#"), start); blockComment >= 0)
+                {
+                    if (text.indexOf(QStringLiteral("#>"), blockComment + 2) < 0)
+                    {
+                        spans.push_back({blockComment, text.size() - blockComment});
+                        inBlockComment = true;
+                        continue;
+                    }
+                }
+
+                if (const auto match = m_comments.match(text, start); match.hasMatch())
+                {
+                    spans.push_back({match.capturedStart(), match.capturedLength()});
+                }
+            }
+        }
+
+    private:
+        QRegularExpression m_keywords{
+            QStringLiteral("\\b(echo|ls|ps|Write-Output|Get-ChildItem|Connect-SPOService|"
+                "Get-SPOsite|Set-SPOUser|Install-Module)\\b"),
+            QRegularExpression::CaseInsensitiveOption
+        };
+        QRegularExpression m_strings{QStringLiteral("\"(.*?)\"")};
+        QRegularExpression m_variables{QStringLiteral("\\$\\w+")};
+        QRegularExpression m_comments{QStringLiteral("#.*$")};
+    };
+
+    void tokenizerPath(const QStringList& script, std::vector<Span>& spans)
+    {
+        std::vector<pslang::Token> tokens;
+        pslang::LexState state = pslang::InitialState;
+        for (const QString& text : script)
+        {
+            state = pslang::tokenize(text, state, tokens);
+            for (const pslang::Token& token : tokens)
+            {
+                spans.push_back({token.offset, token.length});
+            }
+        }
+    }
+
+    // Fastest of rounds, in milliseconds
+    template <typename Path>
+    double fastest(const int rounds, const QStringList& script, std::size_t& spanCount, Path&& path)
+    {
+        std::vector<Span> spans;
+        qint64 best = std::numeric_limits<qint64>::max();
+        for (int round = 0; round < rounds; ++round)
+        {
+            spans.clear();
+            QElapsedTimer timer;
+            timer.start();
+            path(script, spans);
+            best = std::min(best, timer.nsecsElapsed());
+        }
+        spanCount = spans.size();
+        return double(best) / 1e6;
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    const int lines = argc > 1 ? std::max(1, QString::fromLocal8Bit(argv[1]).toInt()) : 200000;
+    const int rounds = argc > 2 ? std::max(1, QString::fromLocal8Bit(argv[2]).toInt()) : 5;
+
+    const QStringList script = generateScript(lines);
+    qsizetype characters = 0;
+    for (const QString& line : script)
+    {
+        characters += line.size() + 1;
+    }
+    const double megabytes = double(characters) * sizeof(QChar) / (1024 * 1024);
+
+    RegexPath regex;
+    std::size_t regexSpans = 0;
+    const double regexMs = fastest(rounds, script, regexSpans,
+                                   [&regex](const QStringList& text, std::vector<Span>& spans)
+                                   {
+                                       regex.run(text, spans);
+                                   });
+
+    std::size_t tokenizerSpans = 0;
+    const double tokenizerMs = fastest(rounds, script, tokenizerSpans, tokenizerPath);
+
+    std::printf("%d lines, %.1f MiB of UTF-16, best of %d rounds\n", lines, megabytes, rounds);
+    std::printf("  regexes    %9.2f ms  %8.1f MiB/s  %zu spans\n", regexMs, megabytes * 1000 / regexMs, regexSpans);
+    std::printf("  tokenizer  %9.2f ms  %8.1f MiB/s  %zu spans\n", tokenizerMs, megabytes * 1000 / tokenizerMs,
+                tokenizerSpans);
+    std::printf("  speedup    %9.2fx\n", regexMs / tokenizerMs);
+    return 0;
+}
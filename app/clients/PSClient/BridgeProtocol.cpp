@@ -0,0 +1,111 @@
+//
+// Created by talik on 10/18/2026.
+//
+
+#include "BridgeProtocol.h"
+
+#include <cstring>
+#include <QtEndian>
+
+namespace bridge
+{
+    QByteArray encode(const MessageType type, const quint64 requestId, const QByteArrayView payload,
+                      const quint8 flags)
+    {
+        QByteArray frame(HeaderSize + payload.size(), Qt::Uninitialized);
+        auto* header = reinterpret_cast<uchar*>(frame.data());
+
+        qToLittleEndian<quint32>(static_cast<quint32>(payload.size()), header);
+        qToLittleEndian<quint64>(requestId, header + 4);
+        header[12] = static_cast<uchar>(type);
+        header[13] = flags;
+        header[14] = 0;
+        header[15] = 0;
+
+        if (!payload.isEmpty())
+        {
+            memcpy(frame.data() + HeaderSize, payload.data(), payload.size());
+        }
+        return frame;
+    }
+
+    QByteArray encodeStatus(const qint32 value, const QString& text)
+    {
+        QByteArray payload(sizeof(qint32), Qt::Uninitialized);
+        qToLittleEndian<qint32>(value, payload.data());
+        payload.append(text.toUtf8());
+        return payload;
+    }
+
+    bool decodeStatus(const QByteArrayView payload, qint32& value, QString& text)
+    {
+        if (payload.size() < qsizetype(sizeof(qint32)))
+        {
+            return false;
+        }
+
+        value = qFromLittleEndian<qint32>(payload.data());
+        text = QString::fromUtf8(payload.sliced(sizeof(qint32)));
+        return true;
+    }
+
+    bool decodeBulk(const QByteArrayView payload, quint64& offset, quint32& length)
+    {
+        if (payload.size() != qsizetype(sizeof(quint64) + sizeof(quint32)))
+        {
+            return false;
+        }
+
+        offset = qFromLittleEndian<quint64>(payload.data());
+        length = qFromLittleEndian<quint32>(payload.data() + sizeof(quint64));
+        return true;
+    }
+
+    void FrameReader::append(const QByteArrayView bytes)
+    {
+        // Drop the frames already handed out before the buffer grows again
+        if (m_position > 0 && m_position >= m_buffer.size() / 2)
+        {
+            m_buffer.remove(0, m_position);
+            m_position = 0;
+        }
+        m_buffer.append(bytes);
+    }
+
+    std::optional<Frame> FrameReader::next()
+    {
+        if (m_error || m_buffer.size() - m_position < HeaderSize)
+        {
+            return std::nullopt;
+        }
+
+        const auto* header = reinterpret_cast<const uchar*>(m_buffer.constData() + m_position);
+        const auto length = qFromLittleEndian<quint32>(header);
+        if (length > MaxPayload)
+        {
+            m_error = true;
+            return std::nullopt;
+        }
+
+        if (m_buffer.size() - m_position < HeaderSize + qsizetype(length))
+        {
+            return std::nullopt;
+        }
+
+        Frame frame{
+            .type = static_cast<MessageType>(header[12]),
+            .flags = header[13],
+            .requestId = qFromLittleEndian<quint64>(header + 4),
+            .payload = m_buffer.sliced(m_position + HeaderSize, length),
+        };
+        m_position += HeaderSize + length;
+        return frame;
+    }
+
+    void FrameReader::clear()
+    {
+        m_buffer.clear();
+        m_position = 0;
+        m_error = false;
+    }
+}
@@ -0,0 +1,148 @@
+//
+// Created by talik on 10/18/2026.
+//
+
+#ifndef BRIDGE_PROTOCOL_H
+#define BRIDGE_PROTOCOL_H
+
+#include <optional>
+#include <QByteArray>
+#include <QByteArrayView>
+#include <QString>
+
+/**
+ * Wire format between PSClient and Buraq.Bridge; keep in sync with Frame in Buraq.Bridge.cs.
+ *
+ * Every message is a 16 byte header followed by its payload, all little endian:
+ *
+ *   0  u32  payload length
+ *   4  u64  request id
+ *   12 u8   message type
+ *   13 u8   flags
+ *   14 u16  reserved, 0
+ *
+ * Text payloads are UTF-8 and are never scanned for delimiters, so scripts and
+ * outputs of any content arrive intact. Output and Error payloads hold one or
+ * more records, each followed by a newline.
+ *
+ * Objects with properties are not turned into text by the bridge. They arrive
+ * as Records frames, whose payload is a sequence of CBOR items (RFC 8742):
+ *
+ *   [0, typeId, typeName, [propertyName, ...]]   defines a type, once per run
+ *   [1, typeId, [value, ...]]                    a record of that type
+ *
+ * Type ids count up from 0 in each run, and a type is always defined in the
+ * frame of its first record or earlier. Values are null, bool, integers,
+ * doubles, text, bytes, or an epoch date/time (tag 1); anything else was
+ * turned into its text by the bridge. The error records of a script arrive
+ * as ErrorRecords frames, a sequence of arrays:
+ *
+ *   [message, errorId, category, target, exceptionType, scriptStackTrace, line, column]
+ *
+ * where target, exceptionType and scriptStackTrace may be null. See
+ * RecordReader.h for reading both.
+ */
+namespace bridge
+{
+    enum class MessageType : quint8
+    {
+        // app -> bridge, payload is the script, flags are RunFlags
+        Run = 1,
+        // app -> bridge, no payload
+        Cancel = 2,
+        // bridge -> app, payload is output text, flags is its OutputStream
+        Output = 3,
+        // bridge -> app, payload is the text of errors the bridge itself ran into
+        Error = 4,
+        // bridge -> app, payload is an i32 percentage followed by the activity text
+        Progress = 5,
+        // bridge -> app, payload is an i32 RunStatus followed by a message; last frame of a run
+        Completed = 6,
+        // app -> bridge, request id 0, payload is JSON: {"poolSize": 4, "modules": ["..."]}
+        Configure = 7,
+        // app -> bridge, request id 0, payload is the session token; first frame of every connection
+        Hello = 8,
+        // app -> bridge, request id 0, payload is the UTF-8 path of a SharedRing for this connection
+        Ring = 9,
+        // bridge -> app, payload is a u64 ring offset and a u32 length of output text in the SharedRing,
+        // flags is its OutputStream
+        BulkOutput = 10,
+        // bridge -> app, payload is a CBOR sequence of record types and records
+        Records = 11,
+        // bridge -> app, payload is a CBOR sequence of error records
+        ErrorRecords = 12,
+    };
+
+    enum RunFlags : quint8
+    {
+        NoRunFlags = 0,
+        // Run on the session runspace of the connection, which keeps its state between runs
+        Sticky = 1,
+    };
+
+    // Keep in sync with RecordStream in Buraq.PowerShell.cs
+    enum class OutputStream : quint8
+    {
+        Output = 0,
+        Warning = 1,
+        Verbose = 2,
+        Debug = 3,
+        Information = 4,
+        // Sent as Error and ErrorRecords frames rather than in the flags of Output frames
+        Error = 5,
+    };
+
+    enum class RunStatus : qint32
+    {
+        Succeeded = 0,
+        Failed = 1,
+        Cancelled = 2,
+    };
+
+    constexpr qsizetype HeaderSize = 16;
+
+    // Larger frames are a protocol error; long outputs are sent as several Output frames
+    constexpr quint32 MaxPayload = 64 * 1024 * 1024;
+
+    struct Frame
+    {
+        MessageType type;
+        quint8 flags = 0;
+        quint64 requestId = 0;
+        QByteArray payload;
+    };
+
+    QByteArray encode(MessageType type, quint64 requestId, QByteArrayView payload = {}, quint8 flags = 0);
+
+    // Payload of a Progress or Completed frame
+    QByteArray encodeStatus(qint32 value, const QString& text);
+
+    // Splits a Progress or Completed payload, false if it is too short
+    bool decodeStatus(QByteArrayView payload, qint32& value, QString& text);
+
+    // Splits a BulkOutput payload, false if it has the wrong size
+    bool decodeBulk(QByteArrayView payload, quint64& offset, quint32& length);
+
+    // Cuts a byte stream into frames
+    class FrameReader
+    {
+    public:
+        void append(QByteArrayView bytes);
+
+        // The next complete frame, if any. Returns nothing once hasError() is set.
+        std::optional<Frame> next();
+
+        // The stream is corrupt and must be dropped
+        [[nodiscard]] bool hasError() const { return m_error; }
+
+        void clear();
+
+    private:
+        QByteArray m_buffer;
+        // Start of the first unread frame in m_buffer
+        qsizetype m_position = 0;
+        bool m_error = false;
+    };
+}
+
+#endif //BRIDGE_PROTOCOL_H
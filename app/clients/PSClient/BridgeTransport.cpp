@@ -0,0 +1,81 @@
+//
+// Created by talik on 10/18/2026.
+//
+
+#include "BridgeTransport.h"
+
+#include <utility>
+#include <QDir>
+#include <QRandomGenerator>
+#include <QStandardPaths>
+
+namespace
+{
+    // 128 random bits as hex
+    QByteArray randomHex()
+    {
+        quint32 words[4];
+        QRandomGenerator::system()->fillRange(words);
+        return QByteArray(reinterpret_cast<const char*>(words), sizeof(words)).toHex();
+    }
+}
+
+const BridgeEndpoint& BridgeEndpoint::session()
+{
+    static const BridgeEndpoint endpoint = []
+    {
+        // Set when the bridge was started by hand, or by an earlier instance of the app
+        BridgeEndpoint result{qEnvironmentVariable(NameVariable), qgetenv(TokenVariable)};
+        if (!result.name.isEmpty() && !result.token.isEmpty())
+        {
+            return result;
+        }
+
+        const QString id = QString::fromLatin1(randomHex());
+#ifdef Q_OS_WIN
+        // Becomes \\.\pipe\buraq-bridge-<id>
+        result.name = "buraq-bridge-" + id;
+#else
+        result.name = privateDirectory() + "/buraq-bridge-" + id + ".sock";
+#endif
+        result.token = randomHex() + randomHex();
+
+        qputenv(NameVariable, result.name.toUtf8());
+        qputenv(TokenVariable, result.token);
+        return result;
+    }();
+
+    return endpoint;
+}
+
+QString BridgeEndpoint::privateDirectory()
+{
+    const QString directory = QStandardPaths::writableLocation(QStandardPaths::RuntimeLocation);
+    return directory.isEmpty() ? QDir::tempPath() : directory;
+}
+
+LocalBridgeTransport::LocalBridgeTransport(QString serverName, QObject* parent)
+    : BridgeTransport(parent), m_serverName(std::move(serverName)), m_socket(new QLocalSocket(this))
+{
+    connect(m_socket, &QLocalSocket::connected, this, &BridgeTransport::connected);
+    connect(m_socket, &QLocalSocket::disconnected, this, &BridgeTransport::disconnected);
+    connect(m_socket, &QLocalSocket::readyRead, this, &BridgeTransport::readyRead);
+    connect(m_socket, &QLocalSocket::errorOccurred, this, [this](const QLocalSocket::LocalSocketError error)
+    {
+        // Nothing went wrong, disconnected() follows
+        if (error != QLocalSocket::PeerClosedError)
+        {
+            emit errorOccurred(m_socket->errorString());
+        }
+    });
+}
+
+void LocalBridgeTransport::open()
+{
+    if (!isClosed())
+    {
+        return;
+    }
+
+    m_socket->connectToServer(m_serverName);
+}
@@ -0,0 +1,111 @@
+//
+// Created by talik on 10/18/2026.
+//
+
+#ifndef BRIDGE_TRANSPORT_H
+#define BRIDGE_TRANSPORT_H
+
+#include <QByteArray>
+#include <QLocalSocket>
+#include <QObject>
+#include <QString>
+
+/**
+ * Where the bridge of this session listens, and the token it expects in the
+ * Hello frame of every connection.
+ *
+ * Both are made up once per session and handed to the bridge process through
+ * the environment, so nothing else on the machine knows them: name is the path
+ * of a Unix domain socket in the user's runtime directory, or the name of a
+ * named pipe on Windows.
+ */
+struct BridgeEndpoint
+{
+    static constexpr auto NameVariable = "BURAQ_BRIDGE_ENDPOINT";
+    static constexpr auto TokenVariable = "BURAQ_BRIDGE_TOKEN";
+
+    QString name;
+    QByteArray token;
+
+    /**
+     * The endpoint of this session. Taken from the environment if both
+     * variables are set, made up and put into the environment otherwise, so
+     * that a bridge started afterwards inherits it.
+     */
+    static const BridgeEndpoint& session();
+
+    // Where files only this user may see are kept: the runtime directory, or the temp directory without one
+    static QString privateDirectory();
+};
+
+/**
+ * Byte stream to the bridge under PSClient. The client owns framing, the
+ * handshake and reconnecting; a transport only moves bytes, which keeps it
+ * easy to replace with an in-process double.
+ */
+class BridgeTransport : public QObject
+{
+    Q_OBJECT
+
+signals:
+    void connected();
+
+    // Only after connected()
+    void disconnected();
+
+    // A connection attempt failed or a connection broke; the latter is followed by disconnected()
+    void errorOccurred(const QString& error);
+
+    void readyRead();
+
+public:
+    explicit BridgeTransport(QObject* parent = nullptr) : QObject(parent) {}
+
+    ~BridgeTransport() override = default;
+
+    // Starts connecting unless the transport is already connected or connecting
+    virtual void open() = 0;
+
+    // Drops the connection right away, emitting disconnected() if it was up
+    virtual void abort() = 0;
+
+    virtual void write(const QByteArray& data) = 0;
+
+    virtual QByteArray readAll() = 0;
+
+    [[nodiscard]] virtual bool isConnected() const = 0;
+
+    // Neither connected nor connecting
+    [[nodiscard]] virtual bool isClosed() const = 0;
+
+    [[nodiscard]] virtual QString errorString() const = 0;
+};
+
+// Unix domain socket, or named pipe on Windows, to a BridgeEndpoint
+class LocalBridgeTransport final : public BridgeTransport
+{
+    Q_OBJECT
+
+public:
+    explicit LocalBridgeTransport(QString serverName, QObject* parent = nullptr);
+
+    void open() override;
+
+    void abort() override { m_socket->abort(); }
+
+    void write(const QByteArray& data) override { m_socket->write(data); }
+
+    QByteArray readAll() override { return m_socket->readAll(); }
+
+    [[nodiscard]] bool isConnected() const override { return m_socket->state() == QLocalSocket::ConnectedState; }
+
+    [[nodiscard]] bool isClosed() const override { return m_socket->state() == QLocalSocket::UnconnectedState; }
+
+    [[nodiscard]] QString errorString() const override { return m_socket->errorString(); }
+
+private:
+    QString m_serverName;
+    QLocalSocket* m_socket;
+};
+
+#endif //BRIDGE_TRANSPORT_H
@@ -3,51 +3,334 @@
 //
 
 #include "PSClient.h"
+#include <algorithm>
+#include <utility>
 #include <QDebug>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
 
-PSClient::PSClient(QObject *parent) : QObject(parent)
+PSClient::PSClient(QObject *parent)
+    : PSClient(new LocalBridgeTransport(BridgeEndpoint::session().name), BridgeEndpoint::session().token, parent)
 {
-    m_socket = new QTcpSocket(this);
+}
+
+PSClient::PSClient(BridgeTransport *transport, QByteArray token, QObject *parent)
+    : QObject(parent), m_transport(transport), m_token(std::move(token))
+{
+    m_transport->setParent(this);
+
+    // Connect signals to handle transport events.
+    connect(m_transport, &BridgeTransport::connected, this, &PSClient::onConnected);
+    connect(m_transport, &BridgeTransport::disconnected, this, &PSClient::onDisconnected);
+    connect(m_transport, &BridgeTransport::errorOccurred, this, &PSClient::onErrorOccurred);
+    connect(m_transport, &BridgeTransport::readyRead, this, &PSClient::onReadyRead);
 
-    // Connect signals to handle socket events.
-    connect(m_socket, &QTcpSocket::connected, this, &PSClient::onConnected);
-    connect(m_socket, &QTcpSocket::readyRead, this, &PSClient::onReadyRead);
+    m_reconnectTimer.setSingleShot(true);
+    connect(&m_reconnectTimer, &QTimer::timeout, this, &PSClient::reconnect);
+
+    // The bridge may still be starting, failed attempts are retried with a growing delay
+    reconnect();
 }
 
-void PSClient::runScript(const QString &script)
+quint64 PSClient::runScript(const QString &script, const bool sticky)
 {
-    qDebug() << "Attempting to connect to server...";
-    m_socket->connectToHost("127.0.0.1", 12345);
+    const quint64 id = ++m_nextId;
+
+    if (script.toUtf8().size() > qsizetype(bridge::MaxPayload))
+    {
+        // Reported once the caller knows the id
+        QTimer::singleShot(0, this, [this, id] { emit scriptFailed(id, "The script is too large to run."); });
+        return id;
+    }
 
-    // Wait for the connection to be established.
-    if(m_socket->waitForConnected())
+    const quint8 flags = sticky ? bridge::Sticky : bridge::NoRunFlags;
+    if (isConnected())
     {
-        qDebug() << "Connected! Sending script...";
-        // Send the script text, followed by a newline character.
-        m_socket->write((script + "\n").toUtf8());
-        m_socket->flush();
+        send(id, script, flags);
     }
     else
     {
-        qDebug() << "Connection failed:" << m_socket->errorString();
+        m_queued.append({id, script, flags, QDeadlineTimer(QueueTimeout)});
+        if (m_transport->isClosed())
+        {
+            // Skip the backoff, someone is waiting for this one
+            m_reconnectTimer.stop();
+            reconnect();
+        }
+    }
+
+    return id;
+}
+
+void PSClient::cancelScript(const quint64 requestId)
+{
+    // Not sent yet, so it never has to reach the bridge
+    for (auto it = m_queued.begin(); it != m_queued.end(); ++it)
+    {
+        if (it->id == requestId)
+        {
+            m_queued.erase(it);
+            emit scriptFinished(requestId, bridge::RunStatus::Cancelled, "The script was cancelled before it started.");
+            return;
+        }
+    }
+
+    if (m_inFlight.contains(requestId) && isConnected())
+    {
+        m_transport->write(bridge::encode(bridge::MessageType::Cancel, requestId));
+    }
+}
+
+void PSClient::configure(const int poolSize, const QStringList &modules)
+{
+    const QJsonObject configuration{
+        {"poolSize", poolSize},
+        {"modules", QJsonArray::fromStringList(modules)},
+    };
+    QByteArray payload = QJsonDocument(configuration).toJson(QJsonDocument::Compact);
+    if (payload == m_configuration)
+    {
+        return;
+    }
+
+    m_configuration = std::move(payload);
+    if (isConnected())
+    {
+        m_transport->write(bridge::encode(bridge::MessageType::Configure, 0, m_configuration));
+    }
+}
+
+void PSClient::send(const quint64 id, const QString &script, const quint8 flags)
+{
+    m_transport->write(bridge::encode(bridge::MessageType::Run, id, script.toUtf8(), flags));
+    m_inFlight.insert(id);
+}
+
+void PSClient::reconnect()
+{
+    m_transport->open();
+}
+
+void PSClient::scheduleReconnect()
+{
+    if (m_reconnectTimer.isActive())
+    {
+        return;
+    }
+
+    m_reconnectTimer.start(m_reconnectDelay);
+    m_reconnectDelay = std::min(m_reconnectDelay * 2, MaxReconnectDelay);
+}
+
+void PSClient::failExpired()
+{
+    for (auto it = m_queued.begin(); it != m_queued.end();)
+    {
+        if (it->deadline.hasExpired())
+        {
+            emit scriptFailed(it->id, "Could not connect to the PowerShell bridge: " + m_transport->errorString());
+            it = m_queued.erase(it);
+        }
+        else
+        {
+            ++it;
+        }
     }
 }
 
 void PSClient::onConnected()
 {
     qDebug() << "Successfully connected to the C# server.";
+
+    m_reconnectDelay = MinReconnectDelay;
+    m_reader.clear();
+
+    // The bridge closes connections that send anything else first
+    m_transport->write(bridge::encode(bridge::MessageType::Hello, 0, m_token));
+    emit connectionStateChanged(true);
+
+    // A new ring per connection, whatever the last one still holds belongs to runs that were lost
+    if (m_ring.create())
+    {
+        m_transport->write(bridge::encode(bridge::MessageType::Ring, 0, m_ring.path().toUtf8()));
+    }
+
+    // A restarted bridge starts with its default pool
+    if (!m_configuration.isEmpty())
+    {
+        m_transport->write(bridge::encode(bridge::MessageType::Configure, 0, m_configuration));
+    }
+
+    const QList<QueuedScript> queued = std::exchange(m_queued, {});
+    for (const QueuedScript &request : queued)
+    {
+        send(request.id, request.script, request.flags);
+    }
+}
+
+void PSClient::onDisconnected()
+{
+    qDebug() << "Disconnected from the C# server.";
+
+    emit connectionStateChanged(false);
+
+    // The bridge drops the runs of a closed connection
+    m_recordTypes.clear();
+    const QSet<quint64> lost = std::exchange(m_inFlight, {});
+    for (const quint64 id : lost)
+    {
+        emit scriptFailed(id, "The connection to the PowerShell bridge was lost.");
+    }
+
+    scheduleReconnect();
+}
+
+void PSClient::onErrorOccurred(const QString &error)
+{
+    qDebug() << "PowerShell bridge connection:" << error;
+
+    failExpired();
+
+    if (m_transport->isClosed())
+    {
+        scheduleReconnect();
+    }
 }
 
 void PSClient::onReadyRead()
 {
-    // Read the response from the server.
-    QByteArray data = m_socket->readAll();
-    QString result = QString::fromUtf8(data).trimmed();
-    qDebug() << "Received result from C#:" << result;
+    m_reader.append(m_transport->readAll());
+
+    // A read may hold part of a frame or several of them
+    bool corrupt = false;
+    while (const std::optional<bridge::Frame> frame = m_reader.next())
+    {
+        if (!handleFrame(*frame))
+        {
+            corrupt = true;
+            break;
+        }
+    }
 
-    // Emit a signal so other parts of your GUI can use the result.
-    emit scriptResultReceived(QVariant::fromValue(result));
+    if (corrupt || m_reader.hasError())
+    {
+        // Nothing after a bad header can be trusted, start over on a new connection.
+        // Emits disconnected(), which fails the runs in flight and reconnects.
+        qDebug() << "Corrupt frame from the C# server, reconnecting.";
+        m_transport->abort();
+    }
+}
+
+bool PSClient::handleFrame(const bridge::Frame &frame)
+{
+    if (frame.type == bridge::MessageType::BulkOutput)
+    {
+        // Released even when nobody waits for the text any more
+        return handleBulkOutput(frame);
+    }
+
+    if (!m_inFlight.contains(frame.requestId))
+    {
+        qDebug() << "Dropping a frame for an unknown request:" << frame.requestId;
+        return true;
+    }
+
+    switch (frame.type)
+    {
+    case bridge::MessageType::Output:
+        emit outputReceived(frame.requestId, static_cast<bridge::OutputStream>(frame.flags),
+                            QString::fromUtf8(frame.payload));
+        break;
+
+    case bridge::MessageType::Error:
+        emit outputReceived(frame.requestId, bridge::OutputStream::Error, QString::fromUtf8(frame.payload));
+        break;
+
+    case bridge::MessageType::Records:
+        return handleRecords(frame);
+
+    case bridge::MessageType::ErrorRecords:
+        {
+            QList<bridge::ErrorDetails> errors;
+            if (!bridge::decodeErrorRecords(frame.payload, errors))
+            {
+                qDebug() << "Malformed error records from the C# server.";
+                return false;
+            }
+            emit errorsReceived(frame.requestId, errors);
+            break;
+        }
+
+    case bridge::MessageType::Progress:
+        {
+            qint32 percent = -1;
+            QString activity;
+            if (bridge::decodeStatus(frame.payload, percent, activity))
+            {
+                emit progressReceived(frame.requestId, percent, activity);
+            }
+            break;
+        }
+
+    case bridge::MessageType::Completed:
+        {
+            qint32 status = 0;
+            QString message;
+            if (!bridge::decodeStatus(frame.payload, status, message))
+            {
+                status = static_cast<qint32>(bridge::RunStatus::Failed);
+                message = "Malformed completion from the PowerShell bridge.";
+            }
+
+            m_inFlight.remove(frame.requestId);
+            m_recordTypes.remove(frame.requestId);
+            emit scriptFinished(frame.requestId, static_cast<bridge::RunStatus>(status), message);
+            break;
+        }
+
+    default:
+        qDebug() << "Dropping an unexpected frame of type" << static_cast<int>(frame.type);
+        break;
+    }
+
+    return true;
+}
+
+bool PSClient::handleBulkOutput(const bridge::Frame &frame)
+{
+    quint64 offset = 0;
+    quint32 length = 0;
+    const QByteArrayView text = bridge::decodeBulk(frame.payload, offset, length)
+                                    ? m_ring.view(offset, length)
+                                    : QByteArrayView();
+    if (text.isNull())
+    {
+        qDebug() << "Bulk output outside the shared ring.";
+        return false;
+    }
+
+    if (m_inFlight.contains(frame.requestId))
+    {
+        // Decoded straight from the ring, the text is not copied on the way
+        emit outputReceived(frame.requestId, static_cast<bridge::OutputStream>(frame.flags), QString::fromUtf8(text));
+    }
+
+    m_ring.release(offset, length);
+    return true;
+}
+
+bool PSClient::handleRecords(const bridge::Frame &frame)
+{
+    // Types of later frames refer to the ones defined here, a frame that cannot be read breaks the run
+    QList<bridge::RecordType> &types = m_recordTypes[frame.requestId];
+    if (!bridge::registerRecordTypes(frame.payload, types))
+    {
+        qDebug() << "Malformed records from the C# server.";
+        return false;
+    }
 
-    // Close the connection after receiving the result.
-    m_socket->close();
+    // Both are implicitly shared, the batch copies neither
+    emit recordsReceived(frame.requestId, bridge::RecordBatch{frame.payload, types});
+    return true;
 }
@@ -5,25 +5,135 @@
 #ifndef POWERSHELL_CLIENT_H
 #define POWERSHELL_CLIENT_H
 
+#include <QDeadlineTimer>
+#include <QHash>
+#include <QList>
 #include <QObject>
-#include <QTcpSocket>
+#include <QSet>
+#include <QStringList>
+#include <QTimer>
 
+#include "BridgeProtocol.h"
+#include "BridgeTransport.h"
+#include "RecordReader.h"
+#include "SharedRing.h"
+
+/**
+ * Client for the PowerShell bridge process.
+ *
+ * A single connection is kept open for the whole session and reopened whenever
+ * it drops. Every script gets a request id, several scripts can be in flight at
+ * once, and each reply is matched back to its request by id. Scripts submitted
+ * while the bridge is not reachable wait until it is, or fail after QueueTimeout.
+ *
+ * Output is passed on as the bridge streams it, in the batches it was framed
+ * in, and is not kept here. Messages are framed as described in BridgeProtocol.h.
+ *
+ * Every connection starts with a Hello frame carrying the session token; the
+ * bridge closes connections that do not, so only this app can run scripts.
+ * Large outputs arrive through a SharedRing made for each connection, or
+ * inline when the ring could not be set up or is full. Objects and the error
+ * records of a script arrive typed, see RecordReader.h.
+ */
 class PSClient final : public QObject
 {
     Q_OBJECT
 public:
+    // Connects to the bridge of this session, see BridgeEndpoint::session()
     explicit PSClient(QObject *parent = nullptr);
-    void runScript(const QString &script);
+
+    // Takes ownership of transport
+    PSClient(BridgeTransport *transport, QByteArray token, QObject *parent = nullptr);
+
+    /**
+     * Never blocks. Returns the id that the result of script will carry.
+     * A sticky script runs in the session runspace, which keeps variables and
+     * imports between sticky runs; other scripts run on the bridge's pool.
+     */
+    quint64 runScript(const QString &script, bool sticky = false);
+
+    /**
+     * Sets the number of warm runspaces the bridge keeps and the modules imported
+     * into them. Sent again after every reconnect; the bridge only rebuilds its
+     * pool when something changed.
+     */
+    void configure(int poolSize, const QStringList &modules);
+
+    /**
+     * Asks the bridge to stop the run requestId. The run still ends with
+     * scriptFinished, with RunStatus::Cancelled unless it completed first.
+     */
+    void cancelScript(quint64 requestId);
+
+    [[nodiscard]] bool isConnected() const { return m_transport->isConnected(); }
 
     signals:
-        void scriptResultReceived(const QVariant &result);
+        // One or more newline terminated records written by the script
+        void outputReceived(quint64 requestId, bridge::OutputStream stream, const QString &text);
+
+        // Objects written by the script, with every type of the run defined so far
+        void recordsReceived(quint64 requestId, const bridge::RecordBatch &batch);
+
+        // Error records written by the script; errors of the bridge itself come as outputReceived
+        void errorsReceived(quint64 requestId, const QList<bridge::ErrorDetails> &errors);
+
+        // percent is -1 when the activity has no percentage
+        void progressReceived(quint64 requestId, int percent, const QString &activity);
+
+        // The last signal of a run that reached the bridge
+        void scriptFinished(quint64 requestId, bridge::RunStatus status, const QString &message);
+
+        // The script never ran or the rest of its output was lost with the connection
+        void scriptFailed(quint64 requestId, const QString &error);
+
+        void connectionStateChanged(bool connected);
 
 private slots:
     void onConnected();
+    void onDisconnected();
+    void onErrorOccurred(const QString &error);
     void onReadyRead();
+    void reconnect();
 
 private:
-    QTcpSocket *m_socket;
+    static constexpr int MinReconnectDelay = 100;
+    static constexpr int MaxReconnectDelay = 5000;
+    static constexpr int QueueTimeout = 30000;
+
+    struct QueuedScript
+    {
+        quint64 id;
+        QString script;
+        quint8 flags;
+        QDeadlineTimer deadline;
+    };
+
+    BridgeTransport *m_transport;
+    QByteArray m_token;
+    QTimer m_reconnectTimer;
+    int m_reconnectDelay = MinReconnectDelay;
+
+    quint64 m_nextId = 0;
+    // Submitted while disconnected, sent once connected
+    QList<QueuedScript> m_queued;
+    // Sent and not completed yet
+    QSet<quint64> m_inFlight;
+    // Record types each run in flight defined so far
+    QHash<quint64, QList<bridge::RecordType>> m_recordTypes;
+
+    bridge::FrameReader m_reader;
+    SharedRing m_ring;
+
+    // Payload of the last Configure frame, empty if configure() was never called
+    QByteArray m_configuration;
+
+    void send(quint64 id, const QString &script, quint8 flags);
+    // False if the frame makes the rest of the stream untrustworthy
+    bool handleFrame(const bridge::Frame &frame);
+    bool handleBulkOutput(const bridge::Frame &frame);
+    bool handleRecords(const bridge::Frame &frame);
+    void scheduleReconnect();
+    void failExpired();
 };
 
 #endif // POWERSHELL_CLIENT_H
@@ -0,0 +1,517 @@
+//
+// Created by talik on 10/18/2026.
+//
+
+#include "RecordReader.h"
+
+#include <algorithm>
+#include <bit>
+#include <climits>
+#include <cstring>
+#include <limits>
+#include <utility>
+#include <QDateTime>
+#include <QFloat16>
+#include <QLocale>
+#include <QtEndian>
+
+namespace
+{
+    using bridge::RecordValue;
+
+    // CBOR major types
+    constexpr quint8 Unsigned = 0;
+    constexpr quint8 Negative = 1;
+    constexpr quint8 ByteString = 2;
+    constexpr quint8 TextString = 3;
+    constexpr quint8 Array = 4;
+    constexpr quint8 Map = 5;
+    constexpr quint8 Tag = 6;
+    constexpr quint8 Simple = 7;
+
+    // Epoch based date/time
+    constexpr quint64 EpochTag = 1;
+
+    // First element of every item of a Records payload
+    constexpr qint64 TypeItem = 0;
+    constexpr qint64 RowItem = 1;
+
+    // Elements of an ErrorRecords item
+    constexpr quint64 ErrorFields = 8;
+
+    // The bridge nests no deeper; anything past it is malformed
+    constexpr int MaxDepth = 8;
+
+    struct Head
+    {
+        quint8 major = 0;
+        quint8 info = 0;
+        quint64 value = 0;
+    };
+
+    bool readHead(const QByteArrayView data, qsizetype& position, Head& head)
+    {
+        if (position >= data.size())
+        {
+            return false;
+        }
+
+        const auto initial = static_cast<quint8>(data[position++]);
+        head.major = initial >> 5;
+        head.info = initial & 0x1f;
+        if (head.info < 24)
+        {
+            head.value = head.info;
+            return true;
+        }
+
+        // Indefinite lengths and the reserved values are never written
+        if (head.info > 27)
+        {
+            return false;
+        }
+
+        const qsizetype count = qsizetype(1) << (head.info - 24);
+        if (data.size() - position < count)
+        {
+            return false;
+        }
+
+        const char* bytes = data.data() + position;
+        switch (count)
+        {
+        case 1:
+            head.value = static_cast<quint8>(*bytes);
+            break;
+        case 2:
+            head.value = qFromBigEndian<quint16>(bytes);
+            break;
+        case 4:
+            head.value = qFromBigEndian<quint32>(bytes);
+            break;
+        default:
+            head.value = qFromBigEndian<quint64>(bytes);
+            break;
+        }
+        position += count;
+        return true;
+    }
+
+    // The text or bytes that follow head, false if they run past the end
+    bool readString(const QByteArrayView data, qsizetype& position, const Head& head, QByteArrayView& bytes)
+    {
+        if (head.value > quint64(data.size() - position))
+        {
+            return false;
+        }
+
+        bytes = data.sliced(position, qsizetype(head.value));
+        position += qsizetype(head.value);
+        return true;
+    }
+
+    bool skip(const QByteArrayView data, qsizetype& position, const int depth)
+    {
+        Head head;
+        if (depth > MaxDepth || !readHead(data, position, head))
+        {
+            return false;
+        }
+
+        switch (head.major)
+        {
+        case ByteString:
+        case TextString:
+            {
+                QByteArrayView ignored;
+                return readString(data, position, head, ignored);
+            }
+
+        case Array:
+        case Map:
+            {
+                // Every element takes at least a byte
+                if (head.value > quint64(data.size() - position))
+                {
+                    return false;
+                }
+
+                const quint64 count = head.major == Map ? head.value * 2 : head.value;
+                for (quint64 i = 0; i < count; ++i)
+                {
+                    if (!skip(data, position, depth + 1))
+                    {
+                        return false;
+                    }
+                }
+                return true;
+            }
+
+        case Tag:
+            return skip(data, position, depth + 1);
+
+        default:
+            // Integers and simple values are all head
+            return true;
+        }
+    }
+
+    double toDouble(const Head& head)
+    {
+        switch (head.info)
+        {
+        case 25:
+            {
+                const auto bits = static_cast<quint16>(head.value);
+                qfloat16 half;
+                memcpy(&half, &bits, sizeof(bits));
+                return double(half);
+            }
+        case 26:
+            return std::bit_cast<float>(static_cast<quint32>(head.value));
+        default:
+            return std::bit_cast<double>(head.value);
+        }
+    }
+
+    bool readValue(const QByteArrayView data, qsizetype& position, RecordValue& value, const int depth = 0)
+    {
+        const qsizetype start = position;
+        Head head;
+        if (depth > MaxDepth || !readHead(data, position, head))
+        {
+            return false;
+        }
+
+        value = RecordValue();
+        constexpr auto largest = quint64(std::numeric_limits<qint64>::max());
+        switch (head.major)
+        {
+        case Unsigned:
+            if (head.value > largest)
+            {
+                value.kind = RecordValue::Kind::Double;
+                value.number = double(head.value);
+            }
+            else
+            {
+                value.kind = RecordValue::Kind::Integer;
+                value.integer = qint64(head.value);
+            }
+            return true;
+
+        case Negative:
+            if (head.value > largest)
+            {
+                value.kind = RecordValue::Kind::Double;
+                value.number = -1.0 - double(head.value);
+            }
+            else
+            {
+                value.kind = RecordValue::Kind::Integer;
+                value.integer = -1 - qint64(head.value);
+            }
+            return true;
+
+        case ByteString:
+        case TextString:
+            value.kind = head.major == TextString ? RecordValue::Kind::Text : RecordValue::Kind::Bytes;
+            return readString(data, position, head, value.bytes);
+
+        case Tag:
+            if (!readValue(data, position, value, depth + 1))
+            {
+                return false;
+            }
+            if (head.value == EpochTag && value.kind == RecordValue::Kind::Integer)
+            {
+                value.kind = RecordValue::Kind::DateTime;
+                value.number = double(value.integer);
+            }
+            else if (head.value == EpochTag && value.kind == RecordValue::Kind::Double)
+            {
+                value.kind = RecordValue::Kind::DateTime;
+            }
+            return true;
+
+        case Simple:
+            if (head.info == 20 || head.info == 21)
+            {
+                value.kind = RecordValue::Kind::Bool;
+                value.boolean = head.info == 21;
+            }
+            else if (head.info >= 25)
+            {
+                value.kind = RecordValue::Kind::Double;
+                value.number = toDouble(head);
+            }
+            return true;
+
+        default:
+            // Arrays and maps are not written as values, they read as null
+            position = start;
+            return skip(data, position, depth);
+        }
+    }
+
+    bool readInteger(const QByteArrayView data, qsizetype& position, qint64& integer)
+    {
+        RecordValue value;
+        if (!readValue(data, position, value) || value.kind != RecordValue::Kind::Integer)
+        {
+            return false;
+        }
+
+        integer = value.integer;
+        return true;
+    }
+
+    // Null reads as an empty text
+    bool readText(const QByteArrayView data, qsizetype& position, QString& text)
+    {
+        RecordValue value;
+        if (!readValue(data, position, value) ||
+            (value.kind != RecordValue::Kind::Text && value.kind != RecordValue::Kind::Null))
+        {
+            return false;
+        }
+
+        text = QString::fromUtf8(value.bytes);
+        return true;
+    }
+
+    bool readArrayHeader(const QByteArrayView data, qsizetype& position, quint64& count)
+    {
+        Head head;
+        if (!readHead(data, position, head) || head.major != Array || head.value > quint64(data.size() - position))
+        {
+            return false;
+        }
+
+        count = head.value;
+        return true;
+    }
+
+    // Opens an item of a Records payload: its element count and what kind of item it is
+    bool readItem(const QByteArrayView data, qsizetype& position, quint64& count, qint64& kind)
+    {
+        return readArrayHeader(data, position, count) && count >= 2 && readInteger(data, position, kind);
+    }
+}
+
+namespace bridge
+{
+    QVariant RecordValue::toVariant() const
+    {
+        switch (kind)
+        {
+        case Kind::Bool:
+            return boolean;
+        case Kind::Integer:
+            return qlonglong(integer);
+        case Kind::Double:
+            return number;
+        case Kind::Text:
+            return QString::fromUtf8(bytes);
+        case Kind::Bytes:
+            return bytes.toByteArray();
+        case Kind::DateTime:
+            return QDateTime::fromMSecsSinceEpoch(qRound64(number * 1000));
+        default:
+            return {};
+        }
+    }
+
+    QString RecordValue::toString() const
+    {
+        switch (kind)
+        {
+        case Kind::Bool:
+            return boolean ? QStringLiteral("True") : QStringLiteral("False");
+        case Kind::Integer:
+            return QString::number(integer);
+        case Kind::Double:
+            return QString::number(number, 'g', QLocale::FloatingPointShortest);
+        case Kind::Text:
+            return QString::fromUtf8(bytes);
+        case Kind::Bytes:
+            return QString::fromLatin1(QByteArray::fromRawData(bytes.data(), bytes.size()).toHex(' '));
+        case Kind::DateTime:
+            return QDateTime::fromMSecsSinceEpoch(qRound64(number * 1000)).toString(Qt::ISODate);
+        default:
+            return {};
+        }
+    }
+
+    bool registerRecordTypes(const QByteArrayView payload, QList<RecordType>& types)
+    {
+        qsizetype position = 0;
+        while (position < payload.size())
+        {
+            const qsizetype start = position;
+            quint64 count = 0;
+            qint64 kind = -1;
+            if (!readItem(payload, position, count, kind))
+            {
+                return false;
+            }
+
+            if (kind != TypeItem)
+            {
+                position = start;
+                if (!skip(payload, position, 0))
+                {
+                    return false;
+                }
+                continue;
+            }
+
+            // Types are numbered in the order they are defined
+            qint64 typeId = -1;
+            quint64 propertyCount = 0;
+            RecordType type;
+            if (count != 4 || !readInteger(payload, position, typeId) || typeId != types.size() ||
+                !readText(payload, position, type.name) || !readArrayHeader(payload, position, propertyCount))
+            {
+                return false;
+            }
+
+            type.properties.reserve(qsizetype(propertyCount));
+            for (quint64 i = 0; i < propertyCount; ++i)
+            {
+                QString property;
+                if (!readText(payload, position, property))
+                {
+                    return false;
+                }
+                type.properties.append(std::move(property));
+            }
+            types.append(std::move(type));
+        }
+
+        return true;
+    }
+
+    RecordReader::RecordReader(const RecordBatch& batch) : m_batch(batch)
+    {
+    }
+
+    bool RecordReader::next()
+    {
+        const QByteArrayView data = m_batch.payload;
+        while (!m_error && m_position < data.size())
+        {
+            const qsizetype start = m_position;
+            quint64 count = 0;
+            qint64 kind = -1;
+            if (!readItem(data, m_position, count, kind))
+            {
+                m_error = true;
+                break;
+            }
+
+            // Types were registered when the batch arrived
+            if (kind != RowItem)
+            {
+                m_position = start;
+                m_error = !skip(data, m_position, 0);
+                continue;
+            }
+
+            qint64 typeId = -1;
+            quint64 valueCount = 0;
+            if (count != 3 || !readInteger(data, m_position, typeId) || typeId < 0 ||
+                typeId >= m_batch.types.size() || !readArrayHeader(data, m_position, valueCount) ||
+                valueCount != quint64(m_batch.types.at(typeId).properties.size()))
+            {
+                m_error = true;
+                break;
+            }
+
+            // Keeps its capacity from row to row
+            m_type = typeId;
+            m_values.resize(qsizetype(valueCount));
+            for (RecordValue& value : m_values)
+            {
+                if (!readValue(data, m_position, value))
+                {
+                    m_error = true;
+                    break;
+                }
+            }
+
+            if (!m_error)
+            {
+                return true;
+            }
+        }
+
+        m_type = -1;
+        m_values.clear();
+        return false;
+    }
+
+    QString RecordReader::toText() const
+    {
+        const QStringList& names = type().properties;
+
+        qsizetype width = 0;
+        for (const QString& name : names)
+        {
+            width = std::max(width, name.size());
+        }
+
+        QString text;
+        for (qsizetype i = 0; i < m_values.size(); ++i)
+        {
+            text += names.at(i).leftJustified(width) + " : " + m_values.at(i).toString() + '\n';
+        }
+        return text;
+    }
+
+    QString ErrorDetails::toText() const
+    {
+        QString text = message + '\n';
+        if (line > 0)
+        {
+            text += QString("At line:%1 char:%2\n").arg(line).arg(column);
+        }
+        if (!category.isEmpty())
+        {
+            text += "    + CategoryInfo          : " + category + (target.isEmpty() ? QString() : ": (" + target + ")") +
+                '\n';
+        }
+        if (!errorId.isEmpty())
+        {
+            text += "    + FullyQualifiedErrorId : " + errorId + '\n';
+        }
+        return text;
+    }
+
+    bool decodeErrorRecords(const QByteArrayView payload, QList<ErrorDetails>& errors)
+    {
+        qsizetype position = 0;
+        while (position < payload.size())
+        {
+            quint64 count = 0;
+            ErrorDetails error;
+            qint64 line = 0;
+            qint64 column = 0;
+            if (!readArrayHeader(payload, position, count) || count != ErrorFields ||
+                !readText(payload, position, error.message) || !readText(payload, position, error.errorId) ||
+                !readText(payload, position, error.category) || !readText(payload, position, error.target) ||
+                !readText(payload, position, error.exceptionType) ||
+                !readText(payload, position, error.scriptStackTrace) || !readInteger(payload, position, line) ||
+                !readInteger(payload, position, column))
+            {
+                return false;
+            }
+
+            error.line = int(std::clamp<qint64>(line, 0, INT_MAX));
+            error.column = int(std::clamp<qint64>(column, 0, INT_MAX));
+            errors.append(std::move(error));
+        }
+
+        return true;
+    }
+}
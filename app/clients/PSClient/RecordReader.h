@@ -0,0 +1,126 @@
+//
+// Created by talik on 10/18/2026.
+//
+
+#ifndef RECORD_READER_H
+#define RECORD_READER_H
+
+#include <QByteArray>
+#include <QByteArrayView>
+#include <QList>
+#include <QString>
+#include <QStringList>
+#include <QVariant>
+
+/**
+ * Readers for the Records and ErrorRecords payloads of the bridge, see
+ * BridgeProtocol.h. Both are CBOR sequences written by RecordEncoder in
+ * Buraq.Bridge.cs.
+ *
+ * Records are read where they lie: a RecordValue of text or bytes points into
+ * the payload, and nothing is decoded into a QString until someone asks, so a
+ * table can show, sort or filter thousands of rows without copying them.
+ */
+namespace bridge
+{
+    // A property value of a record. Text and bytes point into the payload they were read from.
+    struct RecordValue
+    {
+        enum class Kind : quint8
+        {
+            Null,
+            Bool,
+            Integer,
+            Double,
+            Text,
+            Bytes,
+            // number holds seconds since the Unix epoch
+            DateTime,
+        };
+
+        Kind kind = Kind::Null;
+        bool boolean = false;
+        qint64 integer = 0;
+        double number = 0;
+        QByteArrayView bytes;
+
+        // Copies text and bytes out of the payload
+        [[nodiscard]] QVariant toVariant() const;
+
+        // As the console shows it
+        [[nodiscard]] QString toString() const;
+    };
+
+    // The properties of a type of record, sent once per run before the first record of the type
+    struct RecordType
+    {
+        QString name;
+        QStringList properties;
+    };
+
+    // A Records payload and every type its run defined up to and including it
+    struct RecordBatch
+    {
+        QByteArray payload;
+        QList<RecordType> types;
+    };
+
+    // Appends the types a Records payload defines to types; false if the payload is malformed
+    bool registerRecordTypes(QByteArrayView payload, QList<RecordType>& types);
+
+    /**
+     * Walks the records of a batch, which must outlive the reader:
+     *
+     *   RecordReader reader(batch);
+     *   while (reader.next())
+     *       for (qsizetype i = 0; i < reader.size(); ++i) use(reader.type().properties[i], reader.value(i));
+     */
+    class RecordReader
+    {
+    public:
+        explicit RecordReader(const RecordBatch& batch);
+
+        // Moves to the next record; false at the end of the batch or on malformed data
+        bool next();
+
+        [[nodiscard]] bool hasError() const { return m_error; }
+
+        [[nodiscard]] const RecordType& type() const { return m_batch.types.at(m_type); }
+
+        // Number of values of the current record, the same as its type has properties
+        [[nodiscard]] qsizetype size() const { return m_values.size(); }
+
+        [[nodiscard]] const RecordValue& value(const qsizetype index) const { return m_values.at(index); }
+
+        // One "Name : value" line per property, the way Format-List shows an object
+        [[nodiscard]] QString toText() const;
+
+    private:
+        const RecordBatch& m_batch;
+        qsizetype m_position = 0;
+        qsizetype m_type = -1;
+        QList<RecordValue> m_values;
+        bool m_error = false;
+    };
+
+    // An error record a script wrote; line and column are 0 when unknown
+    struct ErrorDetails
+    {
+        QString message;
+        QString errorId;
+        QString category;
+        QString target;
+        QString exceptionType;
+        QString scriptStackTrace;
+        int line = 0;
+        int column = 0;
+
+        // Laid out like PowerShell's own error view
+        [[nodiscard]] QString toText() const;
+    };
+
+    // Decodes an ErrorRecords payload; false if it is malformed
+    bool decodeErrorRecords(QByteArrayView payload, QList<ErrorDetails>& errors);
+}
+
+#endif //RECORD_READER_H
@@ -0,0 +1,105 @@
+//
+// Created by talik on 10/18/2026.
+//
+
+#include "SharedRing.h"
+
+#include <atomic>
+#include <QDebug>
+#include <QRandomGenerator>
+#include <QStringList>
+#include <QtEndian>
+
+#include "BridgeTransport.h"
+
+namespace
+{
+    // Files still mapped by the bridge when they were closed; Windows does not delete those
+    QStringList& leftovers()
+    {
+        static QStringList paths;
+        return paths;
+    }
+}
+
+bool SharedRing::create(const quint64 capacity)
+{
+    close();
+
+    leftovers().removeIf([](const QString& path) { return QFile::remove(path) || !QFile::exists(path); });
+
+    const QString name = QString("/buraq-ring-%1.bin").arg(QRandomGenerator::system()->generate64(), 16, 16,
+                                                            QLatin1Char('0'));
+    m_file.setFileName(BridgeEndpoint::privateDirectory() + name);
+    if (!m_file.open(QIODevice::ReadWrite | QIODevice::NewOnly))
+    {
+        qDebug() << "Could not create the shared ring:" << m_file.errorString();
+        return false;
+    }
+
+    m_file.setPermissions(QFileDevice::ReadOwner | QFileDevice::WriteOwner);
+    if (!m_file.resize(DataOffset + qint64(capacity)) ||
+        (m_map = m_file.map(0, DataOffset + qint64(capacity))) == nullptr)
+    {
+        qDebug() << "Could not map the shared ring:" << m_file.errorString();
+        close();
+        return false;
+    }
+
+    m_capacity = capacity;
+    m_tail = 0;
+    qToLittleEndian<quint32>(Magic, m_map);
+    qToLittleEndian<quint32>(Version, m_map + 4);
+    qToLittleEndian<quint64>(capacity, m_map + CapacityOffset);
+    qToLittleEndian<quint64>(0, m_map + TailOffset);
+    return true;
+}
+
+void SharedRing::close()
+{
+    // Only a file this ring created is deleted
+    if (m_file.isOpen())
+    {
+        if (m_map)
+        {
+            m_file.unmap(m_map);
+            m_map = nullptr;
+        }
+        m_file.close();
+
+        if (!QFile::remove(m_file.fileName()))
+        {
+            leftovers().append(m_file.fileName());
+        }
+    }
+    m_file.setFileName(QString());
+
+    m_capacity = 0;
+    m_tail = 0;
+}
+
+QByteArrayView SharedRing::view(const quint64 offset, const quint32 length) const
+{
+    // Blocks come in order, after everything released and never more than a lap ahead
+    if (!m_map || offset < m_tail || length > m_capacity || offset % m_capacity + length > m_capacity ||
+        offset + length - m_tail > m_capacity)
+    {
+        return {};
+    }
+
+    return {reinterpret_cast<const char*>(m_map + DataOffset + offset % m_capacity), qsizetype(length)};
+}
+
+void SharedRing::release(const quint64 offset, const quint32 length)
+{
+    if (!m_map)
+    {
+        return;
+    }
+
+    m_tail = offset + length;
+
+    // Both processes run on the same little endian machine, so the native order is the file's order.
+    // Released after the text was decoded, so the bridge never overwrites bytes still being read.
+    std::atomic_ref<quint64>(*reinterpret_cast<quint64*>(m_map + TailOffset)).store(m_tail, std::memory_order_release);
+}
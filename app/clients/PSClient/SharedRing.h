@@ -0,0 +1,78 @@
+//
+// Created by talik on 10/18/2026.
+//
+
+#ifndef SHARED_RING_H
+#define SHARED_RING_H
+
+#include <QByteArrayView>
+#include <QFile>
+#include <QString>
+
+/**
+ * Memory mapped file through which the bridge hands large outputs to the app.
+ *
+ * The app creates one per connection and sends its path in a Ring frame. The
+ * bridge copies the UTF-8 text of a large batch straight into the data area and
+ * sends a BulkOutput frame with its offset and length instead of the text, so
+ * the bytes cross between the processes once, at memory speed, and are decoded
+ * where they lie. Keep the layout in sync with SharedRing in Buraq.Bridge.cs:
+ *
+ *   0    u32  magic "BRQR"
+ *   4    u32  version, 1
+ *   8    u64  capacity of the data area
+ *   64   u64  tail: every offset below it may be overwritten, written by the app
+ *   128       data area
+ *
+ * Offsets grow forever and point at (offset % capacity) in the data area. A
+ * block never wraps: the bridge skips the rest of the data area when a block
+ * does not fit before its end. The app releases blocks in the order their
+ * frames arrive, which is the order they were written in; the bridge sends
+ * the text inline whenever the ring is full.
+ */
+class SharedRing final
+{
+public:
+    static constexpr quint64 DefaultCapacity = 32 * 1024 * 1024;
+
+    SharedRing() = default;
+
+    ~SharedRing() { close(); }
+
+    SharedRing(const SharedRing&) = delete;
+
+    SharedRing& operator=(const SharedRing&) = delete;
+
+    // Creates and maps a new ring file in BridgeEndpoint::privateDirectory(); false on failure
+    bool create(quint64 capacity = DefaultCapacity);
+
+    // Unmaps and deletes the file
+    void close();
+
+    [[nodiscard]] bool isOpen() const { return m_map != nullptr; }
+
+    [[nodiscard]] QString path() const { return m_file.fileName(); }
+
+    /**
+     * The bytes of a BulkOutput frame, valid until release(). Empty if the
+     * block is not one the bridge could have written next.
+     */
+    [[nodiscard]] QByteArrayView view(quint64 offset, quint32 length) const;
+
+    // Lets the bridge reuse everything up to the end of the block
+    void release(quint64 offset, quint32 length);
+
+private:
+    static constexpr quint32 Magic = 0x52515242;
+    static constexpr quint32 Version = 1;
+    static constexpr qint64 CapacityOffset = 8;
+    static constexpr qint64 TailOffset = 64;
+    static constexpr qint64 DataOffset = 128;
+
+    QFile m_file;
+    uchar* m_map = nullptr;
+    quint64 m_capacity = 0;
+    quint64 m_tail = 0;
+};
+
+#endif //SHARED_RING_H
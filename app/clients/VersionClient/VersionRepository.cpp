@@ -3,7 +3,6 @@
 //
 
 #include "VersionRepository.h"
-#include <thread>
 #include <mutex>
 #include <vector>
 #include <filesystem> // Requires C++17. For older C++, use platform-specific directory iteration.
@@ -101,10 +100,7 @@ void VersionRepository::get_manifest_json(const std::string& endpoint, UpdateInf
 
 UpdateInfo VersionRepository::main_version_logic()
 {
-    if (std::thread thread(get_manifest_json, endpoint, std::ref(versionInfo)); thread.joinable())
-    {
-        thread.join();
-    }
+    get_manifest_json(endpoint, versionInfo);
 
     try
     {
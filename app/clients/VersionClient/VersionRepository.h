@@ -22,7 +22,7 @@ public:
 	~VersionRepository() = default;
 
 	/**
-	 * Determines if there is a new version
+	 * Determines if there is a new version. Blocks on the network, run it on the TaskPool.
 	 * @return Returns the new version object or an empty version object otherwise.
 	 */
 	[[nodiscard]] UpdateInfo main_version_logic();
@@ -0,0 +1,481 @@
+//
+// Created by talik on 10/18/2026.
+//
+
+#include "RunHistory.h"
+
+#include <utility>
+#include <QCoreApplication>
+#include <QCryptographicHash>
+#include <QDateTime>
+#include <QSqlDatabase>
+#include <QSqlError>
+#include <QSqlQuery>
+#include <QVariant>
+
+#include "TaskPool.h"
+#include "buraq.h"
+
+namespace database
+{
+    namespace
+    {
+        constexpr auto INSERT_RUN_SQL =
+            "INSERT INTO runs(title, script_hash, script, queued_at, bridge_id, runspace) VALUES(?, ?, ?, ?, ?, ?);";
+
+        constexpr auto START_RUN_SQL = "UPDATE runs SET started_at = ? WHERE id = ?;";
+
+        constexpr auto FINISH_RUN_SQL =
+            "UPDATE runs SET finished_at = ?, duration_ms = ? - COALESCE(started_at, queued_at), status = ?, "
+            "message = ?, output_chars = ? WHERE id = ?;";
+
+        constexpr auto TRUNCATE_RUN_SQL = "UPDATE runs SET output_truncated = 1 WHERE id = ?;";
+
+        constexpr auto INSERT_OUTPUT_SQL = "INSERT INTO run_output(run_id, stream, text) VALUES(?, ?, ?);";
+
+        constexpr auto INDEX_OUTPUT_SQL = "INSERT INTO run_output_fts(rowid, text) VALUES(?, ?);";
+
+        constexpr auto SUMMARY_COLUMNS =
+            "id, title, script_hash, queued_at, started_at, finished_at, duration_ms, status, bridge_id, runspace, "
+            "output_truncated";
+
+        // A connection of the calling thread's own, closed and removed at the end of the scope
+        class Connection
+        {
+        public:
+            explicit Connection(const QString& path)
+                : m_name(QString("run-history-%1").arg(s_next.fetch_add(1, std::memory_order_relaxed)))
+            {
+                QSqlDatabase db = QSqlDatabase::addDatabase("QSQLITE", m_name);
+                db.setDatabaseName(path);
+                if (db.open())
+                {
+                    // The writer's transactions are short, waiting them out beats failing
+                    QSqlQuery(db).exec("PRAGMA busy_timeout = 5000;");
+                }
+                else
+                {
+                    file_utils::file_log("Run history: " + db.lastError().text().toStdString());
+                }
+            }
+
+            ~Connection()
+            {
+                QSqlDatabase::database(m_name, false).close();
+                QSqlDatabase::removeDatabase(m_name);
+            }
+
+            Connection(const Connection&) = delete;
+
+            Connection& operator=(const Connection&) = delete;
+
+            [[nodiscard]] QSqlDatabase database() const { return QSqlDatabase::database(m_name, false); }
+
+        private:
+            static inline std::atomic<quint64> s_next{0};
+            QString m_name;
+        };
+
+        bool hasFullText(const QSqlDatabase& db)
+        {
+            QSqlQuery query(db);
+            return query.exec("SELECT 1 FROM sqlite_master WHERE name = 'run_output_fts';") && query.next();
+        }
+
+        // Matches text anywhere, as typed
+        QString likePattern(QString text)
+        {
+            text.replace('\\', "\\\\").replace('%', "\\%").replace('_', "\\_");
+            return '%' + text + '%';
+        }
+
+        // One FTS5 phrase, so the user's quotes and operators are taken literally
+        QString fullTextPhrase(QString text)
+        {
+            return '"' + text.replace('"', "\"\"") + '"';
+        }
+
+        // From a query selecting SUMMARY_COLUMNS first
+        RunSummary readSummary(const QSqlQuery& query)
+        {
+            return RunSummary{
+                .id = query.value(0).toLongLong(),
+                .title = query.value(1).toString(),
+                .scriptHash = query.value(2).toString(),
+                .queuedAt = query.value(3).toLongLong(),
+                .startedAt = query.value(4).toLongLong(),
+                .finishedAt = query.value(5).toLongLong(),
+                .durationMs = query.value(6).toLongLong(),
+                .status = query.value(7).isNull() ? -1 : query.value(7).toInt(),
+                .bridgeId = query.value(8).toString(),
+                .runspace = query.value(9).toString(),
+                .truncated = query.value(10).toBool(),
+            };
+        }
+
+        RunDetails readDetails(const QSqlDatabase& db, const qint64 runId)
+        {
+            RunDetails details;
+
+            QSqlQuery run(db);
+            run.prepare(QString("SELECT %1, script FROM runs WHERE id = ?;").arg(SUMMARY_COLUMNS));
+            run.addBindValue(runId);
+            if (!run.exec() || !run.next())
+            {
+                return details;
+            }
+            details.run = readSummary(run);
+            details.script = run.value(11).toString();
+
+            QSqlQuery output(db);
+            output.prepare("SELECT text FROM run_output WHERE run_id = ? ORDER BY id;");
+            output.addBindValue(runId);
+            output.exec();
+            while (output.next())
+            {
+                details.output += output.value(0).toString();
+            }
+            return details;
+        }
+    }
+
+    RunHistory& RunHistory::instance()
+    {
+        // Parented to the application, so what is still queued is written before the workers stop
+        static const auto history = new RunHistory(
+            QSqlDatabase::database(QSqlDatabase::defaultConnection, false).isOpen()
+                ? QSqlDatabase::database(QSqlDatabase::defaultConnection, false).databaseName()
+                : QString(),
+            QCoreApplication::instance());
+        return *history;
+    }
+
+    RunHistory::RunHistory(QString databasePath, QObject* parent)
+        : QObject(parent), m_path(std::move(databasePath)), m_writer(std::make_shared<Writer>()),
+          m_strand(std::make_unique<TaskStrand>())
+    {
+        m_writer->path = m_path;
+
+        m_flushTimer.setSingleShot(true);
+        m_flushTimer.setInterval(FlushInterval);
+        connect(&m_flushTimer, &QTimer::timeout, this, &RunHistory::flush);
+    }
+
+    RunHistory::~RunHistory()
+    {
+        flush();
+        m_strand.reset();
+    }
+
+    void RunHistory::runQueued(const quint64 jobId, const QString& title, const QString& script,
+                               const QString& bridgeId, const QString& runspace)
+    {
+        queue(Entry{
+            .kind = Entry::Kind::Queued,
+            .jobId = jobId,
+            .time = QDateTime::currentMSecsSinceEpoch(),
+            .title = title,
+            .script = script,
+            .bridgeId = bridgeId,
+            .runspace = runspace,
+        });
+    }
+
+    void RunHistory::runStarted(const quint64 jobId)
+    {
+        queue(Entry{.kind = Entry::Kind::Started, .jobId = jobId, .time = QDateTime::currentMSecsSinceEpoch()});
+    }
+
+    void RunHistory::runOutput(const quint64 jobId, const bridge::OutputStream stream, const QString& text)
+    {
+        // Joined with the output queued before it while it fits one row
+        if (!m_pending.empty())
+        {
+            if (Entry& last = m_pending.back(); last.kind == Entry::Kind::Output && last.jobId == jobId &&
+                last.code == static_cast<int>(stream) && last.text.size() < ChunkChars)
+            {
+                last.text += text;
+                m_pendingChars += text.size();
+                if (m_pendingChars >= MaxPendingChars)
+                {
+                    flush();
+                }
+                return;
+            }
+        }
+
+        queue(Entry{
+            .kind = Entry::Kind::Output,
+            .jobId = jobId,
+            .time = QDateTime::currentMSecsSinceEpoch(),
+            .code = static_cast<int>(stream),
+            .text = text,
+        });
+    }
+
+    void RunHistory::runFinished(const quint64 jobId, const bridge::RunStatus status, const QString& message)
+    {
+        queue(Entry{
+            .kind = Entry::Kind::Finished,
+            .jobId = jobId,
+            .time = QDateTime::currentMSecsSinceEpoch(),
+            .code = static_cast<int>(status),
+            .text = message,
+        });
+    }
+
+    void RunHistory::queue(Entry entry)
+    {
+        if (!isEnabled())
+        {
+            return;
+        }
+
+        m_pendingChars += entry.text.size() + entry.script.size();
+        m_pending.push_back(std::move(entry));
+
+        if (m_pendingChars >= MaxPendingChars)
+        {
+            flush();
+        }
+        else if (!m_flushTimer.isActive())
+        {
+            m_flushTimer.start();
+        }
+    }
+
+    void RunHistory::flush()
+    {
+        m_flushTimer.stop();
+        if (m_pending.empty())
+        {
+            return;
+        }
+
+        m_strand->post([this, writer = m_writer, entries = std::exchange(m_pending, {})]
+        {
+            writer->write(entries);
+            // Dropped if the history is gone by then
+            QMetaObject::invokeMethod(this, &RunHistory::runsChanged, Qt::QueuedConnection);
+        });
+        m_pendingChars = 0;
+    }
+
+    void RunHistory::Writer::write(const std::vector<Entry>& entries)
+    {
+        const Connection connection(path);
+        QSqlDatabase db = connection.database();
+        if (!db.isOpen())
+        {
+            return;
+        }
+        if (fullText < 0)
+        {
+            fullText = hasFullText(db) ? 1 : 0;
+        }
+
+        db.transaction();
+
+        QSqlQuery insertRun(db);
+        insertRun.prepare(INSERT_RUN_SQL);
+        QSqlQuery startRun(db);
+        startRun.prepare(START_RUN_SQL);
+        QSqlQuery finishRun(db);
+        finishRun.prepare(FINISH_RUN_SQL);
+        QSqlQuery truncateRun(db);
+        truncateRun.prepare(TRUNCATE_RUN_SQL);
+        QSqlQuery insertOutput(db);
+        insertOutput.prepare(INSERT_OUTPUT_SQL);
+        QSqlQuery indexOutput(db);
+        if (fullText == 1)
+        {
+            indexOutput.prepare(INDEX_OUTPUT_SQL);
+        }
+
+        for (const Entry& entry : entries)
+        {
+            if (entry.kind == Entry::Kind::Queued)
+            {
+                const QByteArray hash = QCryptographicHash::hash(entry.script.toUtf8(), QCryptographicHash::Sha256);
+                insertRun.addBindValue(entry.title);
+                insertRun.addBindValue(QString::fromLatin1(hash.toHex()));
+                insertRun.addBindValue(entry.script);
+                insertRun.addBindValue(entry.time);
+                insertRun.addBindValue(entry.bridgeId);
+                insertRun.addBindValue(entry.runspace);
+                if (insertRun.exec())
+                {
+                    rows[entry.jobId] = insertRun.lastInsertId().toLongLong();
+                    outputChars[entry.jobId] = 0;
+                }
+                else
+                {
+                    file_utils::file_log("Run history: " + insertRun.lastError().text().toStdString());
+                }
+                continue;
+            }
+
+            // Jobs whose run could not be recorded are left out
+            const auto row = rows.find(entry.jobId);
+            if (row == rows.end())
+            {
+                continue;
+            }
+
+            switch (entry.kind)
+            {
+            case Entry::Kind::Started:
+                startRun.addBindValue(entry.time);
+                startRun.addBindValue(row->second);
+                startRun.exec();
+                break;
+            case Entry::Kind::Output:
+                {
+                    qint64& stored = outputChars[entry.jobId];
+                    if (stored >= MaxOutputChars)
+                    {
+                        break;
+                    }
+
+                    const QString text = entry.text.left(MaxOutputChars - stored);
+                    if (text.size() < entry.text.size())
+                    {
+                        truncateRun.addBindValue(row->second);
+                        truncateRun.exec();
+                    }
+                    stored += text.size();
+
+                    insertOutput.addBindValue(row->second);
+                    insertOutput.addBindValue(entry.code);
+                    insertOutput.addBindValue(text);
+                    if (insertOutput.exec() && fullText == 1)
+                    {
+                        indexOutput.addBindValue(insertOutput.lastInsertId());
+                        indexOutput.addBindValue(text);
+                        indexOutput.exec();
+                    }
+                    break;
+                }
+            case Entry::Kind::Finished:
+                finishRun.addBindValue(entry.time);
+                finishRun.addBindValue(entry.time);
+                finishRun.addBindValue(entry.code);
+                finishRun.addBindValue(entry.text);
+                finishRun.addBindValue(outputChars[entry.jobId]);
+                finishRun.addBindValue(row->second);
+                finishRun.exec();
+
+                // Nothing more comes for the job
+                rows.erase(row);
+                outputChars.erase(entry.jobId);
+                break;
+            case Entry::Kind::Queued:
+                break;
+            }
+        }
+
+        if (!db.commit())
+        {
+            file_utils::file_log("Run history: " + db.lastError().text().toStdString());
+            db.rollback();
+        }
+    }
+
+    QFuture<HistoryPage> RunHistory::runs(const QString& search, const qint64 before, const int limit) const
+    {
+        return TaskPool::instance().run([path = m_path, search, before, limit]
+        {
+            HistoryPage page;
+            if (path.isEmpty())
+            {
+                return page;
+            }
+
+            const Connection connection(path);
+            const QSqlDatabase db = connection.database();
+
+            QString sql = QString("SELECT %1 FROM runs WHERE (? = 0 OR id < ?)").arg(SUMMARY_COLUMNS);
+            const bool fullText = hasFullText(db);
+            if (!search.isEmpty())
+            {
+                sql += fullText
+                           ? " AND (id IN (SELECT run_id FROM run_output WHERE id IN "
+                           "(SELECT rowid FROM run_output_fts WHERE run_output_fts MATCH ?))"
+                           : " AND (id IN (SELECT run_id FROM run_output WHERE text LIKE ? ESCAPE '\\')";
+                sql += " OR title LIKE ? ESCAPE '\\' OR script LIKE ? ESCAPE '\\')";
+            }
+            // One more than asked for tells whether there are more
+            sql += " ORDER BY id DESC LIMIT ?;";
+
+            QSqlQuery query(db);
+            query.prepare(sql);
+            query.addBindValue(before);
+            query.addBindValue(before);
+            if (!search.isEmpty())
+            {
+                query.addBindValue(fullText ? fullTextPhrase(search) : likePattern(search));
+                query.addBindValue(likePattern(search));
+                query.addBindValue(likePattern(search));
+            }
+            query.addBindValue(limit + 1);
+
+            if (!query.exec())
+            {
+                file_utils::file_log("Run history: " + query.lastError().text().toStdString());
+                return page;
+            }
+            while (query.next())
+            {
+                if (page.runs.size() == limit)
+                {
+                    page.hasMore = true;
+                    break;
+                }
+                page.runs.append(readSummary(query));
+            }
+            return page;
+        });
+    }
+
+    QFuture<RunDetails> RunHistory::details(const qint64 runId) const
+    {
+        return TaskPool::instance().run([path = m_path, runId]
+        {
+            if (path.isEmpty())
+            {
+                return RunDetails();
+            }
+
+            const Connection connection(path);
+            return readDetails(connection.database(), runId);
+        });
+    }
+
+    QFuture<RunDetails> RunHistory::previousRun(const qint64 runId) const
+    {
+        return TaskPool::instance().run([path = m_path, runId]
+        {
+            if (path.isEmpty())
+            {
+                return RunDetails();
+            }
+
+            const Connection connection(path);
+            const QSqlDatabase db = connection.database();
+
+            qint64 previousId = 0;
+            {
+                QSqlQuery query(db);
+                query.prepare("SELECT id FROM runs WHERE script_hash = (SELECT script_hash FROM runs WHERE id = ?) "
+                    "AND id < ? ORDER BY id DESC LIMIT 1;");
+                query.addBindValue(runId);
+                query.addBindValue(runId);
+                if (query.exec() && query.next())
+                {
+                    previousId = query.value(0).toLongLong();
+                }
+            }
+            return previousId == 0 ? RunDetails() : readDetails(db, previousId);
+        });
+    }
+}
@@ -0,0 +1,171 @@
+//
+// Created by talik on 10/18/2026.
+//
+
+#ifndef RUN_HISTORY_H
+#define RUN_HISTORY_H
+
+#include <atomic>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+#include <QFuture>
+#include <QList>
+#include <QObject>
+#include <QString>
+#include <QTimer>
+
+#include "clients/PSClient/BridgeProtocol.h"
+
+class TaskStrand;
+
+namespace database
+{
+    // One row of the runs table, without the script
+    struct RunSummary
+    {
+        qint64 id = 0;
+        QString title;
+        QString scriptHash;
+        qint64 queuedAt = 0;
+        // 0 if the run never started or has not finished
+        qint64 startedAt = 0;
+        qint64 finishedAt = 0;
+        qint64 durationMs = 0;
+        // A bridge::RunStatus, -1 while the run has not finished
+        int status = -1;
+        QString bridgeId;
+        QString runspace;
+        bool truncated = false;
+    };
+
+    struct HistoryPage
+    {
+        // Newest first
+        QList<RunSummary> runs;
+        // Older runs match as well
+        bool hasMore = false;
+    };
+
+    struct RunDetails
+    {
+        RunSummary run;
+        QString script;
+        QString output;
+    };
+
+    /**
+     * Every run's script, timing, outcome and output, kept in the runs and
+     * run_output tables of the application database, see db_conn.h.
+     *
+     * The recording calls only queue what they are given. Once per
+     * FlushInterval, or sooner when MaxPendingChars of output piled up, the
+     * queue goes to a TaskStrand that writes it in one transaction, so a
+     * chatty script costs one commit twice a second rather than one per line.
+     *
+     * QSqlDatabase connections cannot move between threads, and strands and
+     * queries run on whichever worker is free, so every task opens a
+     * connection of its own. The database is in WAL mode and readers never
+     * wait for the writer.
+     */
+    class RunHistory final : public QObject
+    {
+        Q_OBJECT
+
+    signals:
+        // After queued recordings reached the database
+        void runsChanged();
+
+    public:
+        // Output kept per run; the rest is dropped and the run marked truncated
+        static constexpr qint64 MaxOutputChars = 4 * 1024 * 1024;
+
+        // Records into the database db_conn() opened; does nothing if none was
+        static RunHistory& instance();
+
+        explicit RunHistory(QString databasePath, QObject* parent = nullptr);
+
+        // Writes what is still queued
+        ~RunHistory() override;
+
+        [[nodiscard]] bool isEnabled() const { return !m_path.isEmpty(); }
+
+        // runspace is "session" for sticky runs and "pool" otherwise
+        void runQueued(quint64 jobId, const QString& title, const QString& script, const QString& bridgeId,
+                       const QString& runspace);
+
+        void runStarted(quint64 jobId);
+
+        void runOutput(quint64 jobId, bridge::OutputStream stream, const QString& text);
+
+        void runFinished(quint64 jobId, bridge::RunStatus status, const QString& message);
+
+        /**
+         * Up to limit runs older than run id before, or the newest ones for 0.
+         * With search, only runs whose output, title or script holds it.
+         */
+        [[nodiscard]] QFuture<HistoryPage> runs(const QString& search, qint64 before, int limit) const;
+
+        [[nodiscard]] QFuture<RunDetails> details(qint64 runId) const;
+
+        // The last run of the same script before runId; its id is 0 if there is none
+        [[nodiscard]] QFuture<RunDetails> previousRun(qint64 runId) const;
+
+    public slots:
+        // Hands the queue to the writer now
+        void flush();
+
+    private:
+        static constexpr int FlushInterval = 500;
+        static constexpr qsizetype MaxPendingChars = 1024 * 1024;
+        // Output is stored in rows of about this size, which keeps the full-text index fine grained
+        static constexpr qsizetype ChunkChars = 64 * 1024;
+
+        struct Entry
+        {
+            enum class Kind
+            {
+                Queued,
+                Started,
+                Output,
+                Finished,
+            };
+
+            Kind kind = Kind::Queued;
+            quint64 jobId = 0;
+            qint64 time = 0;
+            // A bridge::OutputStream for output, a bridge::RunStatus when finished
+            int code = 0;
+            QString title;
+            QString script;
+            QString text;
+            QString bridgeId;
+            QString runspace;
+        };
+
+        // Shared with the writer's tasks, which only ever run one at a time
+        struct Writer
+        {
+            QString path;
+            // Row of each job recorded in this session, and the output stored for it so far
+            std::unordered_map<quint64, qint64> rows;
+            std::unordered_map<quint64, qint64> outputChars;
+            // -1 until known
+            int fullText = -1;
+
+            void write(const std::vector<Entry>& entries);
+        };
+
+        QString m_path;
+        std::vector<Entry> m_pending;
+        qsizetype m_pendingChars = 0;
+        QTimer m_flushTimer;
+
+        std::shared_ptr<Writer> m_writer;
+        std::unique_ptr<TaskStrand> m_strand;
+
+        void queue(Entry entry);
+    };
+}
+
+#endif //RUN_HISTORY_H
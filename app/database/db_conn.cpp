@@ -76,10 +76,25 @@ namespace database
 
     QSqlError init_db()
     {
-        if (QSqlQuery query; !query.exec(FILES_SQL))
+        for (const auto sql : {FILES_SQL, RUNS_SQL, RUNS_BY_HASH_SQL, RUN_OUTPUT_SQL, RUN_OUTPUT_BY_RUN_SQL})
+        {
+            if (QSqlQuery query; !query.exec(sql))
+            {
+                file_utils::file_log("Error executing query: " + query.lastError().text().toStdString());
+                return query.lastError();
+            }
+        }
+
+        // Lets the history writer commit while the window reads
+        if (QSqlQuery query; !query.exec("PRAGMA journal_mode = WAL;"))
         {
             file_utils::file_log("Error executing query: " + query.lastError().text().toStdString());
-            return query.lastError();
+        }
+
+        // Optional, the SQLite build may lack FTS5
+        if (QSqlQuery query; !query.exec(RUN_OUTPUT_FTS_SQL))
+        {
+            file_utils::file_log("Run output is not indexed: " + query.lastError().text().toStdString());
         }
 
         return {};
@@ -44,6 +44,24 @@ namespace database
 
     constexpr auto DELETE_BY_FILE_PATH_SQL ="DELETE FROM files WHERE file_path = ?;";
 
+    // Run history, written and read by RunHistory. Times are milliseconds since the epoch.
+    constexpr auto RUNS_SQL =
+        "CREATE TABLE IF NOT EXISTS runs(id INTEGER PRIMARY KEY, title VARCHAR, script_hash VARCHAR, script TEXT, "
+        "queued_at INTEGER, started_at INTEGER, finished_at INTEGER, duration_ms INTEGER, status INTEGER, message TEXT, "
+        "bridge_id VARCHAR, runspace VARCHAR, output_chars INTEGER DEFAULT 0, output_truncated INTEGER DEFAULT 0);";
+
+    constexpr auto RUNS_BY_HASH_SQL = "CREATE INDEX IF NOT EXISTS runs_by_hash ON runs(script_hash, id);";
+
+    // Output of a run in the chunks it was written in
+    constexpr auto RUN_OUTPUT_SQL =
+        "CREATE TABLE IF NOT EXISTS run_output(id INTEGER PRIMARY KEY, run_id INTEGER NOT NULL, stream INTEGER, text TEXT);";
+
+    constexpr auto RUN_OUTPUT_BY_RUN_SQL = "CREATE INDEX IF NOT EXISTS run_output_by_run ON run_output(run_id, id);";
+
+    // Full-text index over run_output, which keeps the text itself. Searches fall back to LIKE without FTS5.
+    constexpr auto RUN_OUTPUT_FTS_SQL =
+        "CREATE VIRTUAL TABLE IF NOT EXISTS run_output_fts USING fts5(text, content='run_output', content_rowid='id');";
+
     QVariant insertFile(const QString& filePath, const QString& title);
     QVariant deleteRow(const QString& filePath);
     QList<FileObject*> findPreviouslyOpenedFiles();
@@ -0,0 +1,91 @@
+//
+// Created by talik on 10/18/2026.
+//
+
+#include <vector>
+#include <QTest>
+
+#include "PSTokenizer.h"
+
+namespace
+{
+    struct Lexed
+    {
+        QString line;
+        std::vector<pslang::Token> tokens;
+
+        // True if the line has a token of kind covering exactly text
+        [[nodiscard]] bool has(const QString& text, const pslang::TokenKind kind) const
+        {
+            for (const pslang::Token& token : tokens)
+            {
+                if (token.kind == kind && QStringView(line).sliced(token.offset, token.length) == text)
+                {
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        [[nodiscard]] bool hasAny(const pslang::TokenKind kind) const
+        {
+            for (const pslang::Token& token : tokens)
+            {
+                if (token.kind == kind)
+                {
+                    return true;
+                }
+            }
+            return false;
+        }
+    };
+
+    Lexed lex(const QString& line)
+    {
+        Lexed lexed{line, {}};
+        pslang::tokenize(lexed.line, pslang::InitialState, lexed.tokens);
+        return lexed;
+    }
+}
+
+class PSTokenizerTest final : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void splatting()
+    {
+        const Lexed lexed = lex("Get-ChildItem @params -Force");
+        QVERIFY(lexed.has("@params", pslang::TokenKind::Variable));
+        QVERIFY(lexed.has("-Force", pslang::TokenKind::Parameter));
+    }
+
+    void hashtableLiteral()
+    {
+        const Lexed lexed = lex("@{ a = 1 }");
+        QVERIFY(lexed.has("@", pslang::TokenKind::Operator));
+        QVERIFY(lexed.has("1", pslang::TokenKind::Number));
+        QVERIFY(!lexed.hasAny(pslang::TokenKind::Variable));
+    }
+
+    void hashtableContents()
+    {
+        const Lexed lexed = lex("$h = @{ Name = 'x'; Id = $id }");
+        QVERIFY(lexed.has("$h", pslang::TokenKind::Variable));
+        QVERIFY(lexed.has("'x'", pslang::TokenKind::String));
+        QVERIFY(lexed.has("$id", pslang::TokenKind::Variable));
+        QVERIFY(!lexed.has("@{ Name = 'x'; Id = $id }", pslang::TokenKind::Variable));
+    }
+
+    void arraySubexpression()
+    {
+        const Lexed lexed = lex("$all = @(Get-ChildItem $path)");
+        QVERIFY(lexed.has("@", pslang::TokenKind::Operator));
+        QVERIFY(lexed.has("Get-ChildItem", pslang::TokenKind::Command));
+        QVERIFY(lexed.has("$path", pslang::TokenKind::Variable));
+    }
+};
+
+QTEST_APPLESS_MAIN(PSTokenizerTest)
+
+#include "PSTokenizerTest.moc"
@@ -41,7 +41,9 @@
 #include "buraq.h"
 #include "Config.h"
 #include "PluginManager.h"
+#include "TaskPool.h"
 #include "Utils.h"
+#include "clients/PSClient/BridgeTransport.h"
 #include "clients/VersionClient/VersionRepository.h"
 #include "database/db_conn.h"
 #include "dialog/VersionUpdateDialog.h"
@@ -138,6 +140,9 @@ void AppUi::initPSLangSupport()
 
     emit updateStatusBar("PSLang Support..", 5000);
 
+    // The bridge inherits the endpoint and token of this session through the environment
+    BridgeEndpoint::session();
+
     m_bridgeProcess = new ManagedProcess(psLangSupportPath);
 
     if (!m_bridgeProcess->isRunning())
@@ -151,9 +156,16 @@ void AppUi::initPSLangSupport()
 
 void AppUi::verifyApplicationVersion()
 {
-    VersionRepository repo(api_context.get());
+    const auto repo = std::make_shared<VersionRepository>(api_context.get());
+
+    // The manifest is downloaded on the task pool, the answer is handled on the GUI thread
+    const QFuture<UpdateInfo> check = TaskPool::instance().run([repo] { return repo->main_version_logic(); });
+    check.then(this, [this, repo](const UpdateInfo& update_info) { onVersionChecked(repo, update_info); });
+}
 
-    if (const UpdateInfo update_info = repo.main_version_logic(); update_info.isConnFailure == false)
+void AppUi::onVersionChecked(const std::shared_ptr<VersionRepository>& repo, const UpdateInfo& update_info)
+{
+    if (update_info.isConnFailure == false)
     {
         if (update_info.latestVersion.empty())
         {
@@ -169,38 +181,43 @@ void AppUi::verifyApplicationVersion()
 
         if (versionUpdater.exec() == QDialog::Accepted)
         {
-            const std::filesystem::path installerExe = repo.downloadNewVersion();
-
-            qDebug() << "AppUi.cpp";
-            qDebug() << installerExe.string();
-            qDebug() << (api_context->searchPath / "updater.exe").string();
-            qDebug() << api_context->searchPath.parent_path().string();
-            qDebug() << "ENDs AppUi.cpp";
-            // Get the path to the AppData\Local folder
-            PWSTR pszPath = NULL;
-            if (const HRESULT hr = SHGetKnownFolderPath(FOLDERID_LocalAppData, 0, NULL, &pszPath); SUCCEEDED(hr))
-            {
-                // Convert the wide character string to a narrow character string (std::string)
-                std::wstring wsPath(pszPath);
-                std::string sPath(wsPath.begin(), wsPath.end());
-
-                sPath += "\\Programs\\Buraq";
-
-                // Print the resulting path
-                std::cout << "The path is: " << sPath << std::endl;
-
-                launchUpdaterAndExit(
-                    api_context->searchPath / "updater.exe", installerExe, sPath
-                );
+            emit updateStatusBar("Downloading the new version..", 0);
 
-                // Free the memory allocated by SHGetKnownFolderPath
-                CoTaskMemFree(pszPath);
-            }
-            else
+            const QFuture<std::filesystem::path> download =
+                TaskPool::instance().run([repo] { return repo->downloadNewVersion(); });
+            download.then(this, [this](const std::filesystem::path& installerExe)
             {
-                std::cerr << "Failed to get the path." << std::endl;
-            }
-            emit updateStatusBar("Ready.", 2000);
+                qDebug() << "AppUi.cpp";
+                qDebug() << installerExe.string();
+                qDebug() << (api_context->searchPath / "updater.exe").string();
+                qDebug() << api_context->searchPath.parent_path().string();
+                qDebug() << "ENDs AppUi.cpp";
+                // Get the path to the AppData\Local folder
+                PWSTR pszPath = NULL;
+                if (const HRESULT hr = SHGetKnownFolderPath(FOLDERID_LocalAppData, 0, NULL, &pszPath); SUCCEEDED(hr))
+                {
+                    // Convert the wide character string to a narrow character string (std::string)
+                    std::wstring wsPath(pszPath);
+                    std::string sPath(wsPath.begin(), wsPath.end());
+
+                    sPath += "\\Programs\\Buraq";
+
+                    // Print the resulting path
+                    std::cout << "The path is: " << sPath << std::endl;
+
+                    launchUpdaterAndExit(
+                        api_context->searchPath / "updater.exe", installerExe, sPath
+                    );
+
+                    // Free the memory allocated by SHGetKnownFolderPath
+                    CoTaskMemFree(pszPath);
+                }
+                else
+                {
+                    std::cerr << "Failed to get the path." << std::endl;
+                }
+                emit updateStatusBar("Ready.", 2000);
+            });
         }
         else
         {
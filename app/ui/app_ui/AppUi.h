@@ -5,6 +5,7 @@
 #define APP_UI_H
 
 #include <filesystem>
+#include <memory>
 #include <QObject>
 
 namespace buraq
@@ -12,14 +13,14 @@ namespace buraq
     struct buraq_api;
 }
 
-class Minion;
 class QMainWindow;
 class QMouseEvent;
-class QThread;
 class EditorMargin;
 class ManagedProcess;
 class FramelessWindow;
 class PluginManager;
+class VersionRepository;
+struct UpdateInfo;
 class ToolBar;
 
 class AppUi final : public QObject
@@ -50,11 +51,9 @@ private:
     // For running background services
     ManagedProcess* m_bridgeProcess{};
 
-    QThread *m_workerThread{};
-    Minion *m_minion{};
-
     void initPSLangSupport();
     void verifyApplicationVersion();
+    void onVersionChecked(const std::shared_ptr<VersionRepository>& repo, const UpdateInfo& update_info);
     void initAppLayout();
     void initAppContext();
     static void launchUpdaterAndExit(
@@ -0,0 +1,255 @@
+//
+// Created by talik on 10/18/2026.
+//
+
+#include "AutoSaveScheduler.h"
+
+#include <QFile>
+#include <QSaveFile>
+#include <QStringEncoder>
+#include "TaskPool.h"
+
+void AutoSaveWriter::write(const quint64 revision, const QString& filePath, const QString& text,
+                           const FileFormat& format)
+{
+    const QString error = writeFile(filePath, text, format);
+
+    // The file now holds every journaled edit, start over from it
+    if (error.isEmpty() && !m_journalPath.isEmpty() && filePath == m_filePath)
+    {
+        QFile::remove(m_journalPath);
+        m_journalBase = EditJournal::Base::of(filePath);
+    }
+
+    emit written(revision, error);
+}
+
+void AutoSaveWriter::openJournal(const QString& filePath, const bool keepJournal)
+{
+    m_filePath = filePath;
+    m_journalPath = filePath.isEmpty() ? QString() : EditJournal::pathFor(filePath);
+
+    if (!m_journalPath.isEmpty())
+    {
+        // Anything left in it did not match the file. Replayed edits stay in it
+        // until a write puts them into the file.
+        if (!keepJournal)
+        {
+            QFile::remove(m_journalPath);
+        }
+        m_journalBase = EditJournal::Base::of(filePath);
+    }
+}
+
+void AutoSaveWriter::appendJournal(const QByteArray& batch)
+{
+    if (m_journalPath.isEmpty())
+    {
+        return;
+    }
+
+    if (const QString error = EditJournal::append(m_journalPath, m_journalBase, batch); !error.isEmpty())
+    {
+        emit journalFailed(error);
+    }
+}
+
+QString AutoSaveWriter::writeFile(const QString& filePath, const QString& text, const FileFormat& format)
+{
+    // Line endings are converted here rather than with QIODevice::Text, which would corrupt UTF-16
+    QStringEncoder encoder(format.encoding,
+                           format.hasBom ? QStringConverter::Flag::WriteBom : QStringConverter::Flag::Default);
+    const QByteArray bytes = format.crlf ? encoder.encode(QString(text).replace(u'\n', u"\r\n")) : encoder.encode(text);
+
+    QSaveFile file(filePath);
+    if (!file.open(QIODevice::WriteOnly))
+    {
+        return file.errorString();
+    }
+
+    if (file.write(bytes) != bytes.size())
+    {
+        const QString error = file.errorString();
+        file.cancelWriting();
+        return error;
+    }
+
+    // Renames the temporary file over the original
+    if (!file.commit())
+    {
+        return file.errorString();
+    }
+
+    return {};
+}
+
+AutoSaveScheduler::AutoSaveScheduler(Snapshot snapshot, QObject* parent)
+    : QObject(parent), m_snapshot(std::move(snapshot)), m_strand(std::make_unique<TaskStrand>()), m_writer(new AutoSaveWriter())
+{
+    m_idleTimer.setSingleShot(true);
+    m_idleTimer.setInterval(IdleInterval);
+    connect(&m_idleTimer, &QTimer::timeout, this, &AutoSaveScheduler::onIdle);
+
+    m_compactTimer.setSingleShot(true);
+    m_compactTimer.setInterval(CompactInterval);
+    connect(&m_compactTimer, &QTimer::timeout, this, &AutoSaveScheduler::onCompact);
+
+    connect(m_writer, &AutoSaveWriter::written, this, &AutoSaveScheduler::onWritten);
+    connect(m_writer, &AutoSaveWriter::journalFailed, this, &AutoSaveScheduler::saveFailed);
+}
+
+AutoSaveScheduler::~AutoSaveScheduler()
+{
+    m_idleTimer.stop();
+    m_compactTimer.stop();
+
+    // The journal holds every edit, and is synced, before the final write is tried: it is what is
+    // left should that write fail
+    flushJournal();
+
+    // Let queued writes finish first so they cannot overwrite the final save
+    m_strand->wait();
+    delete m_writer;
+
+    if (m_dirty && !m_filePath.isEmpty())
+    {
+        if (AutoSaveWriter::writeFile(m_filePath, m_snapshot(), m_format).isEmpty() && m_journaling)
+        {
+            QFile::remove(EditJournal::pathFor(m_filePath));
+        }
+    }
+}
+
+void AutoSaveScheduler::setFilePath(const QString& filePath, const FileFormat& format, const bool keepJournal)
+{
+    flush();
+    m_filePath = filePath;
+    m_format = format;
+    m_dirty = false;
+
+    m_journaling = m_journalEnabled && !filePath.isEmpty();
+    m_journal.takePending();
+    m_strand->post([writer = m_writer, filePath = m_journaling ? filePath : QString(), keepJournal]
+    {
+        writer->openJournal(filePath, keepJournal);
+    });
+}
+
+void AutoSaveScheduler::schedule(const quint64 revision)
+{
+    m_pendingRevision = revision;
+    m_dirty = true;
+
+    if (m_journaling)
+    {
+        // The journal batches are driven by record()
+        m_compactTimer.start();
+        return;
+    }
+
+    m_idleTimer.start();
+}
+
+void AutoSaveScheduler::record(const quint64 revision, const int position, const int removed, const QString& text)
+{
+    if (!m_journaling)
+    {
+        return;
+    }
+
+    m_journal.record(position, removed, text);
+    // Edits made without the keyboard never go through schedule()
+    m_pendingRevision = revision;
+    m_dirty = true;
+    m_compactTimer.start();
+
+    if (m_journal.pendingSize() >= MaxJournalBatch)
+    {
+        flushJournal();
+    }
+    else if (!m_idleTimer.isActive())
+    {
+        // Unlike schedule(), not restarted on every edit, so batches are synced at least once per interval
+        m_idleTimer.start();
+    }
+}
+
+void AutoSaveScheduler::onIdle()
+{
+    if (m_journaling)
+    {
+        flushJournal();
+        return;
+    }
+
+    // Coalesce with the edits made while the previous write was running
+    if (m_inFlight > 0)
+    {
+        m_deferred = true;
+        return;
+    }
+
+    flush();
+}
+
+void AutoSaveScheduler::onCompact()
+{
+    if (m_inFlight > 0)
+    {
+        m_deferred = true;
+        return;
+    }
+
+    flush();
+}
+
+void AutoSaveScheduler::flushJournal()
+{
+    if (m_journal.hasPending())
+    {
+        m_strand->post([writer = m_writer, batch = m_journal.takePending()] { writer->appendJournal(batch); });
+    }
+}
+
+void AutoSaveScheduler::flush()
+{
+    m_idleTimer.stop();
+    m_compactTimer.stop();
+    if (!m_dirty || m_filePath.isEmpty())
+    {
+        return;
+    }
+
+    // Keeps the journal complete in case the full write fails
+    flushJournal();
+
+    m_dirty = false;
+    ++m_inFlight;
+
+    // The writer handles requests in order, so queueing behind a running write is safe
+    m_strand->post([writer = m_writer, revision = m_pendingRevision, filePath = m_filePath, text = m_snapshot(),
+            format = m_format]
+    {
+        writer->write(revision, filePath, text, format);
+    });
+}
+
+void AutoSaveScheduler::onWritten(const quint64 revision, const QString& error)
+{
+    --m_inFlight;
+
+    if (error.isEmpty())
+    {
+        emit saved(revision);
+    }
+    else
+    {
+        emit saveFailed(error);
+    }
+
+    if (m_deferred && m_inFlight == 0)
+    {
+        m_deferred = false;
+        flush();
+    }
+}
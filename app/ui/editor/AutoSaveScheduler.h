@@ -0,0 +1,146 @@
+//
+// Created by talik on 10/18/2026.
+//
+
+#ifndef AUTO_SAVE_SCHEDULER_H
+#define AUTO_SAVE_SCHEDULER_H
+
+#include <functional>
+#include <memory>
+#include <QObject>
+#include <QString>
+#include <QTimer>
+
+#include "EditJournal.h"
+#include "FileFormat.h"
+
+class TaskStrand;
+
+// Writes files on the task pool, one request at a time and in order.
+class AutoSaveWriter final : public QObject
+{
+    Q_OBJECT
+
+signals:
+    void written(quint64 revision, const QString& error);
+
+    void journalFailed(const QString& error);
+
+public slots:
+    void write(quint64 revision, const QString& filePath, const QString& text, const FileFormat& format);
+
+    // Starts journaling the edits of filePath, an empty path stops journaling. The journal left
+    // on disk is kept if keepJournal, and new edits are appended to it.
+    void openJournal(const QString& filePath, bool keepJournal);
+
+    void appendJournal(const QByteArray& batch);
+
+public:
+    explicit AutoSaveWriter(QObject* parent = nullptr) : QObject(parent) {}
+
+    /**
+     * Writes text to a temporary file next to filePath and renames it over
+     * filePath, so a crash or a full disk never leaves a half written file.
+     * @return An error message, empty on success.
+     */
+    static QString writeFile(const QString& filePath, const QString& text, const FileFormat& format);
+
+private:
+    QString m_filePath;
+    QString m_journalPath;
+    // The file on disk that the current journal applies to
+    EditJournal::Base m_journalBase;
+};
+
+/**
+ * Debounces auto saves and runs them off the GUI thread.
+ *
+ * Every schedule() restarts an idle timer; a burst of edits results in a single
+ * write once the user pauses. The document is only copied when the write
+ * actually starts.
+ *
+ * With the journal enabled, the idle timer only appends the recorded edits to
+ * the file's EditJournal, so saving costs as much as the edits rather than the
+ * whole file. The journal is compacted into the file after a longer pause, when
+ * switching files and on close.
+ */
+class AutoSaveScheduler final : public QObject
+{
+    Q_OBJECT
+
+signals:
+    void saved(quint64 revision);
+
+    void saveFailed(const QString& error);
+
+public:
+    // Returns the text to save, called on the GUI thread
+    using Snapshot = std::function<QString()>;
+
+    explicit AutoSaveScheduler(Snapshot snapshot, QObject* parent = nullptr);
+
+    // Waits for running writes and saves what is still pending
+    ~AutoSaveScheduler() override;
+
+    // Takes effect with the next setFilePath()
+    void setJournalEnabled(bool enabled) { m_journalEnabled = enabled; }
+
+    [[nodiscard]] bool isJournalEnabled() const { return m_journalEnabled; }
+
+    // True if record() keeps the edits of the current file
+    [[nodiscard]] bool isJournaling() const { return m_journaling; }
+
+    // Saves what is pending for the current file before switching to filePath. keepJournal
+    // leaves the journal of filePath in place, for edits replayed from it that the file lacks
+    // until the next compaction succeeds.
+    void setFilePath(const QString& filePath, const FileFormat& format = {}, bool keepJournal = false);
+
+    // The document changed, revision identifies its new content
+    void schedule(quint64 revision);
+
+    // Journals a change of the document, in QTextDocument::contentsChange terms; revision identifies
+    // the new content, as in schedule()
+    void record(quint64 revision, int position, int removed, const QString& text);
+
+    // Starts writing whatever is pending right away
+    void flush();
+
+private slots:
+    void onWritten(quint64 revision, const QString& error);
+
+private:
+    static constexpr int IdleInterval = 1000;
+    // Pause after which the journal is written into the file itself
+    static constexpr int CompactInterval = 30000;
+    // Journal batches are written early once they get this big
+    static constexpr qsizetype MaxJournalBatch = 64 * 1024;
+
+    Snapshot m_snapshot;
+    QString m_filePath;
+    FileFormat m_format;
+    QTimer m_idleTimer;
+    QTimer m_compactTimer;
+
+    bool m_journalEnabled = false;
+    bool m_journaling = false;
+    EditJournal m_journal;
+
+    quint64 m_pendingRevision = 0;
+    bool m_dirty = false;
+    // Writes posted to m_strand that have not reported back
+    int m_inFlight = 0;
+    // The idle timer fired while a write was running
+    bool m_deferred = false;
+
+    // Writes in order on the task pool
+    std::unique_ptr<TaskStrand> m_strand;
+    AutoSaveWriter* m_writer;
+
+    void onIdle();
+
+    void onCompact();
+
+    void flushJournal();
+};
+
+#endif //AUTO_SAVE_SCHEDULER_H
@@ -0,0 +1,69 @@
+//
+// Created by talik on 10/18/2026.
+//
+
+#include "BackgroundLexer.h"
+
+#include <algorithm>
+#include <vector>
+
+#include "PSTokenizer.h"
+
+namespace
+{
+    bool isLineBreak(const QChar c)
+    {
+        return c == u'\n' || c == u'\r' || c == QChar::ParagraphSeparator;
+    }
+}
+
+BackgroundLexer::BackgroundLexer(QObject* parent) : QObject(parent)
+{
+}
+
+void BackgroundLexer::setLatestRevision(const quint64 revision)
+{
+    m_latestRevision.store(revision, std::memory_order_relaxed);
+}
+
+void BackgroundLexer::lex(const quint64 revision, const QString& text)
+{
+    std::vector<pslang::Token> tokens;
+    pslang::LexState state = pslang::InitialState;
+    QList<int> states;
+    int firstBlock = 0;
+
+    const QStringView all(text);
+    qsizetype start = 0;
+    bool last = false;
+    while (!last)
+    {
+        // Up to the first line break past ChunkChars, with \r\n kept in one piece
+        qsizetype end = std::min(start + ChunkChars, all.size());
+        while (end < all.size() && !isLineBreak(all[end]))
+        {
+            ++end;
+        }
+        if (end < all.size())
+        {
+            end += all[end] == u'\r' && end + 1 < all.size() && all[end + 1] == u'\n' ? 2 : 1;
+        }
+        // The text after the last line break is the last block, even when empty
+        last = end == all.size();
+
+        state = pslang::tokenizeLines(all.sliced(start, end - start), state, last, tokens, states);
+        start = end;
+
+        // The document was edited since the snapshot was taken, the rest is of no use.
+        if (m_latestRevision.load(std::memory_order_relaxed) != revision)
+        {
+            return;
+        }
+
+        emit chunkReady(revision, firstBlock, states);
+        firstBlock += static_cast<int>(states.size());
+        states.clear();
+    }
+
+    emit finished(revision);
+}
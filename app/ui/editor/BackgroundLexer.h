@@ -0,0 +1,52 @@
+//
+// Created by talik on 10/18/2026.
+//
+
+#ifndef BACKGROUND_LEXER_H
+#define BACKGROUND_LEXER_H
+
+#include <atomic>
+#include <QObject>
+#include <QList>
+#include <QString>
+
+/**
+ * Lexes a snapshot of a whole document on a worker thread.
+ *
+ * Only the carry-over state at the end of every line is reported back, in
+ * chunks of consecutive block numbers. The GUI thread stores those states in
+ * the blocks so that highlighting any visible block can start right away.
+ */
+class BackgroundLexer final : public QObject
+{
+    Q_OBJECT
+
+signals:
+    // states[i] is the lexer state at the end of block (firstBlock + i)
+    void chunkReady(quint64 revision, int firstBlock, const QList<int>& states);
+
+    // Emitted once the whole snapshot for this revision was lexed
+    void finished(quint64 revision);
+
+public slots:
+    void lex(quint64 revision, const QString& text);
+
+public:
+    explicit BackgroundLexer(QObject* parent = nullptr);
+
+    ~BackgroundLexer() override = default;
+
+    /**
+     * Marks every job older than revision as stale. Thread safe.
+     * A stale job stops at its next chunk boundary.
+     */
+    void setLatestRevision(quint64 revision);
+
+private:
+    // Text lexed between two chunks reported back, rounded up to the end of a line
+    static constexpr qsizetype ChunkChars = 256 * 1024;
+
+    std::atomic<quint64> m_latestRevision{0};
+};
+
+#endif //BACKGROUND_LEXER_H
@@ -2,18 +2,24 @@
 // Created by talik on 5/28/2025.
 //
 
+#include <QAction>
+#include <QFileDialog>
+#include <QFileInfo>
 #include <QIcon>
 #include "CodeRunner.h"
-#include <QThread>
 #include "CustomLabel.h"
 #include "Editor.h"
 #include "IconButton.h"
 #include "app_ui/AppUi.h"
+#include "database/RunHistory.h"
 #include "frameless_window/FramelessWindow.h"
+#include "settings/SettingManager/SettingsManager.h"
 
 CodeRunner::CodeRunner(QWidget* parent)
-    : QPushButton("{ }", parent), m_window(parent), m_workerThread(nullptr),
-      m_minion(nullptr)
+    : QPushButton("{ }", parent), m_window(parent), m_psClient(new PSClient(this)),
+      m_scheduler(new RunScheduler(m_psClient, this)),
+      m_cancelAction(new QAction("Cancel running scripts", this)),
+      m_runFilesAction(new QAction("Run files...", this))
 {
     setObjectName("CodeRunner");
 
@@ -21,45 +27,32 @@ CodeRunner::CodeRunner(QWidget* parent)
     setToolTip(
         "Run code."
         " & "
-        "Highlighted code.");
-
-    CodeRunner::setupSignals();
-}
-
-// Call this once in your CodeRunner's constructor.
-void CodeRunner::setupWorker()
-{
-    // --- 1. Create and Connect Objects ---
-    m_psClient = new PSClient(this);
-    m_workerThread = new QThread(this);
-    m_minion = new Minion();
-    m_minion->moveToThread(m_workerThread);
-
-    // --- 2. Connect Signals and Slots ---
-
-    // Minion (worker thread) asks psClient (main thread) to execute a script.
-    connect(m_minion, &Minion::runScriptRequested, m_psClient, &PSClient::runScript);
-
-    // psClient (main thread) sends result back to CodeRunner (main thread).
-    connect(m_psClient, &PSClient::scriptResultReceived, this, &CodeRunner::handleTaskResults);
+        "Highlighted code."
+        " Ctrl+Break cancels.");
+
+    // Available from the button's context menu and anywhere in the window
+    m_cancelAction->setShortcut(QKeySequence(Qt::CTRL | Qt::Key_Cancel));
+    m_cancelAction->setShortcutContext(Qt::WindowShortcut);
+    m_cancelAction->setEnabled(false);
+    setContextMenuPolicy(Qt::ActionsContextMenu);
+    addAction(m_runFilesAction);
+    addAction(m_cancelAction);
+    if (m_window)
+    {
+        m_window->addAction(m_cancelAction);
+    }
 
-    // Clean up the thread and worker when the thread's event loop finishes.
-    connect(m_workerThread, &QThread::finished, m_minion, &QObject::deleteLater);
-    connect(m_workerThread, &QThread::finished, m_workerThread, &QObject::deleteLater);
+    // The bridge warms its runspaces with these as soon as the connection is up
+    const UserSettings settings = SettingsManager::loadSettings();
+    m_psClient->configure(settings.runspacePoolSize, settings.preloadModules);
+    m_scheduler->setMaxConcurrent(settings.runspacePoolSize);
 
-    m_workerThread->start();
+    CodeRunner::setupSignals();
 }
 
-
-// This function is now much simpler. It just gets the script and signals the worker.
+// This function is now much simpler. It just gets the script and hands it to the scheduler.
 void CodeRunner::runCode()
 {
-    if (!m_workerThread || !m_workerThread->isRunning())
-    {
-        // If the thread isn't running, set it up.
-        setupWorker();
-    }
-
     // --- Get the script text from the UI in the main thread ---
     const auto window_ = dynamic_cast<FramelessWindow*>(m_window);
     if (window_ == nullptr || !window_->getEditor())
@@ -67,10 +60,17 @@ void CodeRunner::runCode()
         return; // Safety check
     }
 
-    QString script = window_->getEditor()->selectedText();
+    const Editor* editor = window_->getEditor();
+    const QString fileName = editor->currentFile().isEmpty()
+                                 ? QString("Untitled")
+                                 : QFileInfo(editor->currentFile()).fileName();
+
+    QString script = editor->selectedText();
+    QString title = "Selection of " + fileName;
     if (script.isEmpty())
     {
-        script = window_->getEditor()->toPlainText();
+        script = editor->toPlainText();
+        title = fileName;
     }
 
     if (script.isEmpty())
@@ -78,49 +78,117 @@ void CodeRunner::runCode()
         return; // Nothing to run
     }
 
-    const auto cleanedScript = script.replace("\u2029", "\n");
+    submit(title, script.replace("\u2029", "\n"));
+}
 
-    emit statusUpdate("Running code..");
+void CodeRunner::runFiles()
+{
+    const QStringList files = QFileDialog::getOpenFileNames(m_window, "Run files", QString(),
+                                                            "PowerShell scripts (*.ps1);;All files (*)");
+    for (const QString& file : files)
+    {
+        // The bridge runs the file itself, so $PSScriptRoot and relative paths behave as in a shell
+        QString path = file;
+        submit(QFileInfo(file).fileName(), "& '" + path.replace("'", "''") + "'");
+    }
+}
 
-    // --- Safely trigger the task on the worker thread via a signal ---
-    // The Minion's process slot should be connected to this signal.
-    // We assume Minion has a signal like `startProcessing(QString)`.
-    QMetaObject::invokeMethod(m_minion, "processScript", Qt::QueuedConnection, Q_ARG(QString, cleanedScript));
+void CodeRunner::submit(const QString& title, const QString& script)
+{
+    // Picks up changes made in the settings since the last run
+    const UserSettings settings = SettingsManager::loadSettings();
+    m_psClient->configure(settings.runspacePoolSize, settings.preloadModules);
+
+    // One job per runspace, more would only wait inside the bridge
+    m_scheduler->setMaxConcurrent(settings.runspacePoolSize);
+
+    // Does not block, the job starts once a slot is free and the bridge connection is up
+    const quint64 jobId = m_scheduler->submit(title, script, settings.stickySession, settings.scriptTimeoutSeconds);
+    database::RunHistory::instance().runQueued(jobId, title, script, BridgeEndpoint::session().name,
+                                               settings.stickySession ? "session" : "pool");
+    emit runStarted(jobId, title);
 }
 
-void CodeRunner::handleTaskResults(const QVariant& result)
+void CodeRunner::handleJobState(const quint64 jobId, const RunScheduler::JobState state)
 {
-    // if (result.isValid() && result.canConvert<QString>())
-    if (const auto flag = result.canConvert<QString>(); flag && result.isValid())
+    switch (state)
+    {
+    case RunScheduler::JobState::Queued:
+        emit runStateChanged(jobId, "Queued");
+        break;
+    case RunScheduler::JobState::Running:
+        database::RunHistory::instance().runStarted(jobId);
+        emit runStateChanged(jobId, "Running");
+        break;
+    case RunScheduler::JobState::Succeeded:
+        emit runStateChanged(jobId, "Completed");
+        break;
+    case RunScheduler::JobState::Failed:
+        emit runStateChanged(jobId, "Failed");
+        break;
+    case RunScheduler::JobState::Cancelled:
+        emit runStateChanged(jobId, "Cancelled");
+        break;
+    }
+
+    const int running = m_scheduler->runningCount();
+    const int queued = m_scheduler->queuedCount();
+    m_cancelAction->setEnabled(running + queued > 0);
+
+    if (running + queued == 0)
     {
-        const auto resultString = result.value<QString>();
-        QString error = "";
-        int statusCode = 0;
-        if (!resultString.isEmpty() && resultString.contains("exception", Qt::CaseInsensitive))
-        {
-            error = resultString;
-            // resultString.clear();
-            statusCode = 1;
-        }
-        emit updateOutputResult(statusCode, resultString, error);
+        return;
     }
-    else
+
+    emit statusUpdate(queued > 0
+                          ? QString("Running code.. (%1 running, %2 queued)").arg(running).arg(queued)
+                          : running > 1
+                          ? QString("Running code.. (%1 scripts)").arg(running)
+                          : QString("Running code.."));
+}
+
+void CodeRunner::handleJobFinished(const quint64 jobId, const RunScheduler::JobState state, const QString& message)
+{
+    // The output was shown while it streamed in
+    switch (state)
     {
-        emit updateOutputResult(1, "", "Error failed to execute task.");
+    case RunScheduler::JobState::Cancelled:
+        database::RunHistory::instance().runFinished(jobId, bridge::RunStatus::Cancelled, message);
+        emit updateOutputResult(jobId, static_cast<int>(bridge::RunStatus::Cancelled), "", message);
+        break;
+    case RunScheduler::JobState::Succeeded:
+        database::RunHistory::instance().runFinished(jobId, bridge::RunStatus::Succeeded, message);
+        emit updateOutputResult(jobId, static_cast<int>(bridge::RunStatus::Succeeded), "", "");
+        break;
+    default:
+        database::RunHistory::instance().runFinished(jobId, bridge::RunStatus::Failed, message);
+        emit updateOutputResult(jobId, static_cast<int>(bridge::RunStatus::Failed), "", message);
+        break;
     }
 }
 
-void CodeRunner::handleProgress(int i)
+void CodeRunner::cancelAll()
 {
-    emit statusUpdate("Executing...");
+    emit statusUpdate("Cancelling..");
+    m_scheduler->cancelAll();
 }
 
-void CodeRunner::handleWorkerFinished()
+void CodeRunner::cancelRun(const quint64 runId)
 {
-    emit statusUpdate("Completed!");
+    emit statusUpdate("Cancelling..");
+    m_scheduler->cancel(runId);
+}
+
+void CodeRunner::handleProgress(const quint64 jobId, const int percent, const QString& activity)
+{
+    QString status = percent >= 0 ? QString("%1 (%2%)").arg(activity).arg(percent) : activity;
 
-    m_workerThread = nullptr;
-    m_minion = nullptr;
+    // Several scripts may run at once, the status bar names the one reporting
+    if (const QString title = m_scheduler->title(jobId); !title.isEmpty())
+    {
+        status = title + ": " + status;
+    }
+    emit statusUpdate(status);
 }
 
 CodeRunner::~CodeRunner()
@@ -128,24 +196,23 @@ CodeRunner::~CodeRunner()
     // smart pointers are deleted automatically
     // editor pointer should be deleted elsewhere
     m_window = nullptr;
-
-    if (m_workerThread && m_workerThread->isRunning())
-    {
-        m_workerThread->requestInterruption();
-        m_workerThread->quit(); // Ask event loop to quit
-        if (!m_workerThread->wait(5000))
-        {
-            // Wait for max 5 seconds
-            m_workerThread->terminate(); // Force terminate (last resort)
-            m_workerThread->wait(); // Wait for termination
-        }
-    }
 }
 
 void CodeRunner::setupSignals()
 {
     // Signal to execute the code
     connect(this, &IconButton::clicked, this, &CodeRunner::runCode);
+    connect(m_runFilesAction, &QAction::triggered, this, &CodeRunner::runFiles);
+    connect(m_cancelAction, &QAction::triggered, this, &CodeRunner::cancelAll);
+
+    // Jobs report by the id submit() returned
+    connect(m_scheduler, &RunScheduler::jobStateChanged, this, &CodeRunner::handleJobState);
+    connect(m_scheduler, &RunScheduler::jobOutput, this, &CodeRunner::outputReceived);
+    connect(m_scheduler, &RunScheduler::jobRecords, this, &CodeRunner::recordsReceived);
+    connect(m_scheduler, &RunScheduler::jobOutput, &database::RunHistory::instance(),
+            &database::RunHistory::runOutput);
+    connect(m_scheduler, &RunScheduler::jobProgress, this, &CodeRunner::handleProgress);
+    connect(m_scheduler, &RunScheduler::jobFinished, this, &CodeRunner::handleJobFinished);
 
     const auto window = dynamic_cast<FramelessWindow*>(m_window);
     // Signal to update status bar in AppUI component for the running process
@@ -153,4 +220,13 @@ void CodeRunner::setupSignals()
 
     // Signal to update the out component in AppUI component for the completed process
     connect(this, &CodeRunner::updateOutputResult, window, &FramelessWindow::processResultSlot);
+
+    // Output is shown while the script is still running, in a tab per run
+    connect(this, &CodeRunner::runStarted, window, &FramelessWindow::processRunStartedSlot);
+    connect(this, &CodeRunner::runStateChanged, window, &FramelessWindow::processRunStateSlot);
+    connect(this, &CodeRunner::outputReceived, window, &FramelessWindow::processOutputSlot);
+    connect(this, &CodeRunner::recordsReceived, window, &FramelessWindow::processRecordsSlot);
+
+    // Runs picked in the history start over with the settings of the moment
+    connect(window, &FramelessWindow::rerunRequested, this, &CodeRunner::submit);
 }
@@ -7,8 +7,8 @@
 
 #include <QPushButton>
 #include "IconButton.h"
-#include "Minion.h"
 #include "../clients/PSClient/PSClient.h"
+#include "RunScheduler.h"
 
 class PSClient;
 
@@ -18,17 +18,31 @@ Q_OBJECT
 
 private slots:
 
-	void handleProgress(int);
+	void handleProgress(quint64 jobId, int percent, const QString &activity);
 
-	void handleTaskResults(const QVariant &result); // Modified to take QVariant
+	void handleJobState(quint64 jobId, RunScheduler::JobState state);
+
+	void handleJobFinished(quint64 jobId, RunScheduler::JobState state, const QString &message);
 
 	void runCode();
 
-	void handleWorkerFinished();
+	// Runs every file picked, side by side as far as the scheduler allows
+	void runFiles();
+
+public slots:
+	// Stops every script started here that is still running or waiting to run
+	void cancelAll();
+
+	void cancelRun(quint64 runId);
 
 signals:
 	void statusUpdate(QString status, int timeout = 10000);
-	void updateOutputResult(int exitCode, const QString &output, const QString &error);
+	// exitCode is a bridge::RunStatus
+	void updateOutputResult(quint64 runId, int exitCode, const QString &output, const QString &error);
+	void runStarted(quint64 runId, const QString &title);
+	void runStateChanged(quint64 runId, const QString &state);
+	void outputReceived(quint64 runId, bridge::OutputStream stream, const QString &text);
+	void recordsReceived(quint64 runId, const bridge::RecordBatch &batch);
 
 public:
 	explicit CodeRunner(QWidget *parent = nullptr);
@@ -41,11 +55,16 @@ private:
 
 	// cleanup will be handled by  &QObject::deleteLater
 
-	PSClient* m_psClient{};
-	QThread *m_workerThread;
-	Minion *m_minion;
+	PSClient* m_psClient;
+
+	// Runs are jobs of the scheduler; ids below are job ids
+	RunScheduler* m_scheduler;
+
+	QAction *m_cancelAction;
+	QAction *m_runFilesAction;
 
-	void setupWorker();
+	// Submits script with the settings of the moment
+	void submit(const QString &title, const QString &script);
 
 	void setupSignals();
 };
@@ -0,0 +1,161 @@
+//
+// Created by talik on 10/18/2026.
+//
+
+#include "EditJournal.h"
+
+#include <algorithm>
+#include <filesystem>
+#include <utility>
+#include <QCryptographicHash>
+#include <QDataStream>
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QTextCursor>
+#include <QTextDocument>
+
+#ifdef Q_OS_WIN
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+namespace
+{
+    constexpr quint32 Magic = 0x42524a4c; // "BRJL"
+    constexpr quint16 Version = 1;
+    constexpr auto StreamVersion = QDataStream::Qt_6_0;
+
+    // QFile::flush() only empties Qt's buffer, the OS may still hold the data
+    bool syncToDisk(QFile& file)
+    {
+        if (!file.flush())
+        {
+            return false;
+        }
+#ifdef Q_OS_WIN
+        return _commit(file.handle()) == 0;
+#else
+        return fsync(file.handle()) == 0;
+#endif
+    }
+}
+
+EditJournal::Base EditJournal::Base::of(const QString& filePath)
+{
+    const QFileInfo info(filePath);
+    if (!info.exists())
+    {
+        return {};
+    }
+
+    return {.size = info.size(), .lastModified = info.lastModified().toMSecsSinceEpoch()};
+}
+
+QString EditJournal::pathFor(const QString& filePath)
+{
+    const std::filesystem::path journalDir = std::filesystem::temp_directory_path() / "Buraq" / ".data" / "journal";
+
+    const QByteArray key = QCryptographicHash::hash(QFileInfo(filePath).absoluteFilePath().toUtf8(),
+                                                    QCryptographicHash::Sha1).toHex();
+
+    return QDir(journalDir).filePath(QString::fromLatin1(key) + ".journal");
+}
+
+void EditJournal::record(const int position, const int removed, const QString& text)
+{
+    QDataStream out(&m_pending, QIODevice::WriteOnly | QIODevice::Append);
+    out.setVersion(StreamVersion);
+    out << static_cast<qint32>(position) << static_cast<qint32>(removed) << text;
+}
+
+QByteArray EditJournal::takePending()
+{
+    return std::exchange(m_pending, {});
+}
+
+QString EditJournal::append(const QString& journalPath, const Base& base, const QByteArray& batch)
+{
+    QFile file(journalPath);
+    const bool isNew = !file.exists();
+    if (isNew)
+    {
+        QDir().mkpath(QFileInfo(journalPath).absolutePath());
+    }
+
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Append))
+    {
+        return file.errorString();
+    }
+
+    if (isNew)
+    {
+        QDataStream out(&file);
+        out.setVersion(StreamVersion);
+        out << Magic << Version << base.size << base.lastModified;
+    }
+
+    if (file.write(batch) != batch.size() || !syncToDisk(file))
+    {
+        return file.errorString();
+    }
+
+    return {};
+}
+
+int EditJournal::replay(const QString& filePath, QTextDocument* document)
+{
+    const QString journalPath = pathFor(filePath);
+    QFile file(journalPath);
+    if (!file.open(QIODevice::ReadOnly))
+    {
+        return 0;
+    }
+
+    QDataStream in(&file);
+    in.setVersion(StreamVersion);
+
+    quint32 magic = 0;
+    quint16 version = 0;
+    Base base;
+    in >> magic >> version >> base.size >> base.lastModified;
+
+    if (in.status() != QDataStream::Ok || magic != Magic || version != Version || base != Base::of(filePath))
+    {
+        // Written for another version of the file
+        file.close();
+        QFile::remove(journalPath);
+        return 0;
+    }
+
+    // Recovered edits are undone as one step
+    QTextCursor cursor(document);
+    cursor.beginEditBlock();
+
+    int replayed = 0;
+    while (!in.atEnd())
+    {
+        qint32 position = 0;
+        qint32 removed = 0;
+        QString text;
+        in >> position >> removed >> text;
+
+        // The last record may have been cut short by a crash
+        const int last = document->characterCount() - 1;
+        if (in.status() != QDataStream::Ok || position < 0 || position > last)
+        {
+            break;
+        }
+
+        cursor.setPosition(position);
+        cursor.setPosition(std::min(position + removed, last), QTextCursor::KeepAnchor);
+        cursor.insertText(text);
+        ++replayed;
+    }
+
+    cursor.endEditBlock();
+
+    return replayed;
+}
@@ -0,0 +1,68 @@
+//
+// Created by talik on 10/18/2026.
+//
+
+#ifndef EDIT_JOURNAL_H
+#define EDIT_JOURNAL_H
+
+#include <QByteArray>
+#include <QString>
+
+class QTextDocument;
+
+/**
+ * Append-only log of the edits made to a file since it was last saved.
+ *
+ * Each record replaces `removed` characters at `position` with `text`, in
+ * QTextDocument positions. A journal starts with the size and modification time
+ * of the file it applies to, so a file changed by another program is never
+ * patched with stale edits.
+ *
+ * Records are encoded on the GUI thread and appended in batches by the auto save
+ * writer, see AutoSaveScheduler.
+ */
+class EditJournal
+{
+public:
+    // Identifies the version of a file on disk that a journal applies to
+    struct Base
+    {
+        qint64 size = -1;
+        qint64 lastModified = 0;
+
+        static Base of(const QString& filePath);
+
+        bool operator==(const Base&) const = default;
+    };
+
+    // Where the journal of filePath is kept, under the user data directory
+    static QString pathFor(const QString& filePath);
+
+    // Encodes an edit into the pending batch
+    void record(int position, int removed, const QString& text);
+
+    [[nodiscard]] bool hasPending() const { return !m_pending.isEmpty(); }
+
+    [[nodiscard]] qsizetype pendingSize() const { return m_pending.size(); }
+
+    QByteArray takePending();
+
+    /**
+     * Appends batch to the journal and flushes it to the disk. A new journal is
+     * started with base as its header.
+     * @return An error message, empty on success.
+     */
+    static QString append(const QString& journalPath, const Base& base, const QByteArray& batch);
+
+    /**
+     * Applies the journal of filePath to document, which must hold the file as
+     * it is on disk. A journal that does not match the file is discarded.
+     * @return The number of edits replayed.
+     */
+    static int replay(const QString& filePath, QTextDocument* document);
+
+private:
+    QByteArray m_pending;
+};
+
+#endif //EDIT_JOURNAL_H
@@ -0,0 +1,18 @@
+//
+// Created by talik on 10/18/2026.
+//
+
+#include "EditLog.h"
+
+#include <QTextDocument>
+
+EditLog::EditLog(QTextDocument* document, QObject* parent) : QObject(parent)
+{
+    connect(document, &QTextDocument::contentsChange, this, &EditLog::onContentsChange);
+}
+
+void EditLog::onContentsChange(const int position, const int removed, const int added)
+{
+    ++m_revision;
+    emit edited(m_revision, {.position = position, .removed = removed, .added = added});
+}
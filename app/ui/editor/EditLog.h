@@ -0,0 +1,48 @@
+//
+// Created by talik on 10/18/2026.
+//
+
+#ifndef EDIT_LOG_H
+#define EDIT_LOG_H
+
+#include <QObject>
+
+class QTextDocument;
+
+// One QTextDocument::contentsChange, in document positions at the time of the change
+struct TextEdit
+{
+    int position = 0;
+    int removed = 0;
+    int added = 0;
+};
+
+/**
+ * Reports the edits made to a document as they happen.
+ *
+ * Every contentsChange bumps the revision, so consumers (autosave, the edit
+ * journal, highlighting) can tell which content they saw and what changed
+ * without copying the document.
+ */
+class EditLog final : public QObject
+{
+    Q_OBJECT
+
+signals:
+    void edited(quint64 revision, const TextEdit& edit);
+
+public:
+    explicit EditLog(QTextDocument* document, QObject* parent = nullptr);
+
+    ~EditLog() override = default;
+
+    [[nodiscard]] quint64 revision() const { return m_revision; }
+
+private slots:
+    void onContentsChange(int position, int removed, int added);
+
+private:
+    quint64 m_revision = 0;
+};
+
+#endif //EDIT_LOG_H
@@ -2,46 +2,33 @@
 // Created by talik on 3/2/2024.
 //
 
+#include <algorithm>
 #include <QGridLayout>
 #include <QFile>
+#include <QFileInfo>
 #include <QPlainTextEdit>
 #include <QPainter>
 #include <QTextBlock>
+#include <QTextCursor>
 #include <QTextEdit>
 #include <QString>
 #include <QMouseEvent>
-#include <QTextStream>  // For text files
 #include <QProcess>
+#include "TaskPool.h"
 
 #include "Editor.h"
 
 #include <qscrollbar.h>
 
 #include "EditorMargin.h"
+#include "EditJournal.h"
 #include "app_ui/AppUi.h"
 #include "frameless_window/FramelessWindow.h"
+#include "settings/SettingManager/SettingsManager.h"
 
 #define string_equals(keyText, key) \
 (std::equal(keyText.begin(), keyText.end(), key));
 
-// Capture keywords in a given line
-static QRegularExpression keywordsRegex(
-    QStringLiteral(
-        "^\\s*\\b(echo|ls|ps|Write-Output|Get-ChildItem|Connect-SPOService|"
-        "Get-SPOsite|Set-SPOUser|Install-Module)\\b(.*)$"),
-    QRegularExpression::CaseInsensitiveOption);
-
-// Capture comments at the start of in a given line
-static QRegularExpression commentsRegex(QStringLiteral("^\\s*(#\\w*)"));
-
-// Capture string literals in a given line
-static QRegularExpression doubleQuotesLiteralRegex(QStringLiteral("\"(.*?)\""));
-
-// Capture variables in a given line
-static QRegularExpression variablesRegex(
-    QStringLiteral("^\\s*(\\$\\w+\\s*)=(.*?)$"),
-    QRegularExpression::CaseInsensitiveOption);
-
 /**
  *
  * @param window The pointer to the main app.
@@ -75,6 +62,25 @@ Editor::Editor(QWidget* window)
     m_plainTextEdit->setLineWrapMode(QPlainTextEdit::NoWrap);
     m_plainTextEdit->setHorizontalScrollBarPolicy(Qt::ScrollBarAsNeeded);
 
+    // Enables syntaxHighlighting i.e. showing keywords, comments, variables etc.
+    // The document takes ownership of the highlighter.
+    m_highlighter = new SyntaxHighlighter(m_plainTextEdit->document());
+
+    // Reads files off the GUI thread, see openAndParseFile()
+    m_loaderStrand = std::make_unique<TaskStrand>();
+    m_loader = new FileLoader();
+    connect(m_loader, &FileLoader::chunkReady, this, &Editor::onFileChunk);
+    connect(m_loader, &FileLoader::finished, this, &Editor::onFileLoaded);
+
+    // Tracks edits as they happen, so nothing needs to snapshot the whole document per key press
+    m_editLog = new EditLog(m_plainTextEdit->document(), this);
+    connect(m_editLog, &EditLog::edited, m_highlighter, &SyntaxHighlighter::onDocumentEdited);
+
+    // Writes the document on a worker thread once the user stops typing
+    m_autoSave = std::make_unique<AutoSaveScheduler>([this] { return toPlainText(); });
+    m_autoSave->setJournalEnabled(SettingsManager::loadSettings().editJournalEnabled);
+    connect(m_editLog, &EditLog::edited, this, &Editor::journalEdit);
+
     // 6. Forward properties/methods to the internal QPlainTextEdit
     {
         // update place holder text
@@ -92,9 +98,11 @@ Editor::Editor(QWidget* window)
     // Example connections (assuming EditorMargin has onEditorScrolled and updateMarginWidth slots)
     connect(m_plainTextEdit->verticalScrollBar(), &QScrollBar::valueChanged,
             m_editorMargin.get(), &EditorMargin::onEditorScrolled);
-    connect(m_plainTextEdit->document(), &QTextDocument::contentsChange, m_editorMargin.get(), [this]()
+    connect(m_plainTextEdit->document(), &QTextDocument::blockCountChanged, this, [this](const int blockCount)
     {
-        m_editorMargin.get()->updateMarginWidth(m_state);
+        buraq::EditorState state = m_state;
+        state.blockCount = blockCount;
+        updateState(state);
     }); // Also update on text changes
 
     // Call your existing setupSignals() if it does more than just this.
@@ -106,11 +114,26 @@ Editor::Editor(QWidget* window)
     main_layout->addWidget(m_editorMargin.get()); // Add margin to the left
     main_layout->addWidget(m_plainTextEdit.get()); // Add QPlainTextEdit to the right
 
+    // Takes the place of the margin and the text edit when a large file is opened
+    m_largeFileView = new LargeFileView(this);
+    m_largeFileView->hide();
+    main_layout->addWidget(m_largeFileView);
+    connect(m_largeFileView, &LargeFileView::statusUpdate, this, &Editor::statusUpdate);
+
     // Any other signals from Editor that need to come from m_plainTextEdit
     // would be connected here, and then Editor would re-emit them.
     // Example: connect(m_plainTextEdit.get(), &QPlainTextEdit::textChanged, this, &Editor::textChanged);
 }
 
+Editor::~Editor()
+{
+    // Stops a running load before its next chunk
+    m_loader->setLatestId(++m_loadId);
+
+    m_loaderStrand->wait();
+    delete m_loader;
+}
+
 void Editor::highlightCurrentLine()
 {
     if (const auto textEdit = m_plainTextEdit.get(); !textEdit->isReadOnly())
@@ -122,135 +145,205 @@ void Editor::highlightCurrentLine()
 
         selection.format.setBackground(lineColor);
         selection.format.setProperty(QTextFormat::FullWidthSelection, true);
-        m_state.hasText = m_currentFile.isEmpty();
-        m_state.isBlockValid = false;
-        m_state.isSelected = false;
-        m_state.blockCount = textEdit->blockCount();
 
         const auto text_cursor = textEdit->textCursor();
         selection.cursor = text_cursor;
         extraSelections.append(selection);
-        m_state.blockNumber = m_state.cursorBlockNumber = text_cursor.blockNumber();
-        m_state.lineHeight = fontMetrics().height();
 
-        m_state.currentLineHeight = textEdit->cursorRect().height();
+        buraq::EditorState state = m_state;
+        state.blockCount = textEdit->blockCount();
+        state.cursorBlockNumber = text_cursor.blockNumber();
 
-        if (selection.cursor.hasSelection())
+        if (text_cursor.hasSelection())
         {
-            m_state.isSelected = true;
-            m_state.selectedBlockNumbers.insert(selection.cursor.block().blockNumber());
+            // Shrinks with the selection too, unlike collecting the blocks the cursor passed
+            const QTextDocument* document = textEdit->document();
+            state.selectionFirstBlock = document->findBlock(text_cursor.selectionStart()).blockNumber();
+            state.selectionLastBlock = document->findBlock(text_cursor.selectionEnd()).blockNumber();
         }
         else
         {
-            m_state.selectedBlockNumbers.clear();
+            state.selectionFirstBlock = state.selectionLastBlock = -1;
         }
 
-        emit lineNumberAreaPaintEventSignal(m_state);
+        updateState(state);
 
         textEdit->setExtraSelections(extraSelections);
     }
 }
 
-QString Editor::convertRhsTextToHtml(const QString& qRhsLine)
+void Editor::updateVisibleBlocks()
 {
-    //qDebug() << qRhsLine;
+    const QTextBlock first = m_plainTextEdit->cursorForPosition(QPoint(0, 0)).block();
+    const int last = m_plainTextEdit->cursorForPosition(QPoint(0, m_plainTextEdit->viewport()->height() - 1)).
+        blockNumber();
+
+    m_highlighter->setVisibleBlocks(first.blockNumber(), last);
+
+    // firstVisibleBlock() and blockBoundingGeometry() are protected, cursorRect() gives the same geometry
+    const QRect firstRect = m_plainTextEdit->cursorRect(QTextCursor(first));
+    const QTextBlock next = first.next();
+
+    buraq::EditorState state = m_state;
+    state.firstVisibleBlock = first.blockNumber();
+    state.firstVisibleBlockTop = firstRect.top();
+    state.lineHeight = next.isValid()
+                           ? m_plainTextEdit->cursorRect(QTextCursor(next)).top() - firstRect.top()
+                           : firstRect.height();
+    state.blockCount = m_plainTextEdit->blockCount();
+
+    // Called on every scroll and cursor blink, mostly with nothing changed
+    updateState(state);
+}
 
-    QRegularExpressionMatch doubleQuotesLiteralExp = doubleQuotesLiteralRegex.match(qRhsLine);
-    if (doubleQuotesLiteralExp.hasMatch())
+void Editor::updateState(buraq::EditorState state)
+{
+    state.revision = m_state.revision;
+    if (state == m_state)
     {
-		//@formatter:off
-		return QString("<span style='color:#3eb489'>" +
-					   qRhsLine +
-					   "</span>");
-        //@formatter:on
+        return;
     }
 
-    return qRhsLine;
+    state.revision = m_state.revision + 1;
+    m_state = state;
+
+    // Changes made while handling the same event (an edit moves the cursor, scrolls
+    // and changes the block count) reach the gutter as a single update.
+    if (!m_statePending)
+    {
+        m_statePending = true;
+        QMetaObject::invokeMethod(this, [this]
+        {
+            m_statePending = false;
+            emit lineNumberAreaPaintEventSignal(m_state);
+        }, Qt::QueuedConnection);
+    }
 }
 
-QString Editor::convertTextToHtml(QString& line)
+void Editor::openAndParseFile(const QString& filePath, QFile::OpenModeFlag modeFlag)
 {
-    QString lineBreak("<p> </p>");
+    // Saves the pending edits of the previous file before its text is replaced,
+    // nothing is journaled while loading.
+    m_autoSave->setFilePath(QString());
+
+    // Cancels a load that is still running
+    m_loader->setLatestId(++m_loadId);
+    m_loadingFile = filePath;
+    m_loadProgress = -1;
 
-    if (line.isEmpty())
+    if (QFileInfo(filePath).size() >= LargeFileView::Threshold)
     {
-        // FIXME what is the best way to add new lines? <br/> adds extra lines
-        return lineBreak;
+        // Shown read only straight from the file, the document is not needed
+        m_currentFile.clear();
+        finishLoading();
+        m_plainTextEdit->clear();
+
+        m_largeFileView->setFont(m_plainTextEdit->font());
+        showLargeFileView(true);
+        m_largeFileView->openFile(filePath);
+        return;
     }
 
-    // Handles comments on if # is found at the beginning of the line
-    QRegularExpressionMatch commentAtStartOfLineExp = commentsRegex.match(line);
-    if (commentAtStartOfLineExp.hasMatch())
+    showLargeFileView(false);
+
+    // Files opened read only are never auto saved
+    this->m_currentFile = modeFlag != QFile::ReadOnly ? filePath : QString();
+
+    // The file is appended in chunks: edits in between would get mixed into it,
+    // and the undo stack would keep a second copy of it.
+    m_plainTextEdit->setReadOnly(true);
+    m_plainTextEdit->document()->setUndoRedoEnabled(false);
+    m_highlighter->beginLoading();
+    m_plainTextEdit->clear();
+
+    m_loaderStrand->post([loader = m_loader, id = m_loadId, filePath] { loader->load(id, filePath); });
+}
+
+void Editor::onFileChunk(const quint64 id, const QString& text, const QList<int>& states, const qint64 bytesRead,
+                         const qint64 size)
+{
+    m_loader->chunkConsumed();
+    if (id != m_loadId)
     {
-        return "<p style='color:gray'>" + line + "</p>";
+        return;
     }
 
-    QRegularExpressionMatch keywordsExp = keywordsRegex.match(line);
-    if (keywordsExp.hasMatch())
+    // Every chunk ends on a line break, so the new text starts in the empty last block
+    QTextDocument* document = m_plainTextEdit->document();
+    const int firstBlock = document->blockCount() - 1;
+
+    QTextCursor cursor(document);
+    cursor.movePosition(QTextCursor::End);
+    cursor.insertText(text);
+
+    m_highlighter->setBlockStates(firstBlock, states);
+
+    if (const int progress = size > 0 ? static_cast<int>(bytesRead * 100 / size) : 100; progress != m_loadProgress)
     {
-        auto keyword = keywordsExp.captured(1);
-        auto rhsTextToHtml = convertRhsTextToHtml(keywordsExp.captured(2));
-
-        //qDebug() << rhsTextToHtml;
-        //qDebug() << keywordsExp.capturedTexts();
-
-		//@formatter:off
-		return QString("<p>"
-				"<span style='color:#FFB76B'>" + keyword + "</span>" +
-				rhsTextToHtml +
-				"</p>");
-        //@formatter:on
+        m_loadProgress = progress;
+        emit statusUpdate(QString("Loading %1%").arg(progress), 2000);
     }
+}
 
-    QRegularExpressionMatch variablesRegexExp = variablesRegex.match(line);
-    if (variablesRegexExp.hasMatch())
+void Editor::onFileLoaded(const quint64 id, const FileFormat& format, const QString& error)
+{
+    if (id != m_loadId)
     {
-        auto variable = variablesRegexExp.captured(1);
-        auto rhsTextToHtml = convertRhsTextToHtml(variablesRegexExp.captured(2));
-
-		//@formatter:off
-		return QString("<p>"
-					   "<span style='color:#87CEEB'>" + variable + "</span>" +
-					   "=" +
-					   rhsTextToHtml +
-					   "</p>");
-        //@formatter:on
+        return;
     }
 
-    if (std::equal(line.begin(), line.end(), " ")) return lineBreak;
+    finishLoading();
 
-	//@formatter:off
-	return QString("<p style='text-decoration: green wavy underline;'>"
-					+ line + // TODO underline only the first word
-				   "</p>");
-    //@formatter:on
-}
-
-void Editor::openAndParseFile(const QString& filePath, QFile::OpenModeFlag modeFlag)
-{
-    if (modeFlag != QFile::ReadOnly)
+    if (!error.isEmpty())
     {
-        this->m_currentFile = filePath;
+        // Auto saving would replace the file with whatever was loaded of it
+        m_currentFile.clear();
+        emit statusUpdate("Failed to open file " + m_loadingFile + ": " + error);
+        return;
     }
 
-    try
+    // The document matches the file on disk
+    m_savedRevision = m_editLog->revision();
+
+    // Recovers the edits that were not saved when the app last stopped
+    int recovered = 0;
+    if (!m_currentFile.isEmpty() && m_autoSave->isJournalEnabled())
     {
-        QFile file(filePath);
-        file.open(modeFlag);
+        recovered = EditJournal::replay(m_currentFile, m_plainTextEdit->document());
+    }
+
+    // The recovered edits are only in the journal until they are written into the file
+    m_autoSave->setFilePath(m_currentFile, format, recovered > 0);
 
-        QString fileContent = QString::fromLatin1(file.readAll());
-        file.close(); // close file
+    if (recovered > 0)
+    {
+        m_autoSave->schedule(m_editLog->revision());
+        m_autoSave->flush();
+        emit statusUpdate(QString("Recovered %1 unsaved edits.").arg(recovered));
+    }
+}
 
-        // clear editor before using the function to avoid adding to the previous opened file
-        setPlainText(fileContent);
+void Editor::finishLoading() const
+{
+    m_highlighter->endLoading();
+    m_plainTextEdit->document()->setUndoRedoEnabled(true);
+    m_plainTextEdit->setReadOnly(false);
+}
 
-        // highlight syntax
-        emit syntaxtHighlightingEvent();
+void Editor::showLargeFileView(const bool show) const
+{
+    if (!show)
+    {
+        m_largeFileView->closeFile();
     }
-    catch (...)
+
+    m_largeFileView->setVisible(show);
+    m_editorMargin->setVisible(!show);
+    m_plainTextEdit->setVisible(!show);
+
+    if (show)
     {
-        qDebug() << "emit exception";
-        statusUpdate("File to open file " + filePath);
+        m_largeFileView->setFocus();
     }
 }
 
@@ -258,44 +351,56 @@ void Editor::setupSignals()
 {
     connect(m_plainTextEdit.get(), &QPlainTextEdit::cursorPositionChanged, this, &Editor::highlightCurrentLine);
 
-    // Enables syntaxHighlighting i.e. showing keywords, comments, variables etc.
-    connect(this, &Editor::syntaxtHighlightingEvent, this, &Editor::documentSyntaxHighlighting);
-    connect(this, &Editor::inlineSyntaxtHighlightingEvent, this, &Editor::inlineSyntaxHighlighting);
+    // Emitted on scrolling and resizing, keeps syntax highlighting limited to the viewport
+    connect(m_plainTextEdit.get(), &QPlainTextEdit::updateRequest, this, &Editor::updateVisibleBlocks);
 
     // Enables auto saving the document
     connect(this, &Editor::readyToSaveEvent, this, &Editor::autoSave);
+    connect(m_autoSave.get(), &AutoSaveScheduler::saved, this, [this](const quint64 revision)
+    {
+        m_savedRevision = revision;
+        emit statusUpdate("Auto Saved.", 5000);
+    });
+    connect(m_autoSave.get(), &AutoSaveScheduler::saveFailed, this, [this](const QString& error)
+    {
+        emit statusUpdate("Auto save failed: " + error);
+    });
 
     // Update status bar in AppUI component
     const auto appUi_ = dynamic_cast<FramelessWindow*>(m_window);
     connect(this, &Editor::statusUpdate, appUi_, &FramelessWindow::processStatusSlot);
 
-    // Signal to update status bar in AppUI component for the running process
-    connect(this, &Editor::lineNumberAreaPaintEventSignal, appUi_->getEditorMargin(), &EditorMargin::updateState);
+    // Keeps the line number gutter next to the editor in sync with the cursor
+    connect(this, &Editor::lineNumberAreaPaintEventSignal, m_editorMargin.get(), &EditorMargin::updateState);
 }
 
 void Editor::autoSave()
-
 {
     // auto save works only if the file had been saved before
     // therefore m_currentFile should have been set
     if (!m_currentFile.isEmpty())
     {
-        // Open the file for writing
-        QFile file(m_currentFile);
-        if (!file.open(QIODevice::WriteOnly | QIODevice::Text))
-        {
-            emit statusUpdate(file.errorString());
-        }
+        // Restarts the idle timer, a burst of key presses ends in a single write
+        m_autoSave->schedule(m_editLog->revision());
+    }
+}
+
+void Editor::journalEdit(const quint64 revision, const TextEdit& edit) const
+{
+    if (!m_autoSave->isJournaling())
+    {
+        return;
+    }
 
-        // Write data to the file (using QTextStream for text files)
-        QTextStream out(&file);
-        out << toPlainText();
+    // Only the inserted text is copied, so journaling costs as much as the edit
+    const QTextDocument* document = m_plainTextEdit->document();
+    const int last = document->characterCount() - 1;
 
-        emit statusUpdate("Auto Saving..", 5000);
+    QTextCursor cursor(m_plainTextEdit->document());
+    cursor.setPosition(std::min(edit.position, last));
+    cursor.setPosition(std::min(edit.position + edit.added, last), QTextCursor::KeepAnchor);
 
-        // Close the file (important to flush data to disk)
-        file.close();
-    }
+    m_autoSave->record(revision, edit.position, edit.removed, cursor.selectedText());
 }
 
 void Editor::keyReleaseEvent(QKeyEvent* e)
@@ -305,8 +410,6 @@ void Editor::keyReleaseEvent(QKeyEvent* e)
 
     QString keyText = e->text();
     // event to signal Auto Save can occur;
-    const bool isBackSpaceKey = string_equals(keyText, "\b");
-    const bool isEnterKey = string_equals(keyText, "\r");
     const bool isUndo = string_equals(keyText, "\u001A");
 
     if (keyText.isEmpty()) { return; }
@@ -317,23 +420,16 @@ void Editor::keyReleaseEvent(QKeyEvent* e)
         return;
     }
 
-    if (!isBackSpaceKey and !isEnterKey)
+    // Nothing changed since the last save, e.g. a Backspace at the start of the document
+    // did not delete anything. Answered by the edit log, without copying the document.
+    if (m_editLog->revision() == m_savedRevision)
     {
-        emit inlineSyntaxtHighlightingEvent();
         return;
     }
 
-    const QString currentText = toPlainText();
-    // Analyze the difference between m_previousText and currentText to identify deletions
-
-    if (const auto deletedLength = m_previousText.size() - currentText.size(); isBackSpaceKey && deletedLength > 0)
-    {
-        emit inlineSyntaxtHighlightingEvent();
-    }
-    else
-    {
-        emit readyToSaveEvent();
-    }
+    // Syntax highlighting is handled by m_highlighter as the document changes,
+    // all that is left to do here is to signal that the document can be saved.
+    emit readyToSaveEvent();
 }
 
 void Editor::mousePressEvent(QMouseEvent* e)
@@ -343,58 +439,3 @@ void Editor::mousePressEvent(QMouseEvent* e)
 
     // QPlainTextEdit::mousePressEvent(e);
 }
-
-void Editor::inlineSyntaxHighlighting()
-{
-    QTextCursor cursor = m_plainTextEdit->textCursor();
-    const int position = cursor.position();
-
-    // Create a new text cursor positioned at the beginning of the block
-    QTextBlock blockToReplace = cursor.block();
-    QTextCursor nextCursor(blockToReplace);
-    nextCursor.select(QTextCursor::SelectionType::LineUnderCursor);
-
-    QString text = blockToReplace.text();
-    const QString html = convertTextToHtml(text);
-
-    nextCursor.insertHtml(
-        "<pre>" +
-        html +
-        "</pre>"
-    );
-    nextCursor.setPosition(position);
-    m_plainTextEdit->setTextCursor(nextCursor);
-
-    //save after successful syntax highlighting
-    emit readyToSaveEvent();
-}
-
-void Editor::documentSyntaxHighlighting()
-{
-    if (QString plainText = toPlainText(); !plainText.isEmpty())
-    {
-        // creating opening tags for HTML string
-        QString html("<pre>");
-        for (auto line : plainText.split("\n"))
-        {
-            // Process the line here
-            html.append(convertTextToHtml(line));
-        }
-        // closing tags for HTML string
-        html.append("</pre>");
-
-        // update the UI with the new formatted code.
-        m_plainTextEdit->clear();
-        m_plainTextEdit->appendHtml(html);
-    }
-
-    // save after successful syntax highlighting
-    emit readyToSaveEvent();
-}
-
-void Editor::keyPressEvent(QKeyEvent* e)
-{
-    m_previousText = toPlainText();
-
-    // m_plainTextEdit->keyPressEvent(e);
-}
@@ -8,13 +8,18 @@
 #include <QPlainTextEdit>
 #include <QWidget>
 #include <QFile>
-#include <QTimer>
-#include <QRegularExpression>
 #include <QStack>
 
 #include "EditorMargin.h"
+#include "SyntaxHighlighter.h"
+#include "EditLog.h"
+#include "AutoSaveScheduler.h"
+#include "FileLoader.h"
+#include "LargeFileView.h"
 #include "buraq.h"
 
+class TaskStrand;
+
 class Editor final : public QWidget
 {
     Q_OBJECT
@@ -22,8 +27,6 @@ class Editor final : public QWidget
 protected:
     // void focusInEvent(QFocusEvent *e) override;
 
-    void keyPressEvent(QKeyEvent* e) override;
-
     void keyReleaseEvent(QKeyEvent* e) override;
 
     void mousePressEvent(QMouseEvent* e) override;
@@ -33,46 +36,67 @@ signals:
 
     void readyToSaveEvent();
 
-    void syntaxtHighlightingEvent();
-
-    void inlineSyntaxtHighlightingEvent();
-
     void lineNumberAreaPaintEventSignal(const buraq::EditorState& state);
 
 public:
     explicit Editor(QWidget* window = nullptr);
 
-    ~Editor() override = default;
+    ~Editor() override;
 
     void openAndParseFile(const QString& filePath, QFile::OpenModeFlag modeFlag = QFile::OpenModeFlag::ReadOnly);
     // Add forwarding methods if external code calls QPlainTextEdit methods on Editor
     [[nodiscard]] QString toPlainText() const { return m_plainTextEdit->toPlainText(); }
     [[nodiscard]] QString selectedText() const { return m_plainTextEdit->textCursor().selectedText(); }
     void setPlainText(const QString& text) const { m_plainTextEdit->setPlainText(text); }
+    // Empty until a file is opened
+    [[nodiscard]] const QString& currentFile() const { return m_currentFile; }
 
 private slots:
     void highlightCurrentLine();
 
-    void documentSyntaxHighlighting();
-
-    void inlineSyntaxHighlighting();
+    void updateVisibleBlocks();
 
     void autoSave();
 
+    void journalEdit(quint64 revision, const TextEdit& edit) const;
+
+    void onFileChunk(quint64 id, const QString& text, const QList<int>& states, qint64 bytesRead, qint64 size);
+
+    void onFileLoaded(quint64 id, const FileFormat& format, const QString& error);
+
 private:
     std::unique_ptr<QPlainTextEdit> m_plainTextEdit; // FIX: Internal QPlainTextEdit
     std::unique_ptr<EditorMargin> m_editorMargin; // Your margin widget
+    SyntaxHighlighter* m_highlighter{}; // owned by m_plainTextEdit's document
+    // Replaces m_plainTextEdit for files of LargeFileView::Threshold and more
+    LargeFileView* m_largeFileView{};
+    EditLog* m_editLog{};
     QWidget* m_window;
     QStack<QString> m_history;
     QString m_currentFile;
-    QString m_previousText;
-    QTimer m_autoSaveTimer;
-    buraq::EditorState m_state;
-
-    static QString convertTextToHtml(QString&);
-    static QString convertRhsTextToHtml(const QString&);
+    // Reads files on the task pool, m_loadId identifies the latest load
+    std::unique_ptr<TaskStrand> m_loaderStrand;
+    FileLoader* m_loader{};
+    quint64 m_loadId = 0;
+    QString m_loadingFile;
+    int m_loadProgress = -1;
+    // EditLog revision of the last auto save
+    quint64 m_savedRevision = 0;
+    // Declared after m_plainTextEdit, its destructor still reads the document for the final save
+    std::unique_ptr<AutoSaveScheduler> m_autoSave;
+    buraq::EditorState m_state{};
+    // An update of m_state is queued for the gutter
+    bool m_statePending = false;
 
     void setupSignals();
+
+    // Makes m_plainTextEdit editable again after a load ended or was abandoned
+    void finishLoading() const;
+
+    void showLargeFileView(bool show) const;
+
+    // Stores state and schedules one gutter update per event loop pass, if anything changed
+    void updateState(buraq::EditorState state);
 };
 
 #endif //IT_TOOLS_EDITOR_H2
@@ -0,0 +1,22 @@
+//
+// Created by talik on 10/18/2026.
+//
+
+#ifndef FILE_FORMAT_H
+#define FILE_FORMAT_H
+
+#include <QMetaType>
+#include <QStringConverter>
+
+// How a text file is stored on disk, so it is saved the way it was loaded
+struct FileFormat
+{
+    QStringConverter::Encoding encoding = QStringConverter::Utf8;
+    bool hasBom = false;
+    // Lines end with \r\n rather than \n
+    bool crlf = false;
+};
+
+Q_DECLARE_METATYPE(FileFormat)
+
+#endif //FILE_FORMAT_H
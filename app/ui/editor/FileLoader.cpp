@@ -0,0 +1,156 @@
+//
+// Created by talik on 10/18/2026.
+//
+
+#include "FileLoader.h"
+
+#include <algorithm>
+#include <optional>
+#include <vector>
+#include <QFile>
+#include <QStringDecoder>
+
+#include "PSTokenizer.h"
+
+namespace
+{
+    // Bytes checked for valid UTF-8 when a file has no BOM
+    constexpr qsizetype SniffBytes = 64 * 1024;
+
+    /**
+     * Position just past the last complete line break of text, 0 if there is none.
+     * A trailing \r is not complete, the \n of a \r\n may still be on its way.
+     */
+    qsizetype endOfLastLine(const QString& text)
+    {
+        for (qsizetype i = text.size() - 1; i >= 0; --i)
+        {
+            const QChar c = text.at(i);
+            if (c == u'\r' && i == text.size() - 1)
+            {
+                continue;
+            }
+            if (c == u'\n' || c == u'\r' || c == QChar::ParagraphSeparator)
+            {
+                return i + 1;
+            }
+        }
+        return 0;
+    }
+}
+
+FileFormat FileLoader::detectFormat(const QByteArrayView head)
+{
+    if (const auto encoding = QStringConverter::encodingForData(head))
+    {
+        return {.encoding = *encoding, .hasBom = true};
+    }
+
+    // A multibyte sequence cut off at the end of the sample is not an error
+    QStringDecoder utf8(QStringConverter::Utf8);
+    [[maybe_unused]] const QString sample = utf8.decode(head.first(std::min(head.size(), SniffBytes)));
+    if (!utf8.hasError())
+    {
+        return {.encoding = QStringConverter::Utf8};
+    }
+
+    // Windows PowerShell saves scripts without a BOM in the ANSI code page
+    return {.encoding = QStringConverter::System};
+}
+
+void FileLoader::load(const quint64 id, const QString& filePath)
+{
+    QFile file(filePath);
+    if (!file.open(QIODevice::ReadOnly))
+    {
+        emit finished(id, {}, file.errorString());
+        return;
+    }
+
+    const qint64 size = file.size();
+
+    // Mapped pages are read straight from the page cache, no copy of the file is made.
+    // Files that cannot be mapped (e.g. empty ones) are read in chunks instead.
+    const uchar* mapped = size > 0 ? file.map(0, size) : nullptr;
+    QByteArray buffer;
+
+    FileFormat format;
+    std::optional<QStringDecoder> decoder;
+    bool lineEndingKnown = false;
+
+    QString pending;
+    std::vector<pslang::Token> tokens;
+    pslang::LexState state = pslang::InitialState;
+
+    qint64 offset = 0;
+    bool atEnd = false;
+    while (!atEnd)
+    {
+        if (isCancelled(id))
+        {
+            return;
+        }
+
+        const qint64 length = std::min(ChunkBytes, size - offset);
+        QByteArrayView bytes;
+        if (mapped)
+        {
+            bytes = QByteArrayView(mapped + offset, length);
+        }
+        else
+        {
+            buffer = file.read(length);
+            bytes = buffer;
+        }
+        offset += bytes.size();
+        atEnd = offset >= size || bytes.isEmpty();
+
+        if (!decoder)
+        {
+            format = detectFormat(bytes);
+            decoder.emplace(format.encoding);
+        }
+        pending.append(QString(decoder->decode(bytes)));
+
+        if (!lineEndingKnown)
+        {
+            if (const qsizetype newline = pending.indexOf(u'\n'); newline >= 0)
+            {
+                format.crlf = newline > 0 && pending.at(newline - 1) == u'\r';
+                lineEndingKnown = true;
+            }
+        }
+
+        // Chunks end on a line break so that every chunk starts a new block
+        const qsizetype cut = atEnd ? pending.size() : endOfLastLine(pending);
+        if (cut == 0 && !atEnd)
+        {
+            continue;
+        }
+
+        QString text = pending.left(cut);
+        pending.remove(0, cut);
+
+        QList<int> states;
+        state = pslang::tokenizeLines(text, state, atEnd, tokens, states);
+
+        // Waits for the GUI to catch up, so decoded text does not pile up in the event queue
+        while (!m_credits.tryAcquire(1, 100))
+        {
+            if (isCancelled(id))
+            {
+                return;
+            }
+        }
+
+        emit chunkReady(id, text, states, offset, size);
+    }
+
+    if (file.error() != QFileDevice::NoError)
+    {
+        emit finished(id, format, file.errorString());
+        return;
+    }
+
+    emit finished(id, format, {});
+}
@@ -0,0 +1,69 @@
+//
+// Created by talik on 10/18/2026.
+//
+
+#ifndef FILE_LOADER_H
+#define FILE_LOADER_H
+
+#include <atomic>
+#include <QList>
+#include <QObject>
+#include <QSemaphore>
+#include <QString>
+
+#include "FileFormat.h"
+
+/**
+ * Reads a file for the editor on a worker thread.
+ *
+ * The file is memory mapped read only and decoded in chunks, with the encoding
+ * taken from its BOM, or UTF-8 when the start of the file is valid UTF-8 and the
+ * system code page otherwise. Every chunk ends on a line break and comes with
+ * the lexer states of its lines, so the editor can append it to the document
+ * without the highlighter lexing the file a second time.
+ *
+ * At most MaxChunksInFlight chunks wait on the GUI thread at any time; the GUI
+ * hands each one back with chunkConsumed().
+ */
+class FileLoader final : public QObject
+{
+    Q_OBJECT
+
+signals:
+    // states[i] is the lexer state at the end of the i-th line of text
+    void chunkReady(quint64 id, const QString& text, const QList<int>& states, qint64 bytesRead, qint64 size);
+
+    // error is empty on success
+    void finished(quint64 id, const FileFormat& format, const QString& error);
+
+public slots:
+    void load(quint64 id, const QString& filePath);
+
+public:
+    explicit FileLoader(QObject* parent = nullptr) : QObject(parent) {}
+
+    ~FileLoader() override = default;
+
+    // Called on the GUI thread once a chunk was added to the document. Thread safe.
+    void chunkConsumed() { m_credits.release(); }
+
+    /**
+     * Marks every load older than id as cancelled. Thread safe.
+     * A cancelled load stops before its next chunk.
+     */
+    void setLatestId(quint64 id) { m_latestId.store(id, std::memory_order_relaxed); }
+
+    // Encoding of a file starting with head, see the class description
+    static FileFormat detectFormat(QByteArrayView head);
+
+private:
+    static constexpr qint64 ChunkBytes = 1024 * 1024;
+    static constexpr int MaxChunksInFlight = 4;
+
+    QSemaphore m_credits{MaxChunksInFlight};
+    std::atomic<quint64> m_latestId{0};
+
+    [[nodiscard]] bool isCancelled(quint64 id) const { return m_latestId.load(std::memory_order_relaxed) != id; }
+};
+
+#endif //FILE_LOADER_H
@@ -0,0 +1,519 @@
+//
+// Created by talik on 10/18/2026.
+//
+
+#include "LargeFileView.h"
+
+#include <cstring>
+#include <limits>
+#include <QByteArrayMatcher>
+#include <QInputDialog>
+#include <QKeyEvent>
+#include <QPainter>
+#include <QScrollBar>
+#include <QStringDecoder>
+#include <QStringEncoder>
+#include "TaskPool.h"
+
+#include "FileLoader.h"
+
+CodeUnits CodeUnits::of(const FileFormat& format)
+{
+    CodeUnits units;
+    switch (format.encoding)
+    {
+    case QStringConverter::Utf16:
+    case QStringConverter::Utf16LE:
+        units.size = 2;
+        break;
+    case QStringConverter::Utf16BE:
+        units.size = 2;
+        units.bigEndian = true;
+        break;
+    case QStringConverter::Utf32:
+    case QStringConverter::Utf32LE:
+        units.size = 4;
+        break;
+    case QStringConverter::Utf32BE:
+        units.size = 4;
+        units.bigEndian = true;
+        break;
+    default:
+        break;
+    }
+
+    if (format.hasBom)
+    {
+        units.bomSize = format.encoding == QStringConverter::Utf8 ? 3 : units.size;
+    }
+    return units;
+}
+
+void LargeFileScanner::index(const quint64 id, const QString& filePath, const CodeUnits& units)
+{
+    QFile file(filePath);
+    const qint64 size = file.open(QIODevice::ReadOnly) ? file.size() : 0;
+    const uchar* data = size > 0 ? file.map(0, size) : nullptr;
+    if (!data)
+    {
+        emit indexFinished(id);
+        return;
+    }
+
+    QList<qint64> starts;
+    starts.reserve(LinesPerBatch);
+
+    // Returns false once the job was cancelled
+    const auto push = [&](const qint64 start)
+    {
+        starts.append(start);
+        if (starts.size() < LinesPerBatch)
+        {
+            return true;
+        }
+        if (m_latestIndex.load(std::memory_order_relaxed) != id)
+        {
+            return false;
+        }
+        emit linesIndexed(id, starts, start);
+        starts.clear();
+        return true;
+    };
+
+    qint64 pos = units.bomSize;
+    if (units.size == 1)
+    {
+        while (pos < size)
+        {
+            const auto hit = static_cast<const uchar*>(std::memchr(data + pos, '\n', size - pos));
+            if (!hit)
+            {
+                break;
+            }
+            pos = hit - data + 1;
+            if (!push(pos))
+            {
+                return;
+            }
+        }
+    }
+    else
+    {
+        // The newline code unit has the 0x0a in its lowest byte
+        const int newlineByte = units.bigEndian ? units.size - 1 : 0;
+        for (; pos + units.size <= size; pos += units.size)
+        {
+            bool isNewline = data[pos + newlineByte] == '\n';
+            for (int i = 0; isNewline && i < units.size; ++i)
+            {
+                isNewline = i == newlineByte || data[pos + i] == 0;
+            }
+            if (isNewline && !push(pos + units.size))
+            {
+                return;
+            }
+        }
+    }
+
+    if (!starts.isEmpty())
+    {
+        emit linesIndexed(id, starts, size);
+    }
+    emit indexFinished(id);
+}
+
+void LargeFileScanner::find(const quint64 id, const QString& filePath, const QByteArray& needle, const qint64 from,
+                            const CodeUnits& units)
+{
+    QFile file(filePath);
+    const qint64 size = file.open(QIODevice::ReadOnly) ? file.size() : 0;
+    const uchar* data = size > 0 ? file.map(0, size) : nullptr;
+    if (!data || needle.isEmpty())
+    {
+        emit found(id, -1);
+        return;
+    }
+
+    constexpr qint64 Cancelled = -2;
+    const QByteArrayMatcher matcher(needle);
+
+    // First match starting in [begin, end) on a code unit boundary
+    const auto search = [&](const qint64 begin, const qint64 end) -> qint64
+    {
+        for (qint64 window = begin; window < end; window += SearchWindow)
+        {
+            if (m_latestSearch.load(std::memory_order_relaxed) != id)
+            {
+                return Cancelled;
+            }
+
+            // Windows overlap by the needle size, so a match across the boundary is found in the first one
+            const qint64 startLimit = std::min(end, window + SearchWindow);
+            const qint64 dataEnd = std::min(size, startLimit + needle.size() - 1);
+            const auto windowData = reinterpret_cast<const char*>(data + window);
+
+            for (qsizetype hit = matcher.indexIn(windowData, dataEnd - window, 0);
+                 hit >= 0 && window + hit < startLimit;
+                 hit = matcher.indexIn(windowData, dataEnd - window, hit + 1))
+            {
+                if ((window + hit - units.bomSize) % units.size == 0)
+                {
+                    return window + hit;
+                }
+            }
+        }
+        return -1;
+    };
+
+    qint64 offset = search(from, size);
+    if (offset == -1)
+    {
+        offset = search(units.bomSize, from);
+    }
+    if (offset == Cancelled)
+    {
+        return;
+    }
+
+    emit found(id, offset);
+}
+
+LargeFileView::LargeFileView(QWidget* parent)
+    : QAbstractScrollArea(parent), m_scannerStrand(std::make_unique<TaskStrand>()), m_scanner(new LargeFileScanner())
+{
+    setObjectName("LargeFileView");
+    setFrameShape(NoFrame);
+    setFocusPolicy(Qt::StrongFocus);
+
+    connect(m_scanner, &LargeFileScanner::linesIndexed, this, &LargeFileView::onLinesIndexed);
+    connect(m_scanner, &LargeFileScanner::indexFinished, this, &LargeFileView::onIndexFinished);
+    connect(m_scanner, &LargeFileScanner::found, this, &LargeFileView::onFound);
+}
+
+LargeFileView::~LargeFileView()
+{
+    closeFile();
+
+    m_scannerStrand->wait();
+    delete m_scanner;
+}
+
+bool LargeFileView::openFile(const QString& filePath)
+{
+    closeFile();
+
+    m_file.setFileName(filePath);
+    if (!m_file.open(QIODevice::ReadOnly))
+    {
+        emit statusUpdate("Failed to open file " + filePath + ": " + m_file.errorString());
+        return false;
+    }
+
+    m_size = m_file.size();
+    m_data = m_size > 0 ? m_file.map(0, m_size) : nullptr;
+    if (!m_data)
+    {
+        emit statusUpdate("Failed to map file " + filePath + ": " + m_file.errorString());
+        m_file.close();
+        return false;
+    }
+
+    m_format = FileLoader::detectFormat(QByteArrayView(m_data, m_size));
+    m_units = CodeUnits::of(m_format);
+    m_lineStarts.assign(1, m_units.bomSize);
+    m_indexing = true;
+
+    m_scanner->setLatestIndex(++m_indexId);
+    m_scannerStrand->post([scanner = m_scanner, id = m_indexId, filePath, units = m_units]
+    {
+        scanner->index(id, filePath, units);
+    });
+
+    updateScrollBars();
+    verticalScrollBar()->setValue(0);
+    horizontalScrollBar()->setValue(0);
+    viewport()->update();
+    return true;
+}
+
+void LargeFileView::closeFile()
+{
+    m_scanner->setLatestIndex(++m_indexId);
+    m_scanner->setLatestSearch(++m_searchId);
+
+    if (m_data)
+    {
+        m_file.unmap(m_data);
+        m_data = nullptr;
+    }
+    m_file.close();
+    m_size = 0;
+
+    // Gives the memory of the index back, not just its elements
+    std::vector<qint64>().swap(m_lineStarts);
+    m_indexing = false;
+    m_indexProgress = -1;
+    m_matchLine = -1;
+    m_maxLineWidth = 0;
+}
+
+int LargeFileView::lineCount() const
+{
+    // While indexing, the end of the last known line is not known yet
+    const auto known = static_cast<qint64>(m_lineStarts.size()) - (m_indexing ? 1 : 0);
+    return static_cast<int>(std::clamp<qint64>(known, 0, std::numeric_limits<int>::max()));
+}
+
+QString LargeFileView::lineText(const int line) const
+{
+    const qint64 start = m_lineStarts[line];
+    const qint64 end = line + 1 < static_cast<int>(m_lineStarts.size()) ? m_lineStarts[line + 1] : m_size;
+
+    qint64 length = std::min(end - start, MaxLineBytes);
+    length -= length % m_units.size;
+
+    QStringDecoder decoder(m_format.encoding, QStringConverter::Flag::Stateless);
+    QString text = decoder.decode(QByteArrayView(m_data + start, length));
+
+    while (text.endsWith(u'\n') || text.endsWith(u'\r'))
+    {
+        text.chop(1);
+    }
+    text.replace(u'\t', QStringLiteral("    "));
+    return text;
+}
+
+int LargeFileView::gutterWidth() const
+{
+    const int digits = static_cast<int>(QString::number(std::max(1, lineCount())).size());
+    return fontMetrics().horizontalAdvance(u'9') * digits + 16;
+}
+
+void LargeFileView::updateScrollBars()
+{
+    const int visible = visibleLines();
+    verticalScrollBar()->setRange(0, std::max(0, lineCount() - visible));
+    verticalScrollBar()->setPageStep(visible);
+    verticalScrollBar()->setSingleStep(1);
+
+    const int textWidth = viewport()->width() - gutterWidth();
+    horizontalScrollBar()->setRange(0, std::max(0, m_maxLineWidth - textWidth));
+    horizontalScrollBar()->setPageStep(textWidth);
+    horizontalScrollBar()->setSingleStep(fontMetrics().horizontalAdvance(u'9'));
+}
+
+void LargeFileView::paintEvent(QPaintEvent*)
+{
+    QPainter painter(viewport());
+    painter.fillRect(viewport()->rect(), palette().base());
+    if (!m_data)
+    {
+        return;
+    }
+
+    const QFontMetrics metrics = fontMetrics();
+    const int height = lineHeight();
+    const int gutter = gutterWidth();
+    const int width = viewport()->width();
+    const int first = verticalScrollBar()->value();
+    const int last = std::min(lineCount(), first + viewport()->height() / height + 1);
+
+    QColor matchColor = palette().color(QPalette::Highlight);
+    matchColor.setAlpha(80);
+
+    int widest = m_maxLineWidth;
+    for (int line = first; line < last; ++line)
+    {
+        const int y = (line - first) * height;
+        if (line == m_matchLine)
+        {
+            painter.fillRect(QRect(0, y, width, height), matchColor);
+        }
+
+        painter.setPen(palette().color(QPalette::PlaceholderText));
+        painter.drawText(QRect(0, y, gutter - 8, height), Qt::AlignRight | Qt::AlignVCenter,
+                         QString::number(line + 1));
+
+        const QString text = lineText(line);
+        widest = std::max(widest, metrics.horizontalAdvance(text));
+
+        painter.save();
+        painter.setClipRect(QRect(gutter, y, width - gutter, height));
+        painter.setPen(palette().color(QPalette::Text));
+        painter.drawText(gutter - horizontalScrollBar()->value(), y + metrics.ascent(), text);
+        painter.restore();
+    }
+
+    if (widest > m_maxLineWidth)
+    {
+        // The scroll range grows as wider lines are shown, changing it while painting is not allowed
+        m_maxLineWidth = widest;
+        QMetaObject::invokeMethod(this, [this] { updateScrollBars(); }, Qt::QueuedConnection);
+    }
+}
+
+void LargeFileView::resizeEvent(QResizeEvent* event)
+{
+    QAbstractScrollArea::resizeEvent(event);
+    updateScrollBars();
+}
+
+void LargeFileView::scrollContentsBy(int, int)
+{
+    viewport()->update();
+}
+
+void LargeFileView::keyPressEvent(QKeyEvent* event)
+{
+    if (event->matches(QKeySequence::Find))
+    {
+        if (const QString text = QInputDialog::getText(this, "Find", "Find:", QLineEdit::Normal, m_searchText);
+            !text.isEmpty())
+        {
+            find(text);
+        }
+        return;
+    }
+
+    if (event->matches(QKeySequence::FindNext))
+    {
+        findNext();
+        return;
+    }
+
+    if (event->key() == Qt::Key_G && event->modifiers() & Qt::ControlModifier)
+    {
+        bool ok = false;
+        const int line = QInputDialog::getInt(this, "Go to Line", "Line:", verticalScrollBar()->value() + 1, 1,
+                                              std::max(1, lineCount()), 1, &ok);
+        if (ok)
+        {
+            goToLine(line - 1);
+        }
+        return;
+    }
+
+    if (event->matches(QKeySequence::MoveToStartOfDocument))
+    {
+        verticalScrollBar()->triggerAction(QAbstractSlider::SliderToMinimum);
+        return;
+    }
+
+    if (event->matches(QKeySequence::MoveToEndOfDocument))
+    {
+        verticalScrollBar()->triggerAction(QAbstractSlider::SliderToMaximum);
+        return;
+    }
+
+    // Arrow keys and page up/down scroll
+    QAbstractScrollArea::keyPressEvent(event);
+}
+
+void LargeFileView::goToLine(const int line)
+{
+    if (lineCount() == 0)
+    {
+        return;
+    }
+
+    if (line >= lineCount() && m_indexing)
+    {
+        emit statusUpdate("Line " + QString::number(line + 1) + " was not indexed yet.", 5000);
+    }
+
+    m_matchLine = std::clamp(line, 0, lineCount() - 1);
+    verticalScrollBar()->setValue(m_matchLine - visibleLines() / 2);
+    viewport()->update();
+}
+
+void LargeFileView::find(const QString& text)
+{
+    m_searchText = text;
+    m_matchLine = -1;
+    findNext();
+}
+
+void LargeFileView::findNext()
+{
+    if (m_searchText.isEmpty() || !m_data)
+    {
+        return;
+    }
+
+    // Continues after the current match, or from the top of the viewport
+    const int fromLine = m_matchLine >= 0 ? m_matchLine + 1 : verticalScrollBar()->value();
+    const qint64 from = fromLine < static_cast<int>(m_lineStarts.size()) ? m_lineStarts[fromLine] : m_units.bomSize;
+
+    // Matched against the raw bytes, so the text is encoded like the file
+    QStringEncoder encoder(m_format.encoding, QStringConverter::Flag::Stateless);
+    const QByteArray needle = encoder.encode(m_searchText);
+
+    m_scanner->setLatestSearch(++m_searchId);
+    m_scannerStrand->post([scanner = m_scanner, id = m_searchId, filePath = m_file.fileName(), needle, from,
+            units = m_units]
+    {
+        scanner->find(id, filePath, needle, from, units);
+    });
+    emit statusUpdate("Searching for " + m_searchText + "..", 5000);
+}
+
+void LargeFileView::onLinesIndexed(const quint64 id, const QList<qint64>& lineStarts, const qint64 bytesScanned)
+{
+    if (id != m_indexId)
+    {
+        return;
+    }
+
+    const int first = verticalScrollBar()->value();
+    const bool showsNewLines = lineCount() < first + visibleLines();
+
+    m_lineStarts.insert(m_lineStarts.end(), lineStarts.begin(), lineStarts.end());
+    updateScrollBars();
+
+    if (showsNewLines)
+    {
+        viewport()->update();
+    }
+
+    if (const int progress = static_cast<int>(bytesScanned * 100 / std::max<qint64>(1, m_size));
+        progress != m_indexProgress)
+    {
+        m_indexProgress = progress;
+        emit statusUpdate(QString("Indexing %1%").arg(progress), 2000);
+    }
+}
+
+void LargeFileView::onIndexFinished(const quint64 id)
+{
+    if (id != m_indexId)
+    {
+        return;
+    }
+
+    m_indexing = false;
+    updateScrollBars();
+    viewport()->update();
+
+    emit statusUpdate(QString("%1 lines, read only.").arg(lineCount()), 5000);
+}
+
+void LargeFileView::onFound(const quint64 id, const qint64 offset)
+{
+    if (id != m_searchId)
+    {
+        return;
+    }
+
+    if (offset < 0)
+    {
+        emit statusUpdate("No match for " + m_searchText, 5000);
+        return;
+    }
+
+    // The line starting at or before offset
+    const auto next = std::upper_bound(m_lineStarts.begin(), m_lineStarts.end(), offset);
+    const int line = static_cast<int>(next - m_lineStarts.begin()) - 1;
+    goToLine(line);
+
+    emit statusUpdate(QString("Found at line %1").arg(line + 1), 5000);
+}
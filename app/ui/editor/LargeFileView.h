@@ -0,0 +1,170 @@
+//
+// Created by talik on 10/18/2026.
+//
+
+#ifndef LARGE_FILE_VIEW_H
+#define LARGE_FILE_VIEW_H
+
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <vector>
+#include <QAbstractScrollArea>
+#include <QFile>
+#include <QList>
+#include <QObject>
+#include <QString>
+
+#include "FileFormat.h"
+
+class TaskStrand;
+
+// Byte layout of the text in a file, as needed to find line breaks without decoding it
+struct CodeUnits
+{
+    int size = 1;
+    bool bigEndian = false;
+    // Bytes taken by the BOM at the start of the file
+    int bomSize = 0;
+
+    static CodeUnits of(const FileFormat& format);
+};
+
+Q_DECLARE_METATYPE(CodeUnits)
+
+// Scans a mapped file for LargeFileView on a worker thread.
+class LargeFileScanner final : public QObject
+{
+    Q_OBJECT
+
+signals:
+    // Byte offsets of the lines that start after the previous batch
+    void linesIndexed(quint64 id, const QList<qint64>& lineStarts, qint64 bytesScanned);
+
+    void indexFinished(quint64 id);
+
+    // offset is -1 if needle was not found
+    void found(quint64 id, qint64 offset);
+
+public slots:
+    void index(quint64 id, const QString& filePath, const CodeUnits& units);
+
+    // Searches from byte offset from to the end of the file, then from the start
+    void find(quint64 id, const QString& filePath, const QByteArray& needle, qint64 from, const CodeUnits& units);
+
+public:
+    explicit LargeFileScanner(QObject* parent = nullptr) : QObject(parent) {}
+
+    ~LargeFileScanner() override = default;
+
+    /**
+     * Mark every index or find job older than id as cancelled. Thread safe.
+     * A cancelled job stops at its next batch.
+     */
+    void setLatestIndex(quint64 id) { m_latestIndex.store(id, std::memory_order_relaxed); }
+
+    void setLatestSearch(quint64 id) { m_latestSearch.store(id, std::memory_order_relaxed); }
+
+private:
+    static constexpr int LinesPerBatch = 64 * 1024;
+    static constexpr qint64 SearchWindow = 16 * 1024 * 1024;
+
+    std::atomic<quint64> m_latestIndex{0};
+    std::atomic<quint64> m_latestSearch{0};
+};
+
+/**
+ * Read-only view for files too large for QPlainTextEdit.
+ *
+ * The file stays memory mapped; only an index of line start offsets is kept in
+ * memory, so memory use grows with the line count and not with the file size.
+ * The index is built on a worker thread while the top of the file is already
+ * shown, and only the lines in the viewport are decoded, on every paint.
+ *
+ * Ctrl+G goes to a line, Ctrl+F searches and F3 finds the next match. Searches
+ * run on the same worker, after the index is complete.
+ */
+class LargeFileView final : public QAbstractScrollArea
+{
+    Q_OBJECT
+
+signals:
+    void statusUpdate(QString status, int timeout = 10000);
+
+public:
+    // Files at least this large are opened in this view instead of the editor
+    static constexpr qint64 Threshold = 64 * 1024 * 1024;
+
+    explicit LargeFileView(QWidget* parent = nullptr);
+
+    ~LargeFileView() override;
+
+    // Shows filePath, reporting failures through statusUpdate
+    bool openFile(const QString& filePath);
+
+    // Unmaps the file and drops its index
+    void closeFile();
+
+    // line is 0 based
+    void goToLine(int line);
+
+    void find(const QString& text);
+
+protected:
+    void paintEvent(QPaintEvent* event) override;
+
+    void resizeEvent(QResizeEvent* event) override;
+
+    void keyPressEvent(QKeyEvent* event) override;
+
+    void scrollContentsBy(int dx, int dy) override;
+
+private slots:
+    void onLinesIndexed(quint64 id, const QList<qint64>& lineStarts, qint64 bytesScanned);
+
+    void onIndexFinished(quint64 id);
+
+    void onFound(quint64 id, qint64 offset);
+
+private:
+    // Longer lines are cut off when painted
+    static constexpr qint64 MaxLineBytes = 64 * 1024;
+
+    QFile m_file;
+    uchar* m_data = nullptr;
+    qint64 m_size = 0;
+    FileFormat m_format;
+    CodeUnits m_units;
+
+    std::vector<qint64> m_lineStarts;
+    bool m_indexing = false;
+    int m_indexProgress = -1;
+
+    QString m_searchText;
+    int m_matchLine = -1;
+    int m_maxLineWidth = 0;
+
+    // Identify the latest jobs given to m_scanner
+    quint64 m_indexId = 0;
+    quint64 m_searchId = 0;
+    // Scans on the task pool, one job after the other
+    std::unique_ptr<TaskStrand> m_scannerStrand;
+    LargeFileScanner* m_scanner;
+
+    // Number of lines whose end is known
+    [[nodiscard]] int lineCount() const;
+
+    [[nodiscard]] QString lineText(int line) const;
+
+    [[nodiscard]] int lineHeight() const { return fontMetrics().height(); }
+
+    [[nodiscard]] int visibleLines() const { return std::max(1, viewport()->height() / lineHeight()); }
+
+    [[nodiscard]] int gutterWidth() const;
+
+    void updateScrollBars();
+
+    void findNext();
+};
+
+#endif //LARGE_FILE_VIEW_H
@@ -3,69 +3,105 @@
 //
 
 #include "LineNumberAreaWidget.h"
+#include <QEvent>
 #include <QPainter>
 #include <QPalette> // For theme colors
 
 LineNumberAreaWidget::LineNumberAreaWidget(QWidget *parent) : QWidget(parent) {
 	// It's good to set an initial size policy or minimum width
 	setMinimumWidth(5);
+
+	cacheDigits();
 }
 
 void LineNumberAreaWidget::updateEditorState(const buraq::EditorState &state) {
-	if (m_editorState != state) { // Basic check to avoid unnecessary updates
-		m_editorState = state;
+	if (m_editorState.revision == state.revision) { // Basic check to avoid unnecessary updates
+		return;
+	}
+
+	const buraq::EditorState previous = m_editorState;
+	m_editorState = state;
+
+	if (!previous.hasSameGeometry(state)) {
 		update(); // This is KEY: it schedules a call to paintEvent()
+		return;
+	}
+
+	// Only the cursor or the selection moved, repaint the lines they leave and enter
+	update(highlightedRect(previous));
+	update(highlightedRect(state));
+}
+
+QRect LineNumberAreaWidget::highlightedRect(const buraq::EditorState &state) const {
+	const int first = state.hasSelection() ? state.selectionFirstBlock : state.cursorBlockNumber;
+	const int last = state.hasSelection() ? state.selectionLastBlock : state.cursorBlockNumber;
+	const int lineHeight = std::max(19, state.lineHeight);
+
+	const int top = state.firstVisibleBlockTop + (first - state.firstVisibleBlock) * lineHeight;
+	return QRect(0, top, width(), (last - first + 1) * lineHeight).intersected(rect());
+}
+
+void LineNumberAreaWidget::changeEvent(QEvent *event) {
+	if (event->type() == QEvent::FontChange) {
+		cacheDigits();
+	}
+	QWidget::changeEvent(event);
+}
+
+void LineNumberAreaWidget::cacheDigits() {
+	m_digitWidth = 0;
+	for (int digit = 0; digit < 10; ++digit) {
+		QStaticText &text = m_digits[digit];
+		text.setText(QString(QChar(u'0' + digit)));
+		text.setTextFormat(Qt::PlainText);
+		text.setPerformanceHint(QStaticText::AggressiveCaching);
+		text.prepare(QTransform(), font());
+
+		m_digitWidth = std::max(m_digitWidth, text.size().width());
 	}
 }
 
 void LineNumberAreaWidget::paintEvent(QPaintEvent *event) {
-	Q_UNUSED(event); // We are redrawing the whole thing based on m_editorState
+	Q_UNUSED(event); // Lines outside of the update region are clipped by the painter
 
 	// Create a QPainter that is active for THIS widget.
 	// It automatically begins and ends.
 	QPainter painter(this);
+	painter.setPen(palette().color(QPalette::Light)); // Use a color from the widget's palette
 
 	// Use this widget's fontMetrics
 	const int lineHeight =  std::max(19, m_editorState.lineHeight);
+	const qreal textTop = (lineHeight - fontMetrics().height()) / 2.0;
+	constexpr int textPaddingLeft = 4;
 
-	int currentY = 0; // Start Y position from the top. Add padding if needed.
+	const bool hasSelection = m_editorState.hasSelection();
 
-	// Loop to draw line numbers.
-	for (int block_num_to_display = 1; block_num_to_display <= m_editorState.blockCount; ++block_num_to_display) {
-		QRect lineAreaRect(0, currentY, width(), lineHeight); // Use this widget's width()
-
-		if (currentY >= height()) { // Use this widget's height()
-			break; // Stop if drawing outside the widget's visible area
-		}
+	// Only the blocks the editor shows are painted, starting where the first of them is drawn.
+	// The cost depends on the height of the widget, not on the length of the document.
+	int currentY = m_editorState.firstVisibleBlockTop;
+	for (int block = std::max(0, m_editorState.firstVisibleBlock);
+		 block < m_editorState.blockCount && currentY < height(); ++block, currentY += lineHeight) {
+		const QRect lineAreaRect(0, currentY, width(), lineHeight); // Use this widget's width()
 
 		// Highlight the active line
-		// Ensure m_editorState.cursorBlockNumber is 0-indexed if comparing with (block_num_to_display - 1)
-		if (m_editorState.isSelected) {
-			auto it = std::find(
-					m_editorState.selectedBlockNumbers.begin(),
-					m_editorState.selectedBlockNumbers.end(),
-					(block_num_to_display - 1)
-			);
-
-			if (it != m_editorState.selectedBlockNumbers.end()) {
-				// value is found.
+		if (hasSelection) {
+			if (block >= m_editorState.selectionFirstBlock && block <= m_editorState.selectionLastBlock) {
 				painter.fillRect(lineAreaRect, QColor(Qt::cyan).lighter(25));
-			} else {
-				// ignore
 			}
-		} else if (m_editorState.cursorBlockNumber == (block_num_to_display - 1)) {
+		} else if (m_editorState.cursorBlockNumber == block) {
 			painter.fillRect(lineAreaRect, QColor(Qt::lightGray).lighter(25));
 		}
 
-		QString numberText = QString::number(block_num_to_display);
-		int textPaddingLeft = 4;
-		QRect textDrawingRect = lineAreaRect;
-		textDrawingRect.setLeft(lineAreaRect.left() + textPaddingLeft);
-
-		painter.setPen(palette().color(QPalette::Light)); // Use a color from the widget's palette
-		painter.drawText(textDrawingRect, Qt::AlignLeft | Qt::AlignVCenter, numberText);
+		// Digits of the 1 based line number, least significant first
+		std::array<int, 10> digits{};
+		int count = 0;
+		for (int number = block + 1; number > 0; number /= 10) {
+			digits[count++] = number % 10;
+		}
 
-		currentY += lineHeight;
+		qreal x = textPaddingLeft;
+		for (int i = count - 1; i >= 0; --i, x += m_digitWidth) {
+			painter.drawStaticText(QPointF(x, currentY + textTop), m_digits[digits[i]]);
+		}
 	}
-	// qDebug() << "LineNumberAreaWidget::paintEvent finished.";
 }
@@ -5,8 +5,10 @@
 #ifndef LINE_NUMBER_AREA_WIDGET_H
 #define LINE_NUMBER_AREA_WIDGET_H
 
+#include <array>
 #include <QWidget>
 #include <QFontMetrics> // For calculating text sizes
+#include <QStaticText>
 #include "buraq.h"
 
 class LineNumberAreaWidget final : public QWidget {
@@ -21,8 +23,19 @@ public:
 protected:
 	void paintEvent(QPaintEvent *event) override;
 
+	void changeEvent(QEvent *event) override;
+
 private:
 	buraq::EditorState m_editorState{.lineHeight = 19};
+
+	// Laid out once per font, line numbers are drawn digit by digit from these
+	std::array<QStaticText, 10> m_digits;
+	qreal m_digitWidth = 0;
+
+	void cacheDigits();
+
+	// Lines highlighted for the cursor or the selection of state
+	[[nodiscard]] QRect highlightedRect(const buraq::EditorState &state) const;
 // You might want to store font, colors, etc., as members
 // or get them from the parent EditorMargin if needed.
 };
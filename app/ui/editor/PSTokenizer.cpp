@@ -0,0 +1,661 @@
+//
+// Created by talik on 10/18/2026.
+//
+
+#include "PSTokenizer.h"
+
+#include <algorithm>
+#include <array>
+#include <QLatin1String>
+
+namespace pslang
+{
+    namespace
+    {
+        enum Mode
+        {
+            Code = 0,
+            BlockComment,
+            DoubleString,
+            SingleString,
+            HereDouble,
+            HereSingle,
+        };
+
+        // Layout of a packed LexState:
+        //   bits 0-2  current Mode
+        //   bits 3-5  number of open $( ) subexpressions
+        //   bits 6+   4 bits per open subexpression, innermost last:
+        //             bit 0     the subexpression was opened inside a here-string
+        //             bits 1-3  parentheses still open inside the subexpression
+        constexpr int ModeBits = 3;
+        constexpr int DepthBits = 3;
+        constexpr int FrameBits = 4;
+        constexpr int FrameShift = ModeBits + DepthBits;
+        constexpr int MaxDepth = 6;
+        constexpr int MaxParens = 7;
+
+        enum CharClass : quint8
+        {
+            Other,
+            Space,
+            Letter,
+            Digit,
+            Dash,
+            Dollar,
+            Hash,
+            Less,
+            At,
+            DoubleQuote,
+            SingleQuote,
+            Backtick,
+            OpenParen,
+            CloseParen,
+        };
+
+        // Character classes for the ASCII range; everything else is classified on the fly.
+        constexpr std::array<CharClass, 128> asciiClasses = []
+        {
+            std::array<CharClass, 128> table{};
+            for (char c = 'a'; c <= 'z'; ++c) table[c] = Letter;
+            for (char c = 'A'; c <= 'Z'; ++c) table[c] = Letter;
+            for (char c = '0'; c <= '9'; ++c) table[c] = Digit;
+            table['_'] = Letter;
+            table[' '] = Space;
+            table['\t'] = Space;
+            table['\r'] = Space;
+            table['\f'] = Space;
+            table['-'] = Dash;
+            table['$'] = Dollar;
+            table['#'] = Hash;
+            table['<'] = Less;
+            table['@'] = At;
+            table['"'] = DoubleQuote;
+            table['\''] = SingleQuote;
+            table['`'] = Backtick;
+            table['('] = OpenParen;
+            table[')'] = CloseParen;
+            return table;
+        }();
+
+        // Sorted, lower case. Looked up with a case-insensitive binary search.
+        constexpr std::array<QLatin1String, 34> keywords = {
+            QLatin1String("begin"), QLatin1String("break"), QLatin1String("catch"), QLatin1String("class"),
+            QLatin1String("clean"), QLatin1String("continue"), QLatin1String("data"), QLatin1String("default"),
+            QLatin1String("do"), QLatin1String("dynamicparam"), QLatin1String("else"), QLatin1String("elseif"),
+            QLatin1String("end"), QLatin1String("enum"), QLatin1String("exit"), QLatin1String("filter"),
+            QLatin1String("finally"), QLatin1String("for"), QLatin1String("foreach"), QLatin1String("function"),
+            QLatin1String("hidden"), QLatin1String("if"), QLatin1String("in"), QLatin1String("param"),
+            QLatin1String("process"), QLatin1String("return"), QLatin1String("static"), QLatin1String("switch"),
+            QLatin1String("throw"), QLatin1String("trap"), QLatin1String("try"), QLatin1String("until"),
+            QLatin1String("using"), QLatin1String("while"),
+        };
+
+        // Common aliases that do not follow the Verb-Noun naming. Sorted, lower case.
+        constexpr std::array<QLatin1String, 31> aliases = {
+            QLatin1String("cat"), QLatin1String("cd"), QLatin1String("cls"), QLatin1String("copy"),
+            QLatin1String("cp"), QLatin1String("del"), QLatin1String("dir"), QLatin1String("echo"),
+            QLatin1String("gci"), QLatin1String("gcm"), QLatin1String("gm"), QLatin1String("gps"),
+            QLatin1String("iex"), QLatin1String("iwr"), QLatin1String("kill"), QLatin1String("ls"),
+            QLatin1String("man"), QLatin1String("mkdir"), QLatin1String("move"), QLatin1String("mv"),
+            QLatin1String("ps"), QLatin1String("pwd"), QLatin1String("rm"), QLatin1String("rmdir"),
+            QLatin1String("select"), QLatin1String("sleep"), QLatin1String("sort"), QLatin1String("tee"),
+            QLatin1String("type"), QLatin1String("where"), QLatin1String("write"),
+        };
+
+        template <std::size_t N>
+        bool contains(const std::array<QLatin1String, N>& table, const QStringView word)
+        {
+            const auto it = std::lower_bound(table.begin(), table.end(), word,
+                                             [](const QLatin1String entry, const QStringView value)
+                                             {
+                                                 return value.compare(entry, Qt::CaseInsensitive) > 0;
+                                             });
+            return it != table.end() && word.compare(*it, Qt::CaseInsensitive) == 0;
+        }
+
+        // PowerShell also accepts typographic quotes, which show up in scripts pasted from documents.
+        bool isDoubleQuote(const QChar c)
+        {
+            const char16_t u = c.unicode();
+            return u == u'"' || u == u'“' || u == u'”' || u == u'„';
+        }
+
+        bool isSingleQuote(const QChar c)
+        {
+            const char16_t u = c.unicode();
+            return u == u'\'' || u == u'‘' || u == u'’' || u == u'‚' || u == u'‛';
+        }
+
+        CharClass classify(const QChar c)
+        {
+            if (const char16_t u = c.unicode(); u < asciiClasses.size())
+            {
+                return asciiClasses[u];
+            }
+            if (c.isLetter()) return Letter;
+            if (c.isSpace()) return Space;
+            if (isDoubleQuote(c)) return DoubleQuote;
+            if (isSingleQuote(c)) return SingleQuote;
+            return Other;
+        }
+
+        bool isHexDigit(const QChar c)
+        {
+            const char16_t u = c.unicode();
+            return (u >= u'0' && u <= u'9') || (u >= u'a' && u <= u'f') || (u >= u'A' && u <= u'F');
+        }
+
+        bool isIdentifierChar(const QChar c)
+        {
+            const CharClass cls = classify(c);
+            return cls == Letter || cls == Digit;
+        }
+
+        class Lexer
+        {
+        public:
+            Lexer(const QStringView line, const LexState state, std::vector<Token>& tokens)
+                : m_line(line), m_size(static_cast<int>(line.size())), m_tokens(tokens)
+            {
+                unpack(state);
+            }
+
+            LexState run()
+            {
+                while (m_pos < m_size)
+                {
+                    switch (m_mode)
+                    {
+                    case Code:
+                        lexCode();
+                        break;
+                    case BlockComment:
+                        lexBlockComment();
+                        break;
+                    case DoubleString:
+                        lexExpandable(false);
+                        break;
+                    case HereDouble:
+                        lexExpandable(true);
+                        break;
+                    case SingleString:
+                        lexVerbatim(false);
+                        break;
+                    case HereSingle:
+                        lexVerbatim(true);
+                        break;
+                    }
+                }
+
+                // A string or comment opened at the very end of the line
+                if (m_pending >= 0)
+                {
+                    push(m_pending, m_size - m_pending,
+                         m_mode == BlockComment ? TokenKind::Comment : TokenKind::String);
+                }
+                return pack();
+            }
+
+        private:
+            struct Frame
+            {
+                bool here;
+                int parens;
+            };
+
+            QStringView m_line;
+            int m_size;
+            int m_pos = 0;
+            // Start of a token opened by lexCode() and finished by another mode, -1 if none.
+            int m_pending = -1;
+            int m_mode = Code;
+            int m_depth = 0;
+            std::array<Frame, MaxDepth> m_frames{};
+            std::vector<Token>& m_tokens;
+
+            void unpack(const LexState state)
+            {
+                m_mode = state & ((1 << ModeBits) - 1);
+                m_depth = std::min((state >> ModeBits) & ((1 << DepthBits) - 1), MaxDepth);
+                for (int i = 0; i < m_depth; ++i)
+                {
+                    const int frame = (state >> (FrameShift + i * FrameBits)) & ((1 << FrameBits) - 1);
+                    m_frames[i] = {.here = (frame & 1) != 0, .parens = frame >> 1};
+                }
+            }
+
+            [[nodiscard]] LexState pack() const
+            {
+                LexState state = m_mode | (m_depth << ModeBits);
+                for (int i = 0; i < m_depth; ++i)
+                {
+                    const int frame = (m_frames[i].here ? 1 : 0) | (m_frames[i].parens << 1);
+                    state |= frame << (FrameShift + i * FrameBits);
+                }
+                return state;
+            }
+
+            void push(const int offset, const int length, const TokenKind kind) const
+            {
+                if (length > 0)
+                {
+                    m_tokens.push_back({.offset = offset, .length = length, .kind = kind});
+                }
+            }
+
+            [[nodiscard]] QChar at(const int pos) const
+            {
+                return pos < m_size ? m_line[pos] : QChar();
+            }
+
+            int takePending()
+            {
+                const int start = m_pending >= 0 ? m_pending : m_pos;
+                m_pending = -1;
+                return start;
+            }
+
+            // A here-string header (@" or @') must be the last thing on its line.
+            [[nodiscard]] bool restIsBlank(const int from) const
+            {
+                for (int i = from; i < m_size; ++i)
+                {
+                    if (classify(m_line[i]) != Space) return false;
+                }
+                return true;
+            }
+
+            // Length of the variable reference starting at the '$' at pos, 0 if it is not one.
+            [[nodiscard]] int variableLength(const int pos) const
+            {
+                const QChar next = at(pos + 1);
+                if (next == u'{')
+                {
+                    const qsizetype close = m_line.indexOf(u'}', pos + 2);
+                    return close < 0 ? m_size - pos : static_cast<int>(close) - pos + 1;
+                }
+                if (next == u'$' || next == u'?' || next == u'^')
+                {
+                    return 2;
+                }
+
+                int end = pos + 1;
+                while (end < m_size && isIdentifierChar(m_line[end])) ++end;
+
+                // Scope or drive qualifier, e.g. $env:PATH or $script:count
+                if (end > pos + 1 && at(end) == u':' && at(end + 1) != u':' && isIdentifierChar(at(end + 1)))
+                {
+                    ++end;
+                    while (end < m_size && isIdentifierChar(m_line[end])) ++end;
+                }
+                return end - pos - 1 > 0 ? end - pos : 0;
+            }
+
+            [[nodiscard]] int numberLength(const int pos) const
+            {
+                int end = pos;
+                if (at(pos) == u'0' && (at(pos + 1) == u'x' || at(pos + 1) == u'X'))
+                {
+                    end += 2;
+                    while (end < m_size && isHexDigit(m_line[end])) ++end;
+                }
+                else
+                {
+                    while (end < m_size && m_line[end].isDigit()) ++end;
+                    if (at(end) == u'.' && at(end + 1).isDigit())
+                    {
+                        ++end;
+                        while (end < m_size && m_line[end].isDigit()) ++end;
+                    }
+                    if ((at(end) == u'e' || at(end) == u'E') &&
+                        (at(end + 1).isDigit() || ((at(end + 1) == u'-' || at(end + 1) == u'+') && at(end + 2).isDigit())))
+                    {
+                        end += 2;
+                        while (end < m_size && m_line[end].isDigit()) ++end;
+                    }
+                }
+
+                // Type suffix (1l, 1d) or multiplier suffix (10kb, 2GB)
+                int suffix = end;
+                while (suffix < m_size && m_line[suffix].isLetter() && suffix - end < 2) ++suffix;
+                if (const QStringView tail = m_line.sliced(end, suffix - end);
+                    tail.size() == 2 && tail.at(1).toLower() == u'b' && QStringView(u"kmgtp").contains(tail.at(0).toLower()))
+                {
+                    end = suffix;
+                }
+                else if (tail.size() >= 1 && (tail.at(0).toLower() == u'l' || tail.at(0).toLower() == u'd') &&
+                    !isIdentifierChar(at(end + 1)))
+                {
+                    end += 1;
+                }
+                return end - pos;
+            }
+
+            void lexCode()
+            {
+                const int start = m_pos;
+                const QChar c = m_line[m_pos];
+
+                switch (classify(c))
+                {
+                case Space:
+                case Other:
+                    ++m_pos;
+                    return;
+
+                case Hash:
+                    push(start, m_size - start, TokenKind::Comment);
+                    m_pos = m_size;
+                    return;
+
+                case Less:
+                    if (at(m_pos + 1) == u'#')
+                    {
+                        m_pending = start;
+                        m_pos += 2;
+                        m_mode = BlockComment;
+                        return;
+                    }
+                    ++m_pos;
+                    return;
+
+                case DoubleQuote:
+                    m_pending = start;
+                    ++m_pos;
+                    m_mode = DoubleString;
+                    return;
+
+                case SingleQuote:
+                    m_pending = start;
+                    ++m_pos;
+                    m_mode = SingleString;
+                    return;
+
+                case At:
+                    if ((isDoubleQuote(at(m_pos + 1)) || isSingleQuote(at(m_pos + 1))) && restIsBlank(m_pos + 2))
+                    {
+                        push(start, 2, TokenKind::String);
+                        m_mode = isDoubleQuote(at(m_pos + 1)) ? HereDouble : HereSingle;
+                        m_pos = m_size;
+                        return;
+                    }
+                    // Splatting, e.g. @params. @{ and @( open a hashtable or an array, whose contents are lexed as code.
+                    if (isIdentifierChar(at(m_pos + 1)))
+                    {
+                        const int length = variableLength(start);
+                        push(start, length, TokenKind::Variable);
+                        m_pos += length;
+                        return;
+                    }
+                    if (at(m_pos + 1) == u'{' || at(m_pos + 1) == u'(')
+                    {
+                        push(start, 1, TokenKind::Operator);
+                    }
+                    ++m_pos;
+                    return;
+
+                case Dollar:
+                    if (const int length = variableLength(start); length > 0)
+                    {
+                        push(start, length, TokenKind::Variable);
+                        m_pos += length;
+                        return;
+                    }
+                    if (at(m_pos + 1) == u'(')
+                    {
+                        push(start, 2, TokenKind::Operator);
+                        openParen();
+                        m_pos += 2;
+                        return;
+                    }
+                    ++m_pos;
+                    return;
+
+                case Backtick:
+                    push(start, std::min(2, m_size - start), TokenKind::Escape);
+                    m_pos = std::min(m_pos + 2, m_size);
+                    return;
+
+                case Digit:
+                    {
+                        const int length = numberLength(start);
+                        push(start, length, TokenKind::Number);
+                        m_pos += length;
+                        return;
+                    }
+
+                case Dash:
+                    if (classify(at(m_pos + 1)) == Letter)
+                    {
+                        int end = m_pos + 1;
+                        while (end < m_size && (isIdentifierChar(m_line[end]) || m_line[end] == u'-')) ++end;
+                        push(start, end - start, TokenKind::Parameter);
+                        m_pos = end;
+                        return;
+                    }
+                    ++m_pos;
+                    return;
+
+                case Letter:
+                    lexWord();
+                    return;
+
+                case OpenParen:
+                    openParen();
+                    ++m_pos;
+                    return;
+
+                case CloseParen:
+                    ++m_pos;
+                    if (m_depth > 0)
+                    {
+                        Frame& frame = m_frames[m_depth - 1];
+                        if (frame.parens > 0)
+                        {
+                            --frame.parens;
+                            return;
+                        }
+                        // End of a $( ) subexpression, back into the enclosing string
+                        push(start, 1, TokenKind::Operator);
+                        m_mode = frame.here ? HereDouble : DoubleString;
+                        --m_depth;
+                    }
+                    return;
+                }
+            }
+
+            void openParen()
+            {
+                if (m_depth > 0)
+                {
+                    Frame& frame = m_frames[m_depth - 1];
+                    frame.parens = std::min(frame.parens + 1, MaxParens);
+                }
+            }
+
+            void lexWord()
+            {
+                const int start = m_pos;
+                int end = m_pos + 1;
+                bool hasDash = false;
+                while (end < m_size)
+                {
+                    const QChar c = m_line[end];
+                    if (c == u'-' && classify(at(end + 1)) == Letter)
+                    {
+                        hasDash = true;
+                    }
+                    else if (!isIdentifierChar(c))
+                    {
+                        break;
+                    }
+                    ++end;
+                }
+                m_pos = end;
+
+                const QStringView word = m_line.sliced(start, end - start);
+                if (!hasDash && contains(keywords, word))
+                {
+                    push(start, end - start, TokenKind::Keyword);
+                }
+                else if (hasDash || contains(aliases, word))
+                {
+                    push(start, end - start, TokenKind::Command);
+                }
+            }
+
+            void lexBlockComment()
+            {
+                const int start = takePending();
+                if (const qsizetype close = m_line.indexOf(QLatin1String("#>"), m_pos); close >= 0)
+                {
+                    m_pos = static_cast<int>(close) + 2;
+                    m_mode = Code;
+                }
+                else
+                {
+                    m_pos = m_size;
+                }
+                push(start, m_pos - start, TokenKind::Comment);
+            }
+
+            // Double quoted strings and @" "@ here-strings: variables, escapes and $( ) are expanded.
+            void lexExpandable(const bool here)
+            {
+                if (here && m_pos == 0 && isDoubleQuote(at(0)) && at(1) == u'@')
+                {
+                    push(0, 2, TokenKind::String);
+                    m_pos = 2;
+                    m_mode = Code;
+                    return;
+                }
+
+                int segment = takePending();
+                while (m_pos < m_size)
+                {
+                    const QChar c = m_line[m_pos];
+                    if (c == u'`')
+                    {
+                        push(segment, m_pos - segment, TokenKind::String);
+                        const int length = std::min(2, m_size - m_pos);
+                        push(m_pos, length, TokenKind::Escape);
+                        m_pos += length;
+                        segment = m_pos;
+                    }
+                    else if (c == u'$' && at(m_pos + 1) == u'(' && m_depth < MaxDepth)
+                    {
+                        push(segment, m_pos - segment, TokenKind::String);
+                        push(m_pos, 2, TokenKind::Operator);
+                        m_frames[m_depth++] = {.here = here, .parens = 0};
+                        m_pos += 2;
+                        m_mode = Code;
+                        return;
+                    }
+                    else if (c == u'$')
+                    {
+                        if (const int length = variableLength(m_pos); length > 0)
+                        {
+                            push(segment, m_pos - segment, TokenKind::String);
+                            push(m_pos, length, TokenKind::Variable);
+                            m_pos += length;
+                            segment = m_pos;
+                        }
+                        else
+                        {
+                            ++m_pos;
+                        }
+                    }
+                    else if (!here && isDoubleQuote(c))
+                    {
+                        if (isDoubleQuote(at(m_pos + 1)))
+                        {
+                            // "" is an escaped quote
+                            m_pos += 2;
+                            continue;
+                        }
+                        ++m_pos;
+                        push(segment, m_pos - segment, TokenKind::String);
+                        m_mode = Code;
+                        return;
+                    }
+                    else
+                    {
+                        ++m_pos;
+                    }
+                }
+                push(segment, m_pos - segment, TokenKind::String);
+            }
+
+            // Single quoted strings and @' '@ here-strings: the text is taken literally.
+            void lexVerbatim(const bool here)
+            {
+                if (here)
+                {
+                    const bool terminator = m_pos == 0 && isSingleQuote(at(0)) && at(1) == u'@';
+                    push(0, terminator ? 2 : m_size, TokenKind::String);
+                    m_pos = terminator ? 2 : m_size;
+                    if (terminator) m_mode = Code;
+                    return;
+                }
+
+                const int start = takePending();
+                while (m_pos < m_size)
+                {
+                    if (isSingleQuote(m_line[m_pos]))
+                    {
+                        if (isSingleQuote(at(m_pos + 1)))
+                        {
+                            // '' is an escaped quote
+                            m_pos += 2;
+                            continue;
+                        }
+                        ++m_pos;
+                        m_mode = Code;
+                        break;
+                    }
+                    ++m_pos;
+                }
+                push(start, m_pos - start, TokenKind::String);
+            }
+        };
+    }
+
+    LexState tokenize(const QStringView line, const LexState state, std::vector<Token>& tokens)
+    {
+        tokens.clear();
+        return Lexer(line, std::max(state, InitialState), tokens).run();
+    }
+
+    LexState tokenizeLines(const QStringView text, LexState state, const bool includeLast,
+                           std::vector<Token>& tokens, QList<int>& states)
+    {
+        const qsizetype size = text.size();
+        qsizetype lineStart = 0;
+        for (qsizetype i = 0; i < size; ++i)
+        {
+            const QChar c = text.at(i);
+            if (c != u'\n' && c != u'\r' && c != QChar::ParagraphSeparator)
+            {
+                continue;
+            }
+
+            state = tokenize(text.sliced(lineStart, i - lineStart), state, tokens);
+            states.append(state);
+
+            if (c == u'\r' && i + 1 < size && text.at(i + 1) == u'\n')
+            {
+                ++i;
+            }
+            lineStart = i + 1;
+        }
+
+        if (includeLast)
+        {
+            state = tokenize(text.sliced(lineStart), state, tokens);
+            states.append(state);
+        }
+
+        return state;
+    }
+}
@@ -0,0 +1,72 @@
+//
+// Created by talik on 10/18/2026.
+//
+
+#ifndef PS_TOKENIZER_H
+#define PS_TOKENIZER_H
+
+#include <vector>
+#include <QList>
+#include <QStringView>
+
+namespace pslang
+{
+    enum class TokenKind : quint8
+    {
+        Keyword,
+        Command,
+        Variable,
+        Parameter,
+        Number,
+        String,
+        Escape,
+        Comment,
+        Operator,
+    };
+
+    struct Token
+    {
+        qint32 offset;
+        qint32 length;
+        TokenKind kind;
+    };
+
+    /**
+     * Lexer state carried from the end of one line to the start of the next.
+     *
+     * The state is packed into a non-negative int so it can be stored as the
+     * QTextBlock user state. 0 is the state at the start of a document.
+     */
+    using LexState = int;
+
+    constexpr LexState InitialState = 0;
+
+    /**
+     * Tokenizes a single line of PowerShell in one linear scan.
+     *
+     * Handles line and block comments (<# #>), single/double quoted strings,
+     * here-strings (@" "@, @' '@), backtick escapes, variables and nested
+     * $( ) subexpressions inside expandable strings. Text that needs no
+     * colouring (whitespace, identifiers, punctuation) produces no token.
+     *
+     * @param line The text of the line without its line terminator.
+     * @param state The state returned for the previous line.
+     * @param tokens Cleared and filled with the tokens of the line, in order.
+     * @return The state to pass in for the next line.
+     */
+    LexState tokenize(QStringView line, LexState state, std::vector<Token>& tokens);
+
+    /**
+     * Tokenizes every line of text, split the way QTextDocument splits blocks:
+     * \n, \r\n, \r and U+2029 all end a line.
+     *
+     * @param includeLast Whether the text after the last line break is a line
+     * of its own, or the start of a line continued in the next call.
+     * @param states The state at the end of every line is appended to it.
+     * @return The state at the end of the last line.
+     */
+    LexState tokenizeLines(QStringView text, LexState state, bool includeLast, std::vector<Token>& tokens,
+                           QList<int>& states);
+}
+
+#endif //PS_TOKENIZER_H
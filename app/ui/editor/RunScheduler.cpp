@@ -0,0 +1,242 @@
+//
+// Created by talik on 10/18/2026.
+//
+
+#include "RunScheduler.h"
+
+#include <algorithm>
+#include <chrono>
+#include <utility>
+#include <vector>
+#include <QTimer>
+
+#include "clients/PSClient/PSClient.h"
+
+RunScheduler::RunScheduler(PSClient* client, QObject* parent) : QObject(parent), m_client(client)
+{
+    connect(m_client, &PSClient::outputReceived, this, &RunScheduler::onOutput);
+    connect(m_client, &PSClient::recordsReceived, this, &RunScheduler::onRecords);
+    connect(m_client, &PSClient::errorsReceived, this, &RunScheduler::onErrors);
+    connect(m_client, &PSClient::progressReceived, this, &RunScheduler::onProgress);
+    connect(m_client, &PSClient::scriptFinished, this, &RunScheduler::onFinished);
+    connect(m_client, &PSClient::scriptFailed, this, &RunScheduler::onFailed);
+}
+
+quint64 RunScheduler::submit(const QString& title, const QString& script, const bool sticky, const int timeoutSeconds)
+{
+    const quint64 jobId = ++m_nextJobId;
+    m_jobs.emplace(jobId, Job{.title = title, .script = script, .sticky = sticky, .timeoutSeconds = timeoutSeconds});
+    m_queue.push_back(jobId);
+
+    emit jobStateChanged(jobId, JobState::Queued);
+
+    // Deferred, so the caller can set up for the job before it starts
+    QTimer::singleShot(0, this, &RunScheduler::dispatch);
+    return jobId;
+}
+
+void RunScheduler::cancel(const quint64 jobId)
+{
+    const auto it = m_jobs.find(jobId);
+    if (it == m_jobs.end())
+    {
+        return;
+    }
+
+    if (it->second.state == JobState::Queued)
+    {
+        m_queue.erase(std::ranges::find(m_queue, jobId));
+        finish(jobId, JobState::Cancelled, "The script was cancelled before it started.");
+        return;
+    }
+
+    // Ends with onFinished, unless the run completes first
+    m_client->cancelScript(it->second.requestId);
+}
+
+void RunScheduler::cancelAll()
+{
+    // Queued jobs first, so none of them starts in a slot freed by a cancelled one
+    for (const quint64 jobId : std::exchange(m_queue, {}))
+    {
+        finish(jobId, JobState::Cancelled, "The script was cancelled before it started.");
+    }
+
+    std::vector<quint64> running;
+    for (const auto& [jobId, job] : m_jobs)
+    {
+        running.push_back(jobId);
+    }
+    for (const quint64 jobId : running)
+    {
+        cancel(jobId);
+    }
+}
+
+void RunScheduler::setMaxConcurrent(const int count)
+{
+    m_maxConcurrent = std::max(1, count);
+    dispatch();
+}
+
+QString RunScheduler::title(const quint64 jobId) const
+{
+    const auto it = m_jobs.find(jobId);
+    return it == m_jobs.end() ? QString() : it->second.title;
+}
+
+void RunScheduler::dispatch()
+{
+    while (m_running < m_maxConcurrent && !m_queue.empty())
+    {
+        const quint64 jobId = m_queue.front();
+        m_queue.pop_front();
+        start(jobId, m_jobs.at(jobId));
+    }
+}
+
+void RunScheduler::start(const quint64 jobId, Job& job)
+{
+    ++m_running;
+    job.state = JobState::Running;
+    job.requestId = m_client->runScript(job.script, job.sticky);
+    m_jobByRequest.insert(job.requestId, jobId);
+
+    // Not needed once sent
+    job.script.clear();
+
+    if (job.timeoutSeconds > 0)
+    {
+        QTimer::singleShot(std::chrono::seconds(job.timeoutSeconds), this, [this, jobId] { timeOut(jobId); });
+    }
+
+    emit jobStateChanged(jobId, JobState::Running);
+}
+
+void RunScheduler::timeOut(const quint64 jobId)
+{
+    const auto it = m_jobs.find(jobId);
+    if (it == m_jobs.end() || it->second.state != JobState::Running)
+    {
+        return;
+    }
+
+    it->second.timedOut = true;
+    m_client->cancelScript(it->second.requestId);
+}
+
+void RunScheduler::onOutput(const quint64 requestId, const bridge::OutputStream stream, const QString& text)
+{
+    const auto jobId = m_jobByRequest.constFind(requestId);
+    if (jobId == m_jobByRequest.constEnd())
+    {
+        return;
+    }
+
+    if (stream == bridge::OutputStream::Error)
+    {
+        m_jobs.at(*jobId).hadErrors = true;
+    }
+
+    emit jobOutput(*jobId, stream, text);
+}
+
+void RunScheduler::onRecords(const quint64 requestId, const bridge::RecordBatch& batch)
+{
+    const auto jobId = m_jobByRequest.constFind(requestId);
+    if (jobId == m_jobByRequest.constEnd())
+    {
+        return;
+    }
+
+    emit jobRecords(*jobId, batch);
+
+    // Format-List style, with a blank line between objects
+    QString text;
+    bridge::RecordReader reader(batch);
+    while (reader.next())
+    {
+        text += reader.toText() + '\n';
+    }
+    emit jobOutput(*jobId, bridge::OutputStream::Output, text);
+}
+
+void RunScheduler::onErrors(const quint64 requestId, const QList<bridge::ErrorDetails>& errors)
+{
+    const auto jobId = m_jobByRequest.constFind(requestId);
+    if (jobId == m_jobByRequest.constEnd())
+    {
+        return;
+    }
+
+    // Only records the script wrote to its error stream fail the job, whatever the output says
+    m_jobs.at(*jobId).hadErrors = true;
+
+    QString text;
+    for (const bridge::ErrorDetails& error : errors)
+    {
+        text += error.toText();
+    }
+    emit jobOutput(*jobId, bridge::OutputStream::Error, text);
+}
+
+void RunScheduler::onProgress(const quint64 requestId, const int percent, const QString& activity)
+{
+    if (const auto jobId = m_jobByRequest.constFind(requestId); jobId != m_jobByRequest.constEnd())
+    {
+        emit jobProgress(*jobId, percent, activity);
+    }
+}
+
+void RunScheduler::onFinished(const quint64 requestId, const bridge::RunStatus status, const QString& message)
+{
+    const auto jobId = m_jobByRequest.constFind(requestId);
+    if (jobId == m_jobByRequest.constEnd())
+    {
+        return;
+    }
+
+    const Job& job = m_jobs.at(*jobId);
+    if (status == bridge::RunStatus::Cancelled)
+    {
+        finish(*jobId, JobState::Cancelled,
+               job.timedOut ? "The script ran past its timeout and was stopped." : message);
+    }
+    else if (status == bridge::RunStatus::Succeeded && !job.hadErrors)
+    {
+        finish(*jobId, JobState::Succeeded, message);
+    }
+    else
+    {
+        finish(*jobId, JobState::Failed, message);
+    }
+}
+
+void RunScheduler::onFailed(const quint64 requestId, const QString& error)
+{
+    if (const auto jobId = m_jobByRequest.constFind(requestId); jobId != m_jobByRequest.constEnd())
+    {
+        finish(*jobId, JobState::Failed, error);
+    }
+}
+
+void RunScheduler::finish(const quint64 jobId, const JobState state, const QString& message)
+{
+    const auto it = m_jobs.find(jobId);
+    if (it == m_jobs.end())
+    {
+        return;
+    }
+
+    if (it->second.state == JobState::Running)
+    {
+        --m_running;
+        m_jobByRequest.remove(it->second.requestId);
+    }
+    m_jobs.erase(it);
+
+    emit jobStateChanged(jobId, state);
+    emit jobFinished(jobId, state, message);
+
+    dispatch();
+}
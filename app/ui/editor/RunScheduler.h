@@ -0,0 +1,128 @@
+//
+// Created by talik on 10/18/2026.
+//
+
+#ifndef RUN_SCHEDULER_H
+#define RUN_SCHEDULER_H
+
+#include <deque>
+#include <map>
+#include <QHash>
+#include <QObject>
+#include <QString>
+
+#include "clients/PSClient/BridgeProtocol.h"
+#include "clients/PSClient/RecordReader.h"
+
+class PSClient;
+
+/**
+ * Queues script runs and starts at most maxConcurrent() of them at a time.
+ *
+ * Every run is a job with its own id and state. Jobs start in the order they
+ * were submitted as soon as a slot is free; the cap should match the bridge's
+ * runspace pool, so that no run waits on the bridge while holding a slot.
+ * Output, progress and the end of each job are reported by job id.
+ */
+class RunScheduler final : public QObject
+{
+    Q_OBJECT
+
+public:
+    enum class JobState
+    {
+        Queued,
+        Running,
+        Succeeded,
+        Failed,
+        Cancelled,
+    };
+    Q_ENUM(JobState)
+
+signals:
+    void jobStateChanged(quint64 jobId, RunScheduler::JobState state);
+
+    // One or more newline terminated records written by the job's script
+    void jobOutput(quint64 jobId, bridge::OutputStream stream, const QString& text);
+
+    // Objects written by the job's script; they also come as jobOutput text, one property per line
+    void jobRecords(quint64 jobId, const bridge::RecordBatch& batch);
+
+    void jobProgress(quint64 jobId, int percent, const QString& activity);
+
+    // The last signal of a job; state is Succeeded, Failed or Cancelled
+    void jobFinished(quint64 jobId, RunScheduler::JobState state, const QString& message);
+
+public:
+    explicit RunScheduler(PSClient* client, QObject* parent = nullptr);
+
+    ~RunScheduler() override = default;
+
+    /**
+     * Queues script and returns the id of its job. A job still running after
+     * timeoutSeconds is cancelled, 0 means no timeout.
+     */
+    quint64 submit(const QString& title, const QString& script, bool sticky = false, int timeoutSeconds = 0);
+
+    void cancel(quint64 jobId);
+
+    void cancelAll();
+
+    [[nodiscard]] int maxConcurrent() const { return m_maxConcurrent; }
+
+    // Takes effect for the next job that starts; running jobs are not stopped
+    void setMaxConcurrent(int count);
+
+    [[nodiscard]] int runningCount() const { return m_running; }
+
+    [[nodiscard]] int queuedCount() const { return static_cast<int>(m_queue.size()); }
+
+    [[nodiscard]] QString title(quint64 jobId) const;
+
+private slots:
+    void onOutput(quint64 requestId, bridge::OutputStream stream, const QString& text);
+
+    void onRecords(quint64 requestId, const bridge::RecordBatch& batch);
+
+    void onErrors(quint64 requestId, const QList<bridge::ErrorDetails>& errors);
+
+    void onProgress(quint64 requestId, int percent, const QString& activity);
+
+    void onFinished(quint64 requestId, bridge::RunStatus status, const QString& message);
+
+    void onFailed(quint64 requestId, const QString& error);
+
+private:
+    struct Job
+    {
+        QString title;
+        QString script;
+        bool sticky = false;
+        int timeoutSeconds = 0;
+        JobState state = JobState::Queued;
+        // Set once started
+        quint64 requestId = 0;
+        bool hadErrors = false;
+        bool timedOut = false;
+    };
+
+    PSClient* m_client;
+    int m_maxConcurrent = 4;
+    int m_running = 0;
+    quint64 m_nextJobId = 0;
+
+    // Jobs that have not finished, by id
+    std::map<quint64, Job> m_jobs;
+    std::deque<quint64> m_queue;
+    QHash<quint64, quint64> m_jobByRequest;
+
+    void dispatch();
+
+    void start(quint64 jobId, Job& job);
+
+    void timeOut(quint64 jobId);
+
+    void finish(quint64 jobId, JobState state, const QString& message);
+};
+
+#endif //RUN_SCHEDULER_H
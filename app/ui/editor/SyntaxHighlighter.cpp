@@ -0,0 +1,220 @@
+//
+// Created by talik on 10/18/2026.
+//
+
+#include "SyntaxHighlighter.h"
+
+#include <algorithm>
+
+#include "TaskPool.h"
+#include <QTextDocument>
+
+#include "BackgroundLexer.h"
+
+SyntaxHighlighter::SyntaxHighlighter(QTextDocument* parent)
+    : QSyntaxHighlighter(parent), m_lexerStrand(std::make_unique<TaskStrand>()), m_lexer(new BackgroundLexer())
+{
+    formatFor(pslang::TokenKind::Keyword).setForeground(QColor("#C586C0"));
+    formatFor(pslang::TokenKind::Command).setForeground(QColor("#FFB76B"));
+    formatFor(pslang::TokenKind::Variable).setForeground(QColor("#87CEEB"));
+    formatFor(pslang::TokenKind::Parameter).setForeground(QColor("#9CB4C8"));
+    formatFor(pslang::TokenKind::Number).setForeground(QColor("#B5CEA8"));
+    formatFor(pslang::TokenKind::String).setForeground(QColor("#3eb489"));
+    formatFor(pslang::TokenKind::Escape).setForeground(QColor("#D7BA7D"));
+    formatFor(pslang::TokenKind::Comment).setForeground(QColor(Qt::gray));
+    formatFor(pslang::TokenKind::Operator).setForeground(QColor("#D4D4D4"));
+
+    // Edits made while the worker is busy restart it once the user pauses typing
+    m_relexTimer.setSingleShot(true);
+    m_relexTimer.setInterval(250);
+    connect(&m_relexTimer, &QTimer::timeout, this, [this]
+    {
+        lexInBackground(document()->toPlainText());
+    });
+
+    connect(m_lexer, &BackgroundLexer::chunkReady, this, &SyntaxHighlighter::mergeStates);
+    connect(m_lexer, &BackgroundLexer::finished, this, &SyntaxHighlighter::onLexFinished);
+}
+
+SyntaxHighlighter::~SyntaxHighlighter()
+{
+    // Makes a running job stop at its next chunk
+    m_lexer->setLatestRevision(++m_revision);
+
+    m_lexerStrand->wait();
+    delete m_lexer;
+}
+
+void SyntaxHighlighter::beginLoading()
+{
+    m_relexTimer.stop();
+    m_loading = true;
+    m_backgroundLexing = true;
+
+    // A newly loaded document is shown from the top
+    m_firstVisible = 0;
+    m_lastVisible = 2 * VisibleBlocksMargin;
+}
+
+void SyntaxHighlighter::setBlockStates(const int firstBlock, const QList<int>& states)
+{
+    QTextBlock block = document()->findBlockByNumber(firstBlock);
+    for (const int state : states)
+    {
+        if (!block.isValid())
+        {
+            break;
+        }
+        block.setUserState(state);
+        block = block.next();
+    }
+}
+
+void SyntaxHighlighter::endLoading()
+{
+    m_loading = false;
+    m_backgroundLexing = false;
+}
+
+void SyntaxHighlighter::lexInBackground(const QString& text)
+{
+    m_relexTimer.stop();
+    m_backgroundLexing = true;
+    m_lexer->setLatestRevision(m_revision);
+
+    m_lexerStrand->post([lexer = m_lexer, revision = m_revision, text] { lexer->lex(revision, text); });
+}
+
+void SyntaxHighlighter::setVisibleBlocks(const int first, const int last)
+{
+    const int newFirst = std::max(0, first - VisibleBlocksMargin);
+    const int newLast = last + VisibleBlocksMargin;
+    if (newFirst == m_firstVisible && newLast == m_lastVisible)
+    {
+        return;
+    }
+
+    const int oldFirst = m_firstVisible;
+    const int oldLast = m_lastVisible;
+    m_firstVisible = newFirst;
+    m_lastVisible = newLast;
+
+    // Only the blocks that just scrolled into view need formats
+    int number = newFirst;
+    for (QTextBlock block = document()->findBlockByNumber(newFirst); block.isValid() && number <= newLast;
+         block = block.next(), ++number)
+    {
+        if (number < oldFirst || number > oldLast)
+        {
+            rehighlightBlock(block);
+        }
+    }
+}
+
+bool SyntaxHighlighter::isInViewport(const int blockNumber) const
+{
+    return blockNumber >= m_firstVisible && blockNumber <= m_lastVisible;
+}
+
+void SyntaxHighlighter::highlightBlock(const QString& text)
+{
+    const QTextBlock block = currentBlock();
+    const int blockNumber = block.blockNumber();
+    const bool visible = isInViewport(blockNumber);
+
+    if (!visible && m_backgroundLexing)
+    {
+        // The worker provides the state of this block, and formats are
+        // only needed once it scrolls into view.
+        return;
+    }
+
+    // previousBlockState() is -1 for the first block and for blocks the worker has not reached yet
+    pslang::LexState previous = previousBlockState();
+    if (previous < 0 && blockNumber > 0)
+    {
+        previous = stateBefore(block);
+    }
+
+    const pslang::LexState state = pslang::tokenize(text, previous, m_tokens);
+
+    if (!visible && !m_loading && state != block.userState() &&
+        document()->blockCount() - blockNumber > MaxForegroundCascade)
+    {
+        // The change would be carried through the rest of a long document: the
+        // old state is kept so the cascade stops here, and the worker lexes the
+        // blocks below instead.
+        m_backgroundLexing = true;
+        m_relexTimer.start();
+        return;
+    }
+
+    if (visible)
+    {
+        for (const auto& [offset, length, kind] : m_tokens)
+        {
+            setFormat(offset, length, formatFor(kind));
+        }
+    }
+
+    // A change here makes QSyntaxHighlighter carry on with the next block.
+    setCurrentBlockState(state);
+}
+
+pslang::LexState SyntaxHighlighter::stateBefore(const QTextBlock& block)
+{
+    QTextBlock known = block.previous();
+    while (known.isValid() && known.userState() < 0)
+    {
+        known = known.previous();
+    }
+
+    pslang::LexState state = known.isValid() ? known.userState() : pslang::InitialState;
+    for (QTextBlock next = known.isValid() ? known.next() : document()->firstBlock(); next != block;
+         next = next.next())
+    {
+        state = pslang::tokenize(next.text(), state, m_tokens);
+        next.setUserState(state);
+    }
+    return state;
+}
+
+void SyntaxHighlighter::onDocumentEdited(const quint64 revision)
+{
+    m_revision = revision;
+    m_lexer->setLatestRevision(m_revision);
+
+    if (m_backgroundLexing && !m_loading)
+    {
+        m_relexTimer.start();
+    }
+}
+
+void SyntaxHighlighter::mergeStates(const quint64 revision, const int firstBlock, const QList<int>& states)
+{
+    if (revision != m_revision)
+    {
+        // The document was edited after the snapshot was taken
+        return;
+    }
+
+    setBlockStates(firstBlock, states);
+
+    // Visible blocks in the chunk were coloured from the states left from before the edit
+    const int first = std::max(firstBlock, m_firstVisible);
+    const int last = std::min(firstBlock + static_cast<int>(states.size()) - 1, m_lastVisible);
+    int number = first;
+    for (QTextBlock block = document()->findBlockByNumber(first); block.isValid() && number <= last;
+         block = block.next(), ++number)
+    {
+        rehighlightBlock(block);
+    }
+}
+
+void SyntaxHighlighter::onLexFinished(const quint64 revision)
+{
+    if (revision == m_revision)
+    {
+        m_backgroundLexing = false;
+    }
+}
@@ -0,0 +1,109 @@
+//
+// Created by talik on 10/18/2026.
+//
+
+#ifndef SYNTAX_HIGHLIGHTER_H
+#define SYNTAX_HIGHLIGHTER_H
+
+#include <array>
+#include <memory>
+#include <vector>
+#include <QSyntaxHighlighter>
+#include <QTextCharFormat>
+#include <QTextBlock>
+#include <QTimer>
+
+#include "PSTokenizer.h"
+
+class TaskStrand;
+class BackgroundLexer;
+
+/**
+ * PowerShell highlighter attached directly to the editor's QTextDocument.
+ *
+ * QSyntaxHighlighter only calls highlightBlock() for blocks whose text changed,
+ * and keeps walking down the document only while the carried-over block state
+ * differs from the previous pass. Typing therefore costs O(changed lines) and
+ * never touches the undo stack or the cursor.
+ *
+ * Formats are only applied to the visible blocks (plus a margin). The
+ * carry-over states of the remaining blocks come from the FileLoader when a
+ * file is opened, and from a BackgroundLexer when an edit changes a state
+ * that would otherwise be carried down far below the viewport (an opening
+ * quote or <# near the top of a long file), so neither lexes the whole file
+ * on the GUI thread.
+ */
+class SyntaxHighlighter final : public QSyntaxHighlighter
+{
+    Q_OBJECT
+
+signals:
+
+public:
+    explicit SyntaxHighlighter(QTextDocument* parent = nullptr);
+
+    ~SyntaxHighlighter() override;
+
+    // Call before a file is loaded into the document in chunks, so that only
+    // the top of it is highlighted while the rest comes in.
+    void beginLoading();
+
+    // states[i] is the lexer state at the end of block (firstBlock + i), see FileLoader
+    void setBlockStates(int firstBlock, const QList<int>& states);
+
+    void endLoading();
+
+    // Lexes text, which must match the current document, on the worker thread.
+    // Blocks below the viewport are not lexed on the GUI thread until it is done.
+    void lexInBackground(const QString& text);
+
+    // Range of block numbers currently shown by the editor
+    void setVisibleBlocks(int first, int last);
+
+public slots:
+    // Connected to EditLog::edited
+    void onDocumentEdited(quint64 revision);
+
+protected:
+    void highlightBlock(const QString& text) override;
+
+private slots:
+    void mergeStates(quint64 revision, int firstBlock, const QList<int>& states);
+
+    void onLexFinished(quint64 revision);
+
+private:
+    // Extra blocks highlighted above and below the viewport so that short scrolls are free
+    static constexpr int VisibleBlocksMargin = 50;
+    // An edit changing the state of more blocks than this below the viewport is lexed by the worker
+    static constexpr int MaxForegroundCascade = 2000;
+
+    // One format per pslang::TokenKind
+    std::array<QTextCharFormat, static_cast<std::size_t>(pslang::TokenKind::Operator) + 1> m_formats;
+    // Reused between blocks so highlighting a line does not allocate
+    std::vector<pslang::Token> m_tokens;
+
+    int m_firstVisible = 0;
+    int m_lastVisible = VisibleBlocksMargin;
+
+    // Latest EditLog revision; states computed for an older revision are dropped.
+    quint64 m_revision = 0;
+    // True while block states below the viewport are still coming from the worker
+    bool m_backgroundLexing = false;
+    // True while a file is being loaded, the loader provides the block states
+    bool m_loading = false;
+    QTimer m_relexTimer;
+
+    // Lexes on the task pool, one snapshot after the other
+    std::unique_ptr<TaskStrand> m_lexerStrand;
+    BackgroundLexer* m_lexer;
+
+    QTextCharFormat& formatFor(pslang::TokenKind kind) { return m_formats[static_cast<std::size_t>(kind)]; }
+
+    [[nodiscard]] bool isInViewport(int blockNumber) const;
+
+    // State at the end of the block before block, lexing forward from the closest known state if needed
+    pslang::LexState stateBefore(const QTextBlock& block);
+};
+
+#endif //SYNTAX_HIGHLIGHTER_H
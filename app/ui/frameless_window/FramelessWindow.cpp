@@ -4,6 +4,7 @@
 
 #include "FramelessWindow.h"
 
+#include <QGridLayout>
 #include <QStatusBar>
 #include <QVBoxLayout>
 
@@ -265,6 +266,7 @@ void FramelessWindow::initContentAreaLayout(QWidget* contentArea)
     m_drawer = std::make_unique<CustomDrawer>(m_itoolsEditor.get());
     // This where the output_display generated after executing the script will be displayed
     m_outPutArea = std::make_unique<OutputDisplay>(this);
+    connect(m_outPutArea.get(), &OutputDisplay::rerunRequested, this, &FramelessWindow::rerunRequested);
 
     const auto editorAndDrawerAreaPanel = new QWidget(this);
     m_placeHolderLayout = std::make_unique<QGridLayout>(editorAndDrawerAreaPanel);
@@ -284,21 +286,53 @@ void FramelessWindow::processStatusSlot(const QString& message, const int timeou
     m_statusBar->showMessage(message, timeout);
 }
 
-void FramelessWindow::processResultSlot(const int exitCode, const QString& output, const QString& error) const
+void FramelessWindow::processResultSlot(const quint64 runId, const int exitCode, const QString& output,
+                                        const QString& error) const
 {
     m_outPutArea->show();
 
-    if (exitCode == 0)
+    // Streamed runs have already shown their output and only report how they ended
+    if (exitCode == static_cast<int>(bridge::RunStatus::Cancelled))
     {
-        m_outPutArea->log(output, error);
+        processStatusSlot("Cancelled.");
+    }
+    else if (exitCode == static_cast<int>(bridge::RunStatus::Succeeded))
+    {
+        if (!output.isEmpty())
+        {
+            m_outPutArea->log(output, "");
+        }
 
         processStatusSlot(error.isEmpty() ? "Completed!" : "Completed with errors.");
     }
     else
     {
-        processStatusSlot("Process failed!");
-        m_outPutArea->log("", error);
+        processStatusSlot(error.isEmpty() ? "Completed with errors." : "Process failed!");
     }
+
+    m_outPutArea->endRun(runId, exitCode == static_cast<int>(bridge::RunStatus::Succeeded), error);
+}
+
+void FramelessWindow::processRunStartedSlot(const quint64 runId, const QString& title) const
+{
+    m_outPutArea->show();
+    m_outPutArea->beginRun(runId, title);
+}
+
+void FramelessWindow::processRunStateSlot(const quint64 runId, const QString& state) const
+{
+    m_outPutArea->setRunState(runId, state);
+}
+
+void FramelessWindow::processOutputSlot(const quint64 runId, const bridge::OutputStream stream,
+                                        const QString& text) const
+{
+    m_outPutArea->append(runId, stream, text);
+}
+
+void FramelessWindow::processRecordsSlot(const quint64 runId, const bridge::RecordBatch& batch) const
+{
+    m_outPutArea->appendRecords(runId, batch);
 }
 
 void FramelessWindow::updateDrawer() const
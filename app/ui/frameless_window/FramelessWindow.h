@@ -8,11 +8,18 @@
 #include <QMainWindow>
 #include <QWidget>
 
+#include "clients/PSClient/RecordReader.h"
+
 namespace buraq
 {
     struct buraq_api;
 }
 
+namespace bridge
+{
+    enum class OutputStream : quint8;
+}
+
 class QPushButton; // Forward declaration
 class QStatusBar;
 class QGridLayout;
@@ -50,7 +57,11 @@ public:
 
 public slots:
     void processStatusSlot(const QString&, int timeout = 5000) const;
-    void processResultSlot(int exitCode, const QString& output, const QString& error) const;
+    void processResultSlot(quint64 runId, int exitCode, const QString& output, const QString& error) const;
+    void processRunStartedSlot(quint64 runId, const QString& title) const;
+    void processRunStateSlot(quint64 runId, const QString& state) const;
+    void processOutputSlot(quint64 runId, bridge::OutputStream stream, const QString& text) const;
+    void processRecordsSlot(quint64 runId, const bridge::RecordBatch& batch) const;
     void updateDrawer() const;
     void closeWindowSlot();
 
@@ -86,6 +97,8 @@ private:
 
 signals:
     void closeApp();
+    // A run picked in the output's history, to be submitted again
+    void rerunRequested(const QString& title, const QString& script);
 };
 
 #endif //FRAMELESS_WINDOW_H
@@ -0,0 +1,379 @@
+//
+// Created by talik on 10/18/2026.
+//
+
+#include "HistoryPanel.h"
+
+#include <algorithm>
+#include <QDateTime>
+#include <QFontDatabase>
+#include <QHBoxLayout>
+#include <QHeaderView>
+#include <QLabel>
+#include <QLineEdit>
+#include <QPlainTextEdit>
+#include <QPushButton>
+#include <QSplitter>
+#include <QTreeWidget>
+#include <QVBoxLayout>
+
+#include "TaskPool.h"
+
+namespace
+{
+    QString formatTime(const qint64 msecs)
+    {
+        return msecs == 0 ? QString() : QDateTime::fromMSecsSinceEpoch(msecs).toString("yyyy-MM-dd hh:mm:ss");
+    }
+
+    QString formatStatus(const database::RunSummary& run)
+    {
+        switch (run.status)
+        {
+        case static_cast<int>(bridge::RunStatus::Succeeded):
+            return "Completed";
+        case static_cast<int>(bridge::RunStatus::Failed):
+            return "Failed";
+        case static_cast<int>(bridge::RunStatus::Cancelled):
+            return "Cancelled";
+        default:
+            return run.startedAt != 0 ? "Running" : "Queued";
+        }
+    }
+
+    QString describe(const database::RunSummary& run)
+    {
+        return QString("%1 · %2 · %3").arg(run.title, formatTime(run.startedAt ? run.startedAt : run.queuedAt),
+                                            formatStatus(run));
+    }
+}
+
+HistoryPanel::HistoryPanel(database::RunHistory& history, QWidget* parent) : QWidget(parent), m_history(history)
+{
+    m_search = new QLineEdit(this);
+    m_search->setPlaceholderText(tr("Search scripts and output"));
+    m_search->setClearButtonEnabled(true);
+
+    m_newer = new QPushButton(tr("Newer"), this);
+    m_older = new QPushButton(tr("Older"), this);
+    m_page = new QLabel(this);
+
+    const auto top = new QHBoxLayout;
+    top->setContentsMargins(4, 2, 4, 2);
+    top->addWidget(m_search, 1);
+    top->addWidget(m_newer);
+    top->addWidget(m_older);
+    top->addWidget(m_page);
+
+    m_runs = new QTreeWidget(this);
+    m_runs->setRootIsDecorated(false);
+    m_runs->setUniformRowHeights(true);
+    m_runs->setSelectionMode(QAbstractItemView::ExtendedSelection);
+    m_runs->setHeaderLabels({tr("Started"), tr("Title"), tr("Status"), tr("Duration"), tr("Runspace")});
+    m_runs->header()->setSectionResizeMode(1, QHeaderView::Stretch);
+    m_runs->header()->setStretchLastSection(false);
+
+    m_details = new QPlainTextEdit(this);
+    m_details->setReadOnly(true);
+    m_details->setLineWrapMode(QPlainTextEdit::NoWrap);
+    m_details->setFont(QFontDatabase::systemFont(QFontDatabase::FixedFont));
+
+    const auto splitter = new QSplitter(Qt::Horizontal, this);
+    splitter->addWidget(m_runs);
+    splitter->addWidget(m_details);
+
+    m_rerun = new QPushButton(tr("Run again"), this);
+    m_compare = new QPushButton(tr("Compare output"), this);
+    m_compare->setToolTip(tr("With the other selected run, or the previous run of the same script"));
+
+    const auto bottom = new QHBoxLayout;
+    bottom->setContentsMargins(4, 2, 4, 2);
+    bottom->addStretch(1);
+    bottom->addWidget(m_rerun);
+    bottom->addWidget(m_compare);
+
+    const auto layout = new QVBoxLayout(this);
+    layout->setContentsMargins(0, 0, 0, 0);
+    layout->setSpacing(0);
+    layout->addLayout(top);
+    layout->addWidget(splitter, 1);
+    layout->addLayout(bottom);
+
+    m_debounce.setSingleShot(true);
+    m_debounce.setInterval(Debounce);
+    connect(&m_debounce, &QTimer::timeout, this, [this]
+    {
+        m_pageStarts = {0};
+        load();
+    });
+    connect(m_search, &QLineEdit::textChanged, &m_debounce, qOverload<>(&QTimer::start));
+
+    connect(m_newer, &QPushButton::clicked, this, [this]
+    {
+        if (m_pageStarts.size() > 1)
+        {
+            m_pageStarts.pop_back();
+            load();
+        }
+    });
+    connect(m_older, &QPushButton::clicked, this, [this]
+    {
+        if (m_hasMore && m_runs->topLevelItemCount() > 0)
+        {
+            m_pageStarts.push_back(m_runs->topLevelItem(m_runs->topLevelItemCount() - 1)->data(0, Qt::UserRole).
+                                            toLongLong());
+            load();
+        }
+    });
+    connect(m_runs, &QTreeWidget::itemSelectionChanged, this, &HistoryPanel::showDetails);
+    connect(m_rerun, &QPushButton::clicked, this, &HistoryPanel::rerun);
+    connect(m_compare, &QPushButton::clicked, this, &HistoryPanel::compare);
+
+    // Only the newest page changes as runs are recorded
+    connect(&m_history, &database::RunHistory::runsChanged, this, [this]
+    {
+        if (isVisible() && m_pageStarts.size() == 1)
+        {
+            load();
+        }
+    });
+
+    showDetails();
+}
+
+void HistoryPanel::showEvent(QShowEvent* event)
+{
+    QWidget::showEvent(event);
+    load();
+}
+
+void HistoryPanel::load()
+{
+    const quint64 request = ++m_pageRequest;
+    m_history.runs(m_search->text(), m_pageStarts.back(), PageSize)
+             .then(this, [this, request](const database::HistoryPage& page)
+             {
+                 if (request == m_pageRequest)
+                 {
+                     showPage(page);
+                 }
+             });
+}
+
+void HistoryPanel::showPage(const database::HistoryPage& page)
+{
+    // The same runs stay selected, without loading their details again
+    const QList<qint64> selected = selectedRuns();
+    const QSignalBlocker blocker(m_runs);
+    m_runs->clear();
+
+    QList<QTreeWidgetItem*> items;
+    items.reserve(page.runs.size());
+    for (const database::RunSummary& run : page.runs)
+    {
+        const auto item = new QTreeWidgetItem({
+            formatTime(run.startedAt ? run.startedAt : run.queuedAt),
+            run.title,
+            formatStatus(run),
+            run.finishedAt ? QString("%1 s").arg(double(run.durationMs) / 1000, 0, 'f', 2) : QString(),
+            run.runspace,
+        });
+        item->setData(0, Qt::UserRole, run.id);
+        item->setToolTip(1, run.scriptHash);
+        items.append(item);
+    }
+    m_runs->addTopLevelItems(items);
+    for (QTreeWidgetItem* item : std::as_const(items))
+    {
+        item->setSelected(selected.contains(item->data(0, Qt::UserRole).toLongLong()));
+    }
+
+    m_hasMore = page.hasMore;
+    m_newer->setEnabled(m_pageStarts.size() > 1);
+    m_older->setEnabled(m_hasMore);
+    m_page->setText(tr("Page %1").arg(m_pageStarts.size()));
+}
+
+QList<qint64> HistoryPanel::selectedRuns() const
+{
+    QList<qint64> runs;
+    for (const QTreeWidgetItem* item : m_runs->selectedItems())
+    {
+        runs.append(item->data(0, Qt::UserRole).toLongLong());
+    }
+    std::ranges::sort(runs);
+    return runs;
+}
+
+void HistoryPanel::showDetails()
+{
+    const QList<qint64> runs = selectedRuns();
+    m_rerun->setEnabled(runs.size() == 1);
+    m_compare->setEnabled(runs.size() == 1 || runs.size() == 2);
+
+    const quint64 request = ++m_detailsRequest;
+    if (runs.isEmpty())
+    {
+        m_details->clear();
+        return;
+    }
+
+    m_history.details(runs.back()).then(this, [this, request](const database::RunDetails& details)
+    {
+        if (request != m_detailsRequest)
+        {
+            return;
+        }
+
+        QString text = describe(details.run) + "\n" + tr("Runspace: %1 on %2").arg(details.run.runspace,
+            details.run.bridgeId) + "\n\n" + details.script + "\n\n" + tr("Output:") + "\n" + details.output;
+        if (details.run.truncated)
+        {
+            text += "\n" + tr("(output truncated)");
+        }
+        m_details->setPlainText(text);
+    });
+}
+
+void HistoryPanel::rerun()
+{
+    const QList<qint64> runs = selectedRuns();
+    if (runs.size() != 1)
+    {
+        return;
+    }
+
+    m_history.details(runs.front()).then(this, [this](const database::RunDetails& details)
+    {
+        if (details.run.id != 0)
+        {
+            emit rerunRequested(details.run.title, details.script);
+        }
+    });
+}
+
+void HistoryPanel::compare()
+{
+    const QList<qint64> runs = selectedRuns();
+    if (runs.isEmpty() || runs.size() > 2)
+    {
+        return;
+    }
+    const quint64 request = ++m_detailsRequest;
+
+    // Older run first
+    auto before = runs.size() == 2 ? m_history.details(runs.front()) : m_history.previousRun(runs.front());
+    const qint64 after = runs.back();
+    before.then(this, [this, request, after](const database::RunDetails& beforeDetails)
+    {
+        if (request != m_detailsRequest)
+        {
+            return;
+        }
+        if (beforeDetails.run.id == 0)
+        {
+            m_details->setPlainText(tr("No earlier run of this script."));
+            return;
+        }
+
+        m_history.details(after).then(this, [this, request, beforeDetails](const database::RunDetails& afterDetails)
+        {
+            showDiff(request, beforeDetails, afterDetails);
+        });
+    });
+}
+
+void HistoryPanel::showDiff(const quint64 request, const database::RunDetails& before,
+                            const database::RunDetails& after)
+{
+    if (request != m_detailsRequest)
+    {
+        return;
+    }
+
+    TaskPool::instance().run([before = before.output, after = after.output] { return diff(before, after); })
+                        .then(this, [this, request, header = "- " + describe(before.run) + "\n+ " +
+                                  describe(after.run) + "\n\n"](const QString& lines)
+                              {
+                                  if (request == m_detailsRequest)
+                                  {
+                                      m_details->setPlainText(header + lines);
+                                  }
+                              });
+}
+
+QString HistoryPanel::diff(const QString& before, const QString& after)
+{
+    QStringList a = before.split('\n');
+    QStringList b = after.split('\n');
+    const bool cut = a.size() > MaxDiffLines || b.size() > MaxDiffLines;
+    a = a.mid(0, MaxDiffLines);
+    b = b.mid(0, MaxDiffLines);
+
+    // The lines both start and end with take no part in the table
+    qsizetype prefix = 0;
+    while (prefix < a.size() && prefix < b.size() && a[prefix] == b[prefix])
+    {
+        ++prefix;
+    }
+    qsizetype suffix = 0;
+    while (suffix < a.size() - prefix && suffix < b.size() - prefix &&
+        a[a.size() - 1 - suffix] == b[b.size() - 1 - suffix])
+    {
+        ++suffix;
+    }
+
+    // Longest common subsequence of what is left, lengths from the end
+    const qsizetype n = a.size() - prefix - suffix;
+    const qsizetype m = b.size() - prefix - suffix;
+    std::vector<quint16> lengths(std::size_t((n + 1) * (m + 1)), 0);
+    const auto at = [&lengths, m](const qsizetype i, const qsizetype j) -> quint16&
+    {
+        return lengths[std::size_t(i * (m + 1) + j)];
+    };
+    for (qsizetype i = n - 1; i >= 0; --i)
+    {
+        for (qsizetype j = m - 1; j >= 0; --j)
+        {
+            at(i, j) = a[prefix + i] == b[prefix + j]
+                           ? quint16(at(i + 1, j + 1) + 1)
+                           : std::max(at(i + 1, j), at(i, j + 1));
+        }
+    }
+
+    QStringList lines;
+    for (qsizetype i = 0; i < prefix; ++i)
+    {
+        lines.append("  " + a[i]);
+    }
+    qsizetype i = 0;
+    qsizetype j = 0;
+    while (i < n || j < m)
+    {
+        if (i < n && j < m && a[prefix + i] == b[prefix + j])
+        {
+            lines.append("  " + a[prefix + i]);
+            ++i;
+            ++j;
+        }
+        else if (j < m && (i == n || at(i, j + 1) >= at(i + 1, j)))
+        {
+            lines.append("+ " + b[prefix + j]);
+            ++j;
+        }
+        else
+        {
+            lines.append("- " + a[prefix + i]);
+            ++i;
+        }
+    }
+    for (qsizetype k = a.size() - suffix; k < a.size(); ++k)
+    {
+        lines.append("  " + a[k]);
+    }
+    if (cut)
+    {
+        lines.append(tr("(only the first %1 lines were compared)").arg(MaxDiffLines));
+    }
+    return lines.join('\n');
+}
@@ -0,0 +1,87 @@
+//
+// Created by talik on 10/18/2026.
+//
+
+#ifndef HISTORY_PANEL_H
+#define HISTORY_PANEL_H
+
+#include <vector>
+#include <QTimer>
+#include <QWidget>
+
+#include "database/RunHistory.h"
+
+class QLabel;
+class QLineEdit;
+class QPlainTextEdit;
+class QPushButton;
+class QTreeWidget;
+
+/**
+ * Past runs from the RunHistory, newest first, a page at a time.
+ *
+ * Pages are read on a worker and follow each other by run id, so turning a
+ * page costs the same however long the history is. The selected run's script
+ * and output are loaded when it is picked; it can be run again, or its output
+ * compared with the other selected run or the previous run of its script.
+ */
+class HistoryPanel final : public QWidget
+{
+    Q_OBJECT
+
+signals:
+    void rerunRequested(const QString& title, const QString& script);
+
+public:
+    explicit HistoryPanel(database::RunHistory& history, QWidget* parent = nullptr);
+
+    ~HistoryPanel() override = default;
+
+protected:
+    // Catches up with the runs recorded while hidden
+    void showEvent(QShowEvent* event) override;
+
+private:
+    static constexpr int PageSize = 100;
+    static constexpr int Debounce = 250;
+    // Outputs longer than this are compared by their first lines only
+    static constexpr qsizetype MaxDiffLines = 2000;
+
+    database::RunHistory& m_history;
+
+    QLineEdit* m_search;
+    QPushButton* m_newer;
+    QPushButton* m_older;
+    QLabel* m_page;
+    QTreeWidget* m_runs;
+    QPushButton* m_rerun;
+    QPushButton* m_compare;
+    QPlainTextEdit* m_details;
+
+    QTimer m_debounce;
+    // The run id each page shown so far starts below, 0 for the newest; the last one is shown
+    std::vector<qint64> m_pageStarts{0};
+    bool m_hasMore = false;
+    // Bumped by every request, so only the answer to the latest is shown
+    quint64 m_pageRequest = 0;
+    quint64 m_detailsRequest = 0;
+
+    void load();
+
+    void showPage(const database::HistoryPage& page);
+
+    void showDetails();
+
+    void showDiff(quint64 request, const database::RunDetails& before, const database::RunDetails& after);
+
+    void rerun();
+
+    void compare();
+
+    [[nodiscard]] QList<qint64> selectedRuns() const;
+
+    // Line by line, with "- " for lines only in before and "+ " for lines only in after
+    [[nodiscard]] static QString diff(const QString& before, const QString& after);
+};
+
+#endif //HISTORY_PANEL_H
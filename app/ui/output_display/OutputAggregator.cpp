@@ -0,0 +1,100 @@
+//
+// Created by talik on 10/18/2026.
+//
+
+#include "OutputAggregator.h"
+
+#include <utility>
+#include <QThread>
+
+#include "OutputModel.h"
+
+OutputAggregator::OutputAggregator(OutputModel* model, QObject* parent) : QObject(parent), m_model(model)
+{
+    m_frame.setSingleShot(true);
+    m_frame.setInterval(FrameInterval);
+    connect(&m_frame, &QTimer::timeout, this, &OutputAggregator::flush);
+
+    m_statistics.setInterval(StatisticsInterval);
+    connect(&m_statistics, &QTimer::timeout, this, &OutputAggregator::updateStatistics);
+}
+
+bool OutputAggregator::push(const quint64 runId, const bridge::OutputStream stream, QString text)
+{
+    Record record{runId, stream, std::move(text)};
+    if (!m_queue.push(std::move(record)))
+    {
+        // The consumer is this very thread, so the queued flush cannot run before the queue
+        // is drained here; another thread can only drop the record.
+        if (QThread::currentThread() != thread())
+        {
+            m_dropped.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        flush();
+        m_queue.push(std::move(record));
+    }
+
+    // Timers belong to the aggregator's thread, so the producer asks that thread to start one.
+    // At most one request per frame, and one more when the queue fills up before it ends.
+    if (!m_scheduled.exchange(true, std::memory_order_acq_rel))
+    {
+        QMetaObject::invokeMethod(this, [this]
+        {
+            if (!m_frame.isActive())
+            {
+                m_frame.start();
+            }
+        }, Qt::QueuedConnection);
+    }
+    else if (m_queue.size() >= FlushThreshold && !m_urgent.exchange(true, std::memory_order_acq_rel))
+    {
+        QMetaObject::invokeMethod(this, &OutputAggregator::flush, Qt::QueuedConnection);
+    }
+    return true;
+}
+
+void OutputAggregator::flush()
+{
+    m_frame.stop();
+
+    // Cleared before draining, so a record pushed meanwhile schedules the next frame
+    m_scheduled.store(false, std::memory_order_release);
+    m_urgent.store(false, std::memory_order_release);
+
+    Record record;
+    quint64 lines = 0;
+    while (m_queue.pop(record))
+    {
+        lines += quint64(m_model->append(record.runId, record.stream, record.text));
+    }
+    if (lines == 0)
+    {
+        return;
+    }
+
+    // Shown in this frame rather than the model's next one
+    m_model->flush();
+
+    m_windowLines += lines;
+    if (!m_statistics.isActive())
+    {
+        m_window.start();
+        m_statistics.start();
+    }
+}
+
+void OutputAggregator::updateStatistics()
+{
+    const qint64 elapsed = m_window.restart();
+    m_linesPerSecond = elapsed > 0 ? double(m_windowLines) * 1000 / double(elapsed) : 0;
+
+    // Reports the quiet second after the output stopped, then sleeps until it starts again
+    if (m_windowLines == 0)
+    {
+        m_statistics.stop();
+    }
+    m_windowLines = 0;
+
+    emit statisticsChanged(m_linesPerSecond, droppedRecords());
+}
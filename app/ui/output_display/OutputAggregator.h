@@ -0,0 +1,89 @@
+//
+// Created by talik on 10/18/2026.
+//
+
+#ifndef OUTPUT_AGGREGATOR_H
+#define OUTPUT_AGGREGATOR_H
+
+#include <atomic>
+#include <QElapsedTimer>
+#include <QObject>
+#include <QString>
+#include <QTimer>
+
+#include "SpscQueue.h"
+#include "clients/PSClient/BridgeProtocol.h"
+
+class OutputModel;
+
+/**
+ * Gathers the output on its way to an OutputModel and hands it over once per
+ * frame, so a chatty script costs the GUI thread one batch every 16 ms rather
+ * than one pass through the model per record.
+ *
+ * Records wait in a lock-free single producer, single consumer queue: push()
+ * may be called from whichever one thread receives the output, and the model
+ * is filled on the aggregator's thread. A queue past FlushThreshold is handed
+ * over before the frame ends. A full queue is drained on the spot when the
+ * producer is the aggregator's own thread; a producer on another thread drops
+ * what comes in and counts it.
+ */
+class OutputAggregator final : public QObject
+{
+    Q_OBJECT
+
+signals:
+    // Once a second while output flows, and once more after it stopped
+    void statisticsChanged(double linesPerSecond, quint64 droppedRecords);
+
+public:
+    static constexpr std::size_t Capacity = 4096;
+    static constexpr std::size_t FlushThreshold = Capacity / 4;
+
+    explicit OutputAggregator(OutputModel* model, QObject* parent = nullptr);
+
+    ~OutputAggregator() override = default;
+
+    // Producer side. False if the record was dropped because the queue is full, which
+    // only happens when called from another thread than the aggregator's.
+    bool push(quint64 runId, bridge::OutputStream stream, QString text);
+
+    // Records dropped so far; thread safe
+    [[nodiscard]] quint64 droppedRecords() const { return m_dropped.load(std::memory_order_relaxed); }
+
+    // Lines handed to the model per second, over the last second
+    [[nodiscard]] double linesPerSecond() const { return m_linesPerSecond; }
+
+public slots:
+    // Hands everything queued to the model
+    void flush();
+
+private:
+    static constexpr int FrameInterval = 16;
+    static constexpr int StatisticsInterval = 1000;
+
+    struct Record
+    {
+        quint64 runId = 0;
+        bridge::OutputStream stream = bridge::OutputStream::Output;
+        QString text;
+    };
+
+    OutputModel* m_model;
+    SpscQueue<Record> m_queue{Capacity};
+
+    // Set by the producer when it asked for a frame, or for an early flush, since the last one
+    std::atomic<bool> m_scheduled{false};
+    std::atomic<bool> m_urgent{false};
+    std::atomic<quint64> m_dropped{0};
+
+    QTimer m_frame;
+    QTimer m_statistics;
+    QElapsedTimer m_window;
+    quint64 m_windowLines = 0;
+    double m_linesPerSecond = 0;
+
+    void updateStatistics();
+};
+
+#endif //OUTPUT_AGGREGATOR_H
@@ -23,13 +23,18 @@
 //
 // Created by talik on 5/1/2024.
 //
-#include <QScrollArea>
 #include <QDateTime>
+#include <QTabBar>
+#include <QVBoxLayout>
 #include "OutputDisplay.h"
-#include "Utils.h"
-#include "app_ui/AppUi.h"
-
-void init_main_out_area(QPlainTextEdit*, QVBoxLayout*, int);
+#include "HistoryPanel.h"
+#include "OutputAggregator.h"
+#include "OutputFilterModel.h"
+#include "OutputIndex.h"
+#include "OutputModel.h"
+#include "OutputSearchBar.h"
+#include "OutputView.h"
+#include "ResultsView.h"
 
 OutputDisplay::OutputDisplay(QWidget* window) : QWidget(window), m_window(window)
 {
@@ -46,42 +51,75 @@ OutputDisplay::OutputDisplay(QWidget* window) : QWidget(window), m_window(window
     //     "border-bottom: 1px solid #000;");
     layout->addWidget(pMainLabel);
 
-    main = std::make_unique<QPlainTextEdit>();
-    init_main_out_area(main.get(), layout, 0);
-
-    hide();
-}
-
-void init_main_out_area(QPlainTextEdit* main, QVBoxLayout* layout, int editorWidth = 0)
-{
-    // For displaying the output_display
-    layout->addWidget(main);
+    m_searchBar = new OutputSearchBar(this);
+    connect(m_searchBar, &OutputSearchBar::queryChanged, this, &OutputDisplay::search);
+    layout->addWidget(m_searchBar);
 
-    // Get the current palette
-    QPalette palette = main->palette();
+    // The console tab shows every line in the order it came, every run also gets a tab of its own
+    m_tabs = new QTabWidget(this);
+    m_tabs->setDocumentMode(true);
+    m_tabs->setTabsClosable(true);
+    connect(m_tabs, &QTabWidget::tabCloseRequested, this, &OutputDisplay::closeTab);
+    layout->addWidget(m_tabs);
 
-    // Set the color for the background of the selection
-    palette.setColor(QPalette::Highlight, QColor(0, 120, 215)); // A common blue selection background
-    palette.setColor(QPalette::Text, QColor(Qt::white)); // A common blue selection background
-    main->setPalette(palette);
+    m_model = new OutputModel(this);
+    m_aggregator = new OutputAggregator(m_model, this);
+    m_console = new OutputView(m_model);
+    m_index = std::make_unique<OutputIndex>();
 
-    main->setReadOnly(true);
-    main->setLineWrapMode(QPlainTextEdit::LineWrapMode::WidgetWidth);
+    // The index gets each frame's lines as the console shows them, so a search covers exactly what is on it
+    connect(m_model, &QAbstractItemModel::rowsInserted, this, [this](const QModelIndex&, const int first, const int last)
+    {
+        OutputIndex::Batch batch;
+        batch.firstSequence = m_model->firstSequence() + quint64(first);
+        batch.lines.reserve(std::size_t(last - first + 1));
+        for (quint64 sequence = batch.firstSequence; sequence <= m_model->firstSequence() + quint64(last); ++sequence)
+        {
+            const OutputRecord& record = m_model->record(sequence);
+            const QStringView text = m_model->text(record);
+            batch.lines.push_back({
+                .timestamp = record.timestamp,
+                .runId = record.runId,
+                .offset = quint32(batch.text.size()),
+                .length = quint32(text.size()),
+                .stream = record.stream,
+            });
+            batch.text.append(text);
+        }
+        m_index->add(std::move(batch));
+    });
+    connect(m_model, &QAbstractItemModel::rowsRemoved, this, [this]
+    {
+        m_index->dropBefore(m_model->firstSequence());
+    });
 
-    main->setHorizontalScrollBarPolicy(Qt::ScrollBarAlwaysOff);
+    connect(m_aggregator, &OutputAggregator::statisticsChanged, pMainLabel,
+            [pMainLabel](const double linesPerSecond, const quint64 droppedRecords)
+            {
+                QString text = "❯_";
+                if (linesPerSecond > 0)
+                {
+                    text += QString("   %1 lines/s").arg(qRound64(linesPerSecond));
+                }
+                if (droppedRecords > 0)
+                {
+                    text += QString("   %1 dropped").arg(droppedRecords);
+                }
+                pMainLabel->setText(text);
+            });
+    m_tabs->addTab(m_console, "Console");
+    m_tabs->tabBar()->setTabButton(0, QTabBar::RightSide, nullptr);
 
-    if (editorWidth > 0)
-    {
-        main->setMinimumWidth(editorWidth);
-    }
+    m_history = new HistoryPanel(database::RunHistory::instance());
+    connect(m_history, &HistoryPanel::rerunRequested, this, &OutputDisplay::rerunRequested);
+    m_tabs->addTab(m_history, "History");
+    m_tabs->tabBar()->setTabButton(1, QTabBar::RightSide, nullptr);
 
-    // --- QSS for Custom Scrollbar ---
-    // Apply the stylesheet directly to the textEdit widget
-    // This ensures only this textEdit's scrollbars are affected (and its children if any)
-    main->setVerticalScrollBarPolicy(Qt::ScrollBarPolicy::ScrollBarAsNeeded);
-    main->setMinimumHeight(550);
+    hide();
 }
 
+OutputDisplay::~OutputDisplay() = default;
+
 void OutputDisplay::toggle()
 {
     if (isVisible())
@@ -96,64 +134,146 @@ void OutputDisplay::toggle()
 
 void OutputDisplay::log(const QString& output, const QString& errorOutput) const
 {
-    QStringList list = output.split("\\u2029");
-    QStringList errorsList = errorOutput.split("\\u2029");
+    m_tabs->setCurrentWidget(m_console);
 
-    QLabel* error = createLabel(errorOutput, "error");
+    const QString formattedDateTime = QDateTime::currentDateTime().toString("yyyy-MM-dd hh:mm:ss");
+    m_aggregator->push(0, bridge::OutputStream::Information, "Executed: " + formattedDateTime);
 
-    // Adds timestamp
-    QDateTime currentDateTime = QDateTime::currentDateTime();
-    QString formattedDateTime = currentDateTime.toString("yyyy-MM-dd hh:mm:ss"); // Custom format
-    main->appendHtml("<h4 style=\"color: #FFFDD0;\">Executed: " +
-        formattedDateTime + "</h4>");
-    // End Adds timestamp
+    // Callers still separate lines with paragraph separators
+    m_aggregator->push(0, bridge::OutputStream::Output, QString(output).replace(QChar::ParagraphSeparator, '\n'));
+    m_aggregator->push(0, bridge::OutputStream::Error, QString(errorOutput).replace(QChar::ParagraphSeparator, '\n'));
+}
 
-    main->appendHtml("<div>");
-    for (const QString& qString : list)
-    {
-        main->appendHtml("<p  style=\"color: #FFFFFF;\">" + qString + "</p>");
-    }
-    for (const QString& qString : errorsList)
+void OutputDisplay::beginRun(const quint64 runId, const QString& title)
+{
+    // Finished runs are closed oldest first once there are too many tabs
+    for (auto it = m_runs.begin(); m_runs.size() >= MaxRunTabs && it != m_runs.end();)
     {
-        // error logs
-        main->appendHtml("<p style=\"color: #FF6347;\">" + qString + "</p>");
+        if (it->second.finished)
+        {
+            m_tabs->removeTab(m_tabs->indexOf(it->second.view));
+            it->second.view->deleteLater();
+            if (it->second.results != nullptr)
+            {
+                m_tabs->removeTab(m_tabs->indexOf(it->second.results));
+                it->second.results->deleteLater();
+            }
+            it = m_runs.erase(it);
+        }
+        else
+        {
+            ++it;
+        }
     }
-    main->appendHtml("</div>");
 
-    if (error != nullptr)
+    // The tab only shows the run's lines, which the console keeps
+    OutputQuery query;
+    query.runId = runId;
+    const auto lines = new OutputFilterModel(m_model, query);
+    lines->populate();
+    const auto view = new OutputView(lines);
+    lines->setParent(view);
+    m_runs.emplace(runId, RunTab{.view = view, .title = title});
+
+    const QString formattedDateTime = QDateTime::currentDateTime().toString("yyyy-MM-dd hh:mm:ss");
+    m_aggregator->push(runId, bridge::OutputStream::Information, "Submitted: " + formattedDateTime);
+
+    m_tabs->setCurrentIndex(m_tabs->addTab(view, title));
+}
+
+void OutputDisplay::setRunState(const quint64 runId, const QString& state) const
+{
+    if (const auto it = m_runs.find(runId); it != m_runs.end())
     {
-        const auto layout = new QVBoxLayout;
-        layout->addWidget(error);
+        m_tabs->setTabText(m_tabs->indexOf(it->second.view), it->second.title + " · " + state);
     }
 }
 
-QLabel* OutputDisplay::createLabel(const QString& text, QString state)
+void OutputDisplay::append(const quint64 runId, const bridge::OutputStream stream, const QString& text) const
 {
-    if (text.isEmpty())
-        return nullptr;
+    // Kept for the console even when the run's tab was closed
+    m_aggregator->push(runId, stream, text);
+}
 
-    auto label = new QLabel;
-    label->setText(text);
-    label->setFont(QFont("Arial", 32));
+void OutputDisplay::appendRecords(const quint64 runId, const bridge::RecordBatch& batch)
+{
+    // The console has them as text, runs whose tab was closed get no grid
+    const auto it = m_runs.find(runId);
+    if (it == m_runs.end())
+    {
+        return;
+    }
 
-	//@formatter:off
-	// label->setStyleSheet(
-	// 	std::equal(state.begin(), state.end(), "error") ? "color: #FF6347;" : "color: #F9F6EE;");
-    //@formatter:on
+    if (it->second.results == nullptr)
+    {
+        it->second.results = new ResultsView;
+        m_tabs->insertTab(m_tabs->indexOf(it->second.view) + 1, it->second.results, it->second.title + " · Objects");
+    }
+    it->second.results->append(batch);
+}
 
-    label->setAlignment(Qt::AlignLeft);
+void OutputDisplay::endRun(const quint64 runId, const bool succeeded, const QString& message)
+{
+    const auto it = m_runs.find(runId);
+    if (it == m_runs.end())
+    {
+        return;
+    }
 
-    // Call adjustSize() after setting the text
-    label->adjustSize();
+    it->second.finished = true;
+    if (!message.isEmpty())
+    {
+        append(runId, succeeded ? bridge::OutputStream::Information : bridge::OutputStream::Error, message + "\n");
+    }
+}
 
-    // Get the recommended size from sizeHint()
-    QSize recommendedSize = label->sizeHint();
-    recommendedSize.setWidth(recommendedSize.width() * 2); // Add some extra width
-    // auto n = std::max(100, recommendedSize.height());
-    recommendedSize.setHeight(recommendedSize.height() + 100); // Add some extra width
+void OutputDisplay::closeTab(const int index)
+{
+    QWidget* view = m_tabs->widget(index);
+    if (view == m_console || view == m_history)
+    {
+        return;
+    }
 
-    // Set the label's size manually
-    label->setFixedSize(recommendedSize);
+    // The run's lines stay in the console. Its grid and its tab are closed one at a time.
+    for (auto& run : m_runs)
+    {
+        if (run.second.results == view)
+        {
+            run.second.results = nullptr;
+        }
+    }
+    std::erase_if(m_runs, [view](const auto& run) { return run.second.view == view; });
+    m_tabs->removeTab(index);
+    view->deleteLater();
+}
 
-    return label;
+void OutputDisplay::search(const OutputQuery& query)
+{
+    ++m_search;
+    m_tabs->setCurrentWidget(m_console);
+    m_console->setModel(m_model);
+    if (m_results != nullptr)
+    {
+        m_results->deleteLater();
+        m_results = nullptr;
+    }
+    if (query.matchesEverything())
+    {
+        return;
+    }
+
+    // Matches the lines to come right away, the index fills in those the console already has
+    m_results = new OutputFilterModel(m_model, query, this);
+    m_console->setModel(m_results);
+    m_index->search(query).then(this, [this, search = m_search](const OutputIndex::Result& result)
+    {
+        // A later query replaced it
+        if (search != m_search || m_results == nullptr)
+        {
+            return;
+        }
+        m_results->setMatches(result.sequences, result.end);
+        m_searchBar->setResult(m_results->rowCount(), result.elapsedMs);
+    });
 }
@@ -27,17 +27,30 @@
 #ifndef OUTPUT_DISPLAY_H
 #define OUTPUT_DISPLAY_H
 
-#include <QWidget>
-#include <QGridLayout>
+#include <map>
+#include <memory>
 #include <QLabel>
-#include <QPlainTextEdit>
-#include <QScrollArea>
+#include <QTabWidget>
+#include <QWidget>
+
+#include "clients/PSClient/BridgeProtocol.h"
+#include "clients/PSClient/RecordReader.h"
+
+class HistoryPanel;
+class OutputAggregator;
+class OutputFilterModel;
+class OutputIndex;
+class OutputModel;
+class OutputSearchBar;
+class OutputView;
+class ResultsView;
+struct OutputQuery;
 
 class OutputDisplay : public QWidget {
 Q_OBJECT
 
 public:
-	~OutputDisplay() override = default;
+	~OutputDisplay() override;
 
 	explicit OutputDisplay(QWidget *window = nullptr);
 
@@ -45,11 +58,65 @@ public:
 
 	void log(const QString &output, const QString &error) const;
 
+	// Opens a tab for a run whose output is streamed in with append()
+	void beginRun(quint64 runId, const QString &title);
+
+	// Shown next to the title of the run's tab
+	void setRunState(quint64 runId, const QString &state) const;
+
+	// Adds newline terminated records of a running script at the end, in the color of their stream
+	void append(quint64 runId, bridge::OutputStream stream, const QString &text) const;
+
+	void endRun(quint64 runId, bool succeeded, const QString &message);
+
+	// Objects of a running script, shown in a grid tab of the run opened with the first of them
+	void appendRecords(quint64 runId, const bridge::RecordBatch &batch);
+
+signals:
+	// From the history tab
+	void rerunRequested(const QString &title, const QString &script);
+
+private slots:
+	void closeTab(int index);
+
 private:
-	// m_state is "error" or "default"
-	static QLabel *createLabel(const QString &text, QString state = "default");
-	std::unique_ptr<QPlainTextEdit> main;
+	// Tabs of finished runs are closed beyond this
+	static constexpr std::size_t MaxRunTabs = 16;
+
+	struct RunTab
+	{
+		OutputView *view;
+		// Null until the run wrote objects
+		ResultsView *results = nullptr;
+		QString title;
+		bool finished = false;
+	};
+
 	QWidget *m_window;
+
+	// Every line shown, in a ring bounded by line count and text size
+	OutputModel *m_model;
+	// Everything on its way to m_model, handed over once per frame
+	OutputAggregator *m_aggregator;
+	OutputView *m_console;
+
+	// Every line of m_model again, filed into blocks by a worker for searching
+	std::unique_ptr<OutputIndex> m_index;
+	OutputSearchBar *m_searchBar;
+	// What the console shows instead of m_model while searching
+	OutputFilterModel *m_results = nullptr;
+	// Bumped by every search, so only the answer to the latest is shown
+	quint64 m_search = 0;
+
+	// Runs of this and earlier sessions, from the database
+	HistoryPanel *m_history;
+
+	QTabWidget *m_tabs;
+	// Open run tabs, oldest run first
+	std::map<quint64, RunTab> m_runs;
+
+	// Shows the console's lines that match query, or all of them for a default one
+	void search(const OutputQuery &query);
 };
 
 #endif //OUTPUT_DISPLAY_H
@@ -0,0 +1,126 @@
+//
+// Created by talik on 10/18/2026.
+//
+
+#include "OutputFilterModel.h"
+
+#include <algorithm>
+#include <vector>
+
+#include "OutputModel.h"
+
+OutputFilterModel::OutputFilterModel(OutputModel* source, const OutputQuery& query, QObject* parent)
+    : QAbstractListModel(parent), m_source(source), m_matcher(query), m_liveFrom(source->endSequence())
+{
+    connect(m_source, &QAbstractItemModel::rowsInserted, this, &OutputFilterModel::onRowsInserted);
+    connect(m_source, &QAbstractItemModel::rowsRemoved, this, &OutputFilterModel::onRowsRemoved);
+    connect(m_source, &QAbstractItemModel::modelReset, this, [this]
+    {
+        beginResetModel();
+        m_sequences.clear();
+        endResetModel();
+    });
+}
+
+void OutputFilterModel::populate()
+{
+    std::vector<quint64> matches;
+    for (quint64 sequence = m_source->firstSequence(); sequence < m_liveFrom; ++sequence)
+    {
+        const OutputRecord& record = m_source->record(sequence);
+        if (m_matcher.matches(record.timestamp, record.runId, record.stream, m_source->text(record)))
+        {
+            matches.push_back(sequence);
+        }
+    }
+    prepend(std::move(matches));
+}
+
+void OutputFilterModel::setMatches(const std::vector<quint64>& sequences, const quint64 end)
+{
+    // Lines from end on were matched as they arrived, and the source may have dropped some meanwhile
+    const quint64 last = std::min(end, m_liveFrom);
+    const auto first = std::ranges::lower_bound(sequences, m_source->firstSequence());
+    prepend(std::vector<quint64>(first, std::ranges::lower_bound(first, sequences.end(), last)));
+}
+
+void OutputFilterModel::prepend(std::vector<quint64> sequences)
+{
+    if (!m_sequences.empty())
+    {
+        std::erase_if(sequences, [this](const quint64 sequence) { return sequence >= m_sequences.front(); });
+    }
+    if (sequences.empty())
+    {
+        return;
+    }
+
+    beginInsertRows(QModelIndex(), 0, int(sequences.size()) - 1);
+    m_sequences.insert(m_sequences.begin(), sequences.begin(), sequences.end());
+    endInsertRows();
+}
+
+int OutputFilterModel::rowCount(const QModelIndex& parent) const
+{
+    return parent.isValid() ? 0 : int(m_sequences.size());
+}
+
+QVariant OutputFilterModel::data(const QModelIndex& index, const int role) const
+{
+    if (!index.isValid() || std::size_t(index.row()) >= m_sequences.size())
+    {
+        return {};
+    }
+
+    const quint64 sequence = m_sequences[index.row()];
+    if (!m_source->contains(sequence))
+    {
+        return {};
+    }
+    return m_source->index(int(sequence - m_source->firstSequence())).data(role);
+}
+
+void OutputFilterModel::onRowsInserted(const QModelIndex& parent, const int first, const int last)
+{
+    if (parent.isValid())
+    {
+        return;
+    }
+
+    std::vector<quint64> matches;
+    for (int row = first; row <= last; ++row)
+    {
+        const quint64 sequence = m_source->firstSequence() + quint64(row);
+        const OutputRecord& record = m_source->record(sequence);
+        if (sequence >= m_liveFrom &&
+            m_matcher.matches(record.timestamp, record.runId, record.stream, m_source->text(record)))
+        {
+            matches.push_back(sequence);
+        }
+    }
+
+    if (matches.empty())
+    {
+        return;
+    }
+
+    const int count = int(m_sequences.size());
+    beginInsertRows(QModelIndex(), count, count + int(matches.size()) - 1);
+    m_sequences.insert(m_sequences.end(), matches.begin(), matches.end());
+    endInsertRows();
+}
+
+void OutputFilterModel::onRowsRemoved()
+{
+    // The source only drops its oldest lines
+    const auto kept = std::ranges::lower_bound(m_sequences, m_source->firstSequence());
+    const auto dropped = int(kept - m_sequences.begin());
+    if (dropped == 0)
+    {
+        return;
+    }
+
+    beginRemoveRows(QModelIndex(), 0, dropped - 1);
+    m_sequences.erase(m_sequences.begin(), kept);
+    endRemoveRows();
+}
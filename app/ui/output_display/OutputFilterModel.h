@@ -0,0 +1,67 @@
+//
+// Created by talik on 10/18/2026.
+//
+
+#ifndef OUTPUT_FILTER_MODEL_H
+#define OUTPUT_FILTER_MODEL_H
+
+#include <deque>
+#include <vector>
+#include <QAbstractListModel>
+
+#include "OutputIndex.h"
+
+class OutputModel;
+
+/**
+ * The lines of an OutputModel that match an OutputQuery: those of one run,
+ * for the run's own tab, or the results of the search bar.
+ *
+ * Keeps the sequence numbers of its lines rather than mapping every source
+ * row like QSortFilterProxyModel does, so following the source costs only
+ * the lines that arrive or fall out of its ring.
+ *
+ * Lines arriving after the model was made are matched as they come. The ones
+ * the source had before are filled in by populate(), or by setMatches() with
+ * the result of an OutputIndex search made at the same time.
+ */
+class OutputFilterModel final : public QAbstractListModel
+{
+    Q_OBJECT
+
+public:
+    OutputFilterModel(OutputModel* source, const OutputQuery& query, QObject* parent = nullptr);
+
+    ~OutputFilterModel() override = default;
+
+    [[nodiscard]] const OutputQuery& query() const { return m_matcher.query(); }
+
+    // Matches the lines the source had when the model was made, on the calling thread
+    void populate();
+
+    // Puts the lines an OutputIndex found before end ahead of those matched since
+    void setMatches(const std::vector<quint64>& sequences, quint64 end);
+
+    [[nodiscard]] int rowCount(const QModelIndex& parent = QModelIndex()) const override;
+
+    // The source's data for the line
+    [[nodiscard]] QVariant data(const QModelIndex& index, int role = Qt::DisplayRole) const override;
+
+private slots:
+    void onRowsInserted(const QModelIndex& parent, int first, int last);
+
+    void onRowsRemoved();
+
+private:
+    OutputModel* m_source;
+    OutputMatcher m_matcher;
+    // Lines from this one on are matched as they arrive
+    quint64 m_liveFrom;
+    // Ascending
+    std::deque<quint64> m_sequences;
+
+    // Inserts ascending sequences, all before the first one kept so far, at the top
+    void prepend(std::vector<quint64> sequences);
+};
+
+#endif //OUTPUT_FILTER_MODEL_H
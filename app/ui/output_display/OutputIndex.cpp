@@ -0,0 +1,331 @@
+//
+// Created by talik on 10/18/2026.
+//
+
+#include "OutputIndex.h"
+
+#include <algorithm>
+#include <bit>
+#include <QElapsedTimer>
+#include <QPromise>
+
+#include "TaskPool.h"
+
+namespace
+{
+    // Lines are case folded code unit by code unit, which is all trigrams need
+    char16_t fold(const QChar ch)
+    {
+        return static_cast<char16_t>(QChar::toCaseFolded(ch.unicode()));
+    }
+
+    quint64 trigramHash(const char16_t a, const char16_t b, const char16_t c)
+    {
+        return ((quint64(a) << 32) | (quint64(b) << 16) | c) * 0x9E3779B97F4A7C15ull;
+    }
+
+    // Calls f with the hash of every case folded trigram of text
+    template <typename F>
+    void forEachTrigram(const QStringView text, F&& f)
+    {
+        char16_t a = 0;
+        char16_t b = 0;
+        qsizetype seen = 0;
+        for (const QChar ch : text)
+        {
+            const char16_t c = fold(ch);
+            if (++seen >= 3)
+            {
+                f(trigramHash(a, b, c));
+            }
+            a = b;
+            b = c;
+        }
+    }
+
+    // Two bits of the Bloom filter per trigram, from different parts of the hash
+    template <std::size_t Bits>
+    std::pair<std::size_t, std::size_t> bloomBits(const quint64 hash)
+    {
+        static_assert(std::has_single_bit(Bits));
+        return {std::size_t(hash >> 40) & (Bits - 1), std::size_t(hash >> 16) & (Bits - 1)};
+    }
+
+    // Blocks are scanned in parts of at least this many, on as many workers as there are parts
+    constexpr std::size_t BlocksPerPart = 16;
+}
+
+bool OutputQuery::matchesEverything() const
+{
+    return text.isEmpty() && streams == AllStreams && runId == 0 && from == std::numeric_limits<qint64>::min() &&
+        to == std::numeric_limits<qint64>::max();
+}
+
+OutputMatcher::OutputMatcher(const OutputQuery& query) : m_query(query)
+{
+    if (m_query.text.isEmpty())
+    {
+        return;
+    }
+
+    if (m_query.regex)
+    {
+        m_regex.setPattern(m_query.text);
+        m_regex.setPatternOptions(m_query.caseSensitive
+                                      ? QRegularExpression::NoPatternOption
+                                      : QRegularExpression::CaseInsensitiveOption);
+        m_valid = m_regex.isValid();
+        return;
+    }
+
+    m_matcher.setPattern(m_query.text);
+    m_matcher.setCaseSensitivity(m_query.caseSensitive ? Qt::CaseSensitive : Qt::CaseInsensitive);
+
+    // A line holding the text holds its trigrams, whatever the case
+    forEachTrigram(m_query.text, [this](const quint64 hash) { m_trigrams.push_back(hash); });
+    std::ranges::sort(m_trigrams);
+    m_trigrams.erase(std::ranges::unique(m_trigrams).begin(), m_trigrams.end());
+}
+
+bool OutputMatcher::matches(const qint64 timestamp, const quint64 runId, const bridge::OutputStream stream,
+                            const QStringView text) const
+{
+    if ((m_query.streams & (1u << static_cast<quint8>(stream))) == 0 || timestamp < m_query.from ||
+        timestamp > m_query.to || (m_query.runId != 0 && runId != m_query.runId))
+    {
+        return false;
+    }
+
+    if (m_query.text.isEmpty())
+    {
+        return true;
+    }
+    if (m_query.regex)
+    {
+        return m_valid && m_regex.matchView(text).hasMatch();
+    }
+    return m_matcher.indexIn(text) >= 0;
+}
+
+bool OutputIndex::Block::mayMatch(const OutputMatcher& matcher) const
+{
+    const OutputQuery& query = matcher.query();
+    if ((streams & query.streams) == 0 || lastTime < query.from || firstTime > query.to ||
+        (query.runId != 0 && (query.runId < minRun || query.runId > maxRun)))
+    {
+        return false;
+    }
+
+    return std::ranges::all_of(matcher.trigrams(), [this](const quint64 hash)
+    {
+        const auto [first, second] = bloomBits<BloomBits>(hash);
+        return trigrams.test(first) && trigrams.test(second);
+    });
+}
+
+struct OutputIndex::Search
+{
+    OutputQuery query;
+    std::vector<std::shared_ptr<const Block>> blocks;
+    quint64 end = 0;
+
+    quint64 generation = 0;
+    std::shared_ptr<std::atomic<quint64>> latest;
+
+    // Filled by one part each, then joined by the part that finishes last
+    std::vector<std::vector<quint64>> parts;
+    std::atomic<std::size_t> remaining{0};
+    std::shared_ptr<QPromise<Result>> promise;
+    QElapsedTimer timer;
+};
+
+OutputIndex::OutputIndex()
+    : m_strand(std::make_unique<TaskStrand>()), m_generation(std::make_shared<std::atomic<quint64>>(0))
+{
+}
+
+OutputIndex::~OutputIndex()
+{
+    // Searches in flight only hold their blocks, they can go on without the index
+    m_generation->fetch_add(1, std::memory_order_relaxed);
+    m_strand->wait();
+}
+
+void OutputIndex::add(Batch batch)
+{
+    m_strand->post([this, batch = std::move(batch)] { file(batch); });
+}
+
+void OutputIndex::dropBefore(const quint64 sequence)
+{
+    m_strand->post([this, sequence]
+    {
+        // Whole blocks only; searches leave out what the console no longer has
+        std::lock_guard lock(m_mutex);
+        const auto kept = std::ranges::find_if(m_blocks, [sequence](const std::shared_ptr<const Block>& block)
+        {
+            return block->firstSequence + block->lines.size() > sequence;
+        });
+        m_blocks.erase(m_blocks.begin(), kept);
+    });
+}
+
+void OutputIndex::file(const Batch& batch)
+{
+    for (std::size_t i = 0; i < batch.lines.size();)
+    {
+        std::shared_ptr<Block> block;
+        {
+            std::lock_guard lock(m_mutex);
+            if (!m_open)
+            {
+                m_open = std::make_shared<Block>();
+                m_open->firstSequence = batch.firstSequence + i;
+                m_open->text.reserve(16 * 1024);
+            }
+            block = m_open;
+        }
+
+        // Trigrams are worked out outside the lock, searches only need it for copying the open block
+        const std::size_t count = std::min(batch.lines.size() - i, std::size_t(BlockLines) - block->lines.size());
+        std::vector<std::size_t> bits;
+        for (std::size_t j = i; j < i + count; ++j)
+        {
+            const Batch::Line& line = batch.lines[j];
+            forEachTrigram(QStringView(batch.text).sliced(line.offset, line.length), [&bits](const quint64 hash)
+            {
+                const auto [first, second] = bloomBits<BloomBits>(hash);
+                bits.push_back(first);
+                bits.push_back(second);
+            });
+        }
+
+        std::lock_guard lock(m_mutex);
+        for (std::size_t j = i; j < i + count; ++j)
+        {
+            Batch::Line line = batch.lines[j];
+            const QStringView text = QStringView(batch.text).sliced(line.offset, line.length);
+            line.offset = quint32(block->text.size());
+            block->text.append(text);
+            block->lines.push_back(line);
+
+            block->streams |= 1u << static_cast<quint8>(line.stream);
+            block->firstTime = std::min(block->firstTime, line.timestamp);
+            block->lastTime = std::max(block->lastTime, line.timestamp);
+            block->minRun = std::min(block->minRun, line.runId);
+            block->maxRun = std::max(block->maxRun, line.runId);
+        }
+        for (const std::size_t bit : bits)
+        {
+            block->trigrams.set(bit);
+        }
+        m_end = block->firstSequence + block->lines.size();
+
+        if (qsizetype(block->lines.size()) == BlockLines)
+        {
+            block->text.squeeze();
+            m_blocks.push_back(std::move(m_open));
+            m_open.reset();
+        }
+        i += count;
+    }
+}
+
+QFuture<OutputIndex::Result> OutputIndex::search(const OutputQuery& query)
+{
+    auto search = std::make_shared<Search>();
+    search->query = query;
+    search->generation = m_generation->fetch_add(1, std::memory_order_relaxed) + 1;
+    search->latest = m_generation;
+    search->promise = std::make_shared<QPromise<Result>>();
+    search->timer.start();
+
+    QFuture<Result> future = search->promise->future();
+    search->promise->start();
+
+    // After the batches posted before it, so it sees every line the console showed when it was asked
+    m_strand->post([this, search]
+    {
+        {
+            std::lock_guard lock(m_mutex);
+            search->blocks = m_blocks;
+            if (m_open)
+            {
+                search->blocks.push_back(std::make_shared<const Block>(*m_open));
+            }
+            search->end = m_end;
+        }
+
+        const std::size_t parts = std::clamp<std::size_t>(search->blocks.size() / BlocksPerPart, 1,
+                                                          TaskPool::instance().workerCount());
+        search->parts.resize(parts);
+        search->remaining.store(parts, std::memory_order_relaxed);
+
+        // The parts never wait for each other, the last one to finish reports
+        for (std::size_t part = 0; part < parts; ++part)
+        {
+            TaskPool::instance().post([search, part] { scan(search, part); });
+        }
+    });
+
+    return future;
+}
+
+void OutputIndex::scan(const std::shared_ptr<Search>& search, const std::size_t part)
+{
+    const std::size_t parts = search->parts.size();
+    const std::size_t first = search->blocks.size() * part / parts;
+    const std::size_t last = search->blocks.size() * (part + 1) / parts;
+
+    const OutputMatcher matcher(search->query);
+    std::vector<quint64>& found = search->parts[part];
+    for (std::size_t b = first; b < last && matcher.isValid(); ++b)
+    {
+        if (search->latest->load(std::memory_order_relaxed) != search->generation)
+        {
+            break;
+        }
+
+        const Block& block = *search->blocks[b];
+        if (!block.mayMatch(matcher))
+        {
+            continue;
+        }
+
+        const QStringView text = block.text;
+        for (std::size_t i = 0; i < block.lines.size(); ++i)
+        {
+            const Batch::Line& line = block.lines[i];
+            if (matcher.matches(line.timestamp, line.runId, line.stream, text.sliced(line.offset, line.length)))
+            {
+                found.push_back(block.firstSequence + i);
+            }
+        }
+    }
+
+    if (search->remaining.fetch_sub(1, std::memory_order_acq_rel) != 1)
+    {
+        return;
+    }
+
+    // A later search replaced this one, its parts may have stopped early: nothing is reported
+    if (search->latest->load(std::memory_order_relaxed) != search->generation)
+    {
+        search->promise->future().cancel();
+        search->promise->finish();
+        return;
+    }
+
+    // Parts cover the blocks in order, so joining them keeps the sequences ascending
+    Result result;
+    result.end = search->end;
+    for (std::vector<quint64>& sequences : search->parts)
+    {
+        result.sequences.insert(result.sequences.end(), sequences.begin(), sequences.end());
+        std::vector<quint64>().swap(sequences);
+    }
+    result.elapsedMs = search->timer.elapsed();
+
+    search->promise->addResult(std::move(result));
+    search->promise->finish();
+}
@@ -0,0 +1,162 @@
+//
+// Created by talik on 10/18/2026.
+//
+
+#ifndef OUTPUT_INDEX_H
+#define OUTPUT_INDEX_H
+
+#include <atomic>
+#include <bitset>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include <QFuture>
+#include <QRegularExpression>
+#include <QString>
+#include <QStringMatcher>
+
+#include "clients/PSClient/BridgeProtocol.h"
+
+class TaskStrand;
+
+// What the search bar asks for; a default query matches every line
+struct OutputQuery
+{
+    static constexpr quint32 AllStreams = 0xff;
+
+    QString text;
+    bool regex = false;
+    bool caseSensitive = false;
+    // Bit 1 << stream for every OutputStream to show
+    quint32 streams = AllStreams;
+    // 0 for every run
+    quint64 runId = 0;
+    // Milliseconds since the epoch, both inclusive
+    qint64 from = std::numeric_limits<qint64>::min();
+    qint64 to = std::numeric_limits<qint64>::max();
+
+    [[nodiscard]] bool matchesEverything() const;
+};
+
+// A compiled OutputQuery. Not thread safe, every thread makes its own.
+class OutputMatcher
+{
+public:
+    explicit OutputMatcher(const OutputQuery& query);
+
+    // False if the regex does not compile; nothing matches then
+    [[nodiscard]] bool isValid() const { return m_valid; }
+
+    [[nodiscard]] const OutputQuery& query() const { return m_query; }
+
+    [[nodiscard]] bool matches(qint64 timestamp, quint64 runId, bridge::OutputStream stream, QStringView text) const;
+
+    // Hashes of the case folded trigrams every matching line contains
+    [[nodiscard]] const std::vector<quint64>& trigrams() const { return m_trigrams; }
+
+private:
+    OutputQuery m_query;
+    QStringMatcher m_matcher;
+    QRegularExpression m_regex;
+    std::vector<quint64> m_trigrams;
+    bool m_valid = true;
+};
+
+/**
+ * Searchable copy of the console's lines, kept by a worker.
+ *
+ * The GUI thread hands over every batch of lines the console shows; a strand
+ * on the TaskPool files them into blocks of BlockLines lines. Every block keeps
+ * the streams, runs and time span of its lines and a Bloom filter of their
+ * case folded trigrams, so a search skips most blocks without reading them:
+ * a rare word is only looked for in the few blocks that may hold it. The
+ * blocks that are left are scanned on several workers at once.
+ */
+class OutputIndex final
+{
+public:
+    // Lines of the console in the order it shows them, with consecutive sequence numbers
+    struct Batch
+    {
+        struct Line
+        {
+            qint64 timestamp = 0;
+            quint64 runId = 0;
+            quint32 offset = 0;
+            quint32 length = 0;
+            bridge::OutputStream stream = bridge::OutputStream::Output;
+        };
+
+        quint64 firstSequence = 0;
+        QString text;
+        std::vector<Line> lines;
+    };
+
+    struct Result
+    {
+        // Ascending
+        std::vector<quint64> sequences;
+        // One past the last line searched, every line added before search() was called
+        quint64 end = 0;
+        qint64 elapsedMs = 0;
+    };
+
+    OutputIndex();
+
+    // Waits for the batches still being filed
+    ~OutputIndex();
+
+    OutputIndex(const OutputIndex&) = delete;
+
+    OutputIndex& operator=(const OutputIndex&) = delete;
+
+    void add(Batch batch);
+
+    // Forgets the lines before sequence, once the console dropped them
+    void dropBefore(quint64 sequence);
+
+    // Finds the matching lines among those added so far. A later search makes this one stop early,
+    // and its future is cancelled rather than given what it found so far.
+    QFuture<Result> search(const OutputQuery& query);
+
+private:
+    static constexpr qsizetype BlockLines = 256;
+    static constexpr std::size_t BloomBits = 32 * 1024;
+
+    struct Block
+    {
+        quint64 firstSequence = 0;
+        QString text;
+        std::vector<Batch::Line> lines;
+
+        // Summary of the lines, for skipping the block
+        quint32 streams = 0;
+        qint64 firstTime = std::numeric_limits<qint64>::max();
+        qint64 lastTime = std::numeric_limits<qint64>::min();
+        quint64 minRun = std::numeric_limits<quint64>::max();
+        quint64 maxRun = 0;
+        std::bitset<BloomBits> trigrams;
+
+        [[nodiscard]] bool mayMatch(const OutputMatcher& matcher) const;
+    };
+
+    struct Search;
+
+    std::unique_ptr<TaskStrand> m_strand;
+    // Shared with the searches in flight, which stop once it moved past theirs
+    std::shared_ptr<std::atomic<quint64>> m_generation;
+
+    // Blocks are filled on the strand and read by searches
+    std::mutex m_mutex;
+    std::vector<std::shared_ptr<const Block>> m_blocks;
+    std::shared_ptr<Block> m_open;
+    quint64 m_end = 0;
+
+    // On the strand
+    void file(const Batch& batch);
+
+    static void scan(const std::shared_ptr<Search>& search, std::size_t part);
+};
+
+#endif //OUTPUT_INDEX_H
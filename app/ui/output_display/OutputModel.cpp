@@ -0,0 +1,223 @@
+//
+// Created by talik on 10/18/2026.
+//
+
+#include "OutputModel.h"
+
+#include <algorithm>
+#include <QBrush>
+#include <QDateTime>
+
+OutputModel::OutputModel(QObject* parent) : QAbstractListModel(parent)
+{
+    m_frame.setSingleShot(true);
+    m_frame.setInterval(FrameInterval);
+    connect(&m_frame, &QTimer::timeout, this, &OutputModel::flush);
+}
+
+qsizetype OutputModel::append(const quint64 runId, const bridge::OutputStream stream, QStringView text)
+{
+    if (text.isEmpty())
+    {
+        return 0;
+    }
+
+    // The newline ends the last line rather than starting an empty one
+    if (text.endsWith(u'\n'))
+    {
+        text.chop(1);
+    }
+
+    const qint64 now = QDateTime::currentMSecsSinceEpoch();
+    qsizetype lines = 0;
+    for (qsizetype start = 0;;)
+    {
+        const qsizetype end = text.indexOf(u'\n', start);
+        QStringView line = text.sliced(start, (end < 0 ? text.size() : end) - start);
+        if (line.endsWith(u'\r'))
+        {
+            line.chop(1);
+        }
+
+        OutputRecord record{.timestamp = now, .runId = runId, .stream = stream};
+        store(line, record);
+        m_pending.push_back(record);
+        ++lines;
+
+        if (end < 0)
+        {
+            break;
+        }
+        start = end + 1;
+    }
+
+    // A single huge append must not hold more than the ring does until the next frame
+    if (qsizetype(m_pending.size()) >= MaxRecords || qsizetype(m_chunks.size()) > MaxChunks)
+    {
+        flush();
+    }
+    else if (!m_frame.isActive())
+    {
+        m_frame.start();
+    }
+    return lines;
+}
+
+void OutputModel::flush()
+{
+    m_frame.stop();
+    if (m_pending.empty())
+    {
+        return;
+    }
+
+    // Lines whose text is in a chunk past MaxChunks from the newest are dropped, shown or not
+    const quint64 endChunk = m_firstChunk + m_chunks.size();
+    const quint64 keptChunk = endChunk > quint64(MaxChunks) ? endChunk - MaxChunks : 0;
+    m_pending.erase(m_pending.begin(), std::ranges::find_if(m_pending, [keptChunk](const OutputRecord& record)
+    {
+        return record.chunk >= keptChunk;
+    }));
+
+    // More lines than the ring holds came in one frame, only the newest are kept
+    if (qsizetype(m_pending.size()) > MaxRecords)
+    {
+        m_pending.erase(m_pending.begin(), m_pending.end() - MaxRecords);
+    }
+
+    qsizetype dropped = std::max<qsizetype>(0, m_count + qsizetype(m_pending.size()) - MaxRecords);
+    while (dropped < m_count && at(dropped).chunk < keptChunk)
+    {
+        ++dropped;
+    }
+    dropFront(dropped);
+
+    // Chunks before the oldest line left are no longer needed
+    const quint64 oldestChunk = m_count > 0 ? at(0).chunk : m_pending.front().chunk;
+    while (m_firstChunk < oldestChunk)
+    {
+        m_chunks.pop_front();
+        ++m_firstChunk;
+    }
+
+    beginInsertRows(QModelIndex(), int(m_count), int(m_count + qsizetype(m_pending.size()) - 1));
+    for (const OutputRecord& record : m_pending)
+    {
+        if (m_count == qsizetype(m_records.size()))
+        {
+            // Grows up to MaxRecords; below it the ring is full only after chunks were dropped, and is
+            // straightened first
+            std::rotate(m_records.begin(), m_records.begin() + m_start, m_records.end());
+            m_start = 0;
+            m_records.push_back(record);
+        }
+        else
+        {
+            m_records[(m_start + m_count) % qsizetype(m_records.size())] = record;
+        }
+        ++m_count;
+    }
+    m_pending.clear();
+    endInsertRows();
+}
+
+int OutputModel::rowCount(const QModelIndex& parent) const
+{
+    return parent.isValid() ? 0 : int(m_count);
+}
+
+QVariant OutputModel::data(const QModelIndex& index, const int role) const
+{
+    if (!index.isValid() || index.row() >= m_count)
+    {
+        return {};
+    }
+
+    const OutputRecord& record = at(index.row());
+    switch (role)
+    {
+    case Qt::DisplayRole:
+        return text(record).toString();
+    case Qt::ForegroundRole:
+        return QBrush(colorFor(record.stream));
+    case Qt::ToolTipRole:
+        {
+            const QString time = QDateTime::fromMSecsSinceEpoch(record.timestamp).toString("yyyy-MM-dd hh:mm:ss.zzz");
+            return record.runId == 0 ? time : QString("%1 · run %2").arg(time).arg(record.runId);
+        }
+    case StreamRole:
+        return static_cast<int>(record.stream);
+    case RunIdRole:
+        return record.runId;
+    case TimestampRole:
+        return record.timestamp;
+    default:
+        return {};
+    }
+}
+
+const OutputRecord& OutputModel::record(const quint64 sequence) const
+{
+    return at(qsizetype(sequence - m_firstSequence));
+}
+
+QStringView OutputModel::text(const OutputRecord& record) const
+{
+    return QStringView(m_chunks[record.chunk - m_firstChunk]).sliced(record.offset, record.length);
+}
+
+QColor OutputModel::colorFor(const bridge::OutputStream stream)
+{
+    switch (stream)
+    {
+    case bridge::OutputStream::Error:
+        return QColor("#FF6347");
+    case bridge::OutputStream::Warning:
+        return QColor("#FFD700");
+    case bridge::OutputStream::Verbose:
+    case bridge::OutputStream::Debug:
+        return QColor("#A0A0A0");
+    default:
+        return QColor("#FFFFFF");
+    }
+}
+
+const OutputRecord& OutputModel::at(const qsizetype row) const
+{
+    return m_records[(m_start + row) % qsizetype(m_records.size())];
+}
+
+void OutputModel::store(QStringView line, OutputRecord& record)
+{
+    // A chunk holds its lines whole, longer lines are cut
+    if (line.size() > ChunkChars)
+    {
+        line.truncate(ChunkChars);
+    }
+
+    // Chunks never grow past what they reserved, so spans of them stay put
+    if (m_chunks.empty() || m_chunks.back().size() + line.size() > ChunkChars)
+    {
+        m_chunks.emplace_back().reserve(ChunkChars);
+    }
+
+    QString& chunk = m_chunks.back();
+    record.chunk = m_firstChunk + m_chunks.size() - 1;
+    record.offset = quint32(chunk.size());
+    record.length = quint32(line.size());
+    chunk.append(line);
+}
+
+void OutputModel::dropFront(const qsizetype count)
+{
+    if (count <= 0)
+    {
+        return;
+    }
+
+    beginRemoveRows(QModelIndex(), 0, int(count - 1));
+    m_start = (m_start + count) % qsizetype(m_records.size());
+    m_count -= count;
+    m_firstSequence += quint64(count);
+    endRemoveRows();
+}
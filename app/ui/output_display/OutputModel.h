@@ -0,0 +1,121 @@
+//
+// Created by talik on 10/18/2026.
+//
+
+#ifndef OUTPUT_MODEL_H
+#define OUTPUT_MODEL_H
+
+#include <deque>
+#include <vector>
+#include <QAbstractListModel>
+#include <QColor>
+#include <QString>
+#include <QStringView>
+#include <QTimer>
+
+#include "clients/PSClient/BridgeProtocol.h"
+
+// One line of output. Its text is a span of a chunk of OutputModel's text arena.
+struct OutputRecord
+{
+    // Milliseconds since the epoch at which the line arrived
+    qint64 timestamp = 0;
+    // 0 for lines that belong to no run
+    quint64 runId = 0;
+    quint64 chunk = 0;
+    quint32 offset = 0;
+    quint32 length = 0;
+    bridge::OutputStream stream = bridge::OutputStream::Output;
+};
+
+/**
+ * Every line the console has shown, newest last, in a ring of at most
+ * MaxRecords lines and MaxChunks chunks of text; the oldest lines are dropped
+ * beyond either, so memory stays bounded however much a script prints.
+ *
+ * append() is O(1) per line: the text is copied into the current chunk of the
+ * arena and the record is queued. Queued records become rows once per frame,
+ * in one insert, after one remove of the rows that fell out of the ring; views
+ * lay out and paint only the rows they show.
+ *
+ * Every line also gets a sequence number that never changes, so filtered
+ * views and search results can refer to lines while rows move up as old ones
+ * are dropped: row r holds sequence firstSequence() + r.
+ */
+class OutputModel final : public QAbstractListModel
+{
+    Q_OBJECT
+
+public:
+    enum Role
+    {
+        StreamRole = Qt::UserRole + 1,
+        RunIdRole,
+        TimestampRole,
+    };
+
+    static constexpr qsizetype MaxRecords = 1000000;
+    static constexpr qsizetype ChunkChars = 1024 * 1024;
+    static constexpr qsizetype MaxChunks = 64;
+
+    explicit OutputModel(QObject* parent = nullptr);
+
+    ~OutputModel() override = default;
+
+    // Adds the lines of text, the last one may lack its newline, and returns how many. Shown with the next frame.
+    qsizetype append(quint64 runId, bridge::OutputStream stream, QStringView text);
+
+    // Turns the queued records into rows now
+    void flush();
+
+    [[nodiscard]] int rowCount(const QModelIndex& parent = QModelIndex()) const override;
+
+    [[nodiscard]] QVariant data(const QModelIndex& index, int role = Qt::DisplayRole) const override;
+
+    [[nodiscard]] quint64 firstSequence() const { return m_firstSequence; }
+
+    // One past the last row's sequence
+    [[nodiscard]] quint64 endSequence() const { return m_firstSequence + quint64(m_count); }
+
+    [[nodiscard]] bool contains(const quint64 sequence) const
+    {
+        return sequence >= m_firstSequence && sequence < endSequence();
+    }
+
+    // Only for sequences the model contains()
+    [[nodiscard]] const OutputRecord& record(quint64 sequence) const;
+
+    // Valid until the next flush()
+    [[nodiscard]] QStringView text(const OutputRecord& record) const;
+
+    [[nodiscard]] static QColor colorFor(bridge::OutputStream stream);
+
+private:
+    // How long appends are gathered before they are shown
+    static constexpr int FrameInterval = 16;
+
+    // A ring over m_records: row r is m_records[(m_start + r) % m_records.size()]
+    std::vector<OutputRecord> m_records;
+    qsizetype m_start = 0;
+    qsizetype m_count = 0;
+    quint64 m_firstSequence = 0;
+
+    // Appended and not shown yet
+    std::vector<OutputRecord> m_pending;
+
+    // The text arena; m_chunks.front() has id m_firstChunk
+    std::deque<QString> m_chunks;
+    quint64 m_firstChunk = 0;
+
+    QTimer m_frame;
+
+    [[nodiscard]] const OutputRecord& at(qsizetype row) const;
+
+    // Copies line into the arena and points record at it
+    void store(QStringView line, OutputRecord& record);
+
+    // Drops the oldest count rows
+    void dropFront(qsizetype count);
+};
+
+#endif //OUTPUT_MODEL_H
@@ -0,0 +1,124 @@
+//
+// Created by talik on 10/18/2026.
+//
+
+#include "OutputSearchBar.h"
+
+#include <utility>
+#include <QComboBox>
+#include <QDateTime>
+#include <QHBoxLayout>
+#include <QLabel>
+#include <QLineEdit>
+#include <QRegularExpression>
+#include <QRegularExpressionValidator>
+#include <QToolButton>
+
+namespace
+{
+    // How far back each entry of the time combo box reaches, 0 for all the way
+    constexpr qint64 TimeSpans[] = {0, 5 * 60 * 1000, 60 * 60 * 1000, 24 * 60 * 60 * 1000};
+}
+
+OutputSearchBar::OutputSearchBar(QWidget* parent) : QWidget(parent)
+{
+    m_text = new QLineEdit(this);
+    m_text->setPlaceholderText(tr("Search output"));
+    m_text->setClearButtonEnabled(true);
+
+    m_regex = new QToolButton(this);
+    m_regex->setText(".*");
+    m_regex->setToolTip(tr("Regular expression"));
+    m_regex->setCheckable(true);
+
+    m_caseSensitive = new QToolButton(this);
+    m_caseSensitive->setText("Aa");
+    m_caseSensitive->setToolTip(tr("Match case"));
+    m_caseSensitive->setCheckable(true);
+
+    // Item data is the stream's bit in OutputQuery::streams
+    m_stream = new QComboBox(this);
+    m_stream->addItem(tr("All streams"), OutputQuery::AllStreams);
+    for (const auto& [stream, name] : {
+             std::pair{bridge::OutputStream::Output, tr("Output")},
+             std::pair{bridge::OutputStream::Error, tr("Error")},
+             std::pair{bridge::OutputStream::Warning, tr("Warning")},
+             std::pair{bridge::OutputStream::Information, tr("Information")},
+             std::pair{bridge::OutputStream::Verbose, tr("Verbose")},
+             std::pair{bridge::OutputStream::Debug, tr("Debug")},
+         })
+    {
+        m_stream->addItem(name, 1u << static_cast<quint8>(stream));
+    }
+
+    m_runId = new QLineEdit(this);
+    m_runId->setPlaceholderText(tr("Run"));
+    m_runId->setValidator(new QRegularExpressionValidator(QRegularExpression("[0-9]{0,19}"), m_runId));
+    m_runId->setFixedWidth(60);
+
+    m_time = new QComboBox(this);
+    m_time->addItems({tr("Any time"), tr("Last 5 minutes"), tr("Last hour"), tr("Last day")});
+
+    m_status = new QLabel(this);
+
+    const auto layout = new QHBoxLayout(this);
+    layout->setContentsMargins(4, 2, 4, 2);
+    layout->setSpacing(4);
+    layout->addWidget(m_text, 1);
+    layout->addWidget(m_regex);
+    layout->addWidget(m_caseSensitive);
+    layout->addWidget(m_stream);
+    layout->addWidget(m_runId);
+    layout->addWidget(m_time);
+    layout->addWidget(m_status);
+
+    m_debounce.setSingleShot(true);
+    m_debounce.setInterval(Debounce);
+    connect(&m_debounce, &QTimer::timeout, this, [this]
+    {
+        const OutputQuery query = this->query();
+        if (query.regex && !query.text.isEmpty() && !QRegularExpression(query.text).isValid())
+        {
+            m_text->setStyleSheet("border: 1px solid #c42b1c;");
+            m_status->setText(tr("Invalid pattern"));
+            return;
+        }
+        m_text->setStyleSheet({});
+        m_status->clear();
+        emit queryChanged(query);
+    });
+
+    connect(m_text, &QLineEdit::textChanged, this, &OutputSearchBar::changed);
+    connect(m_runId, &QLineEdit::textChanged, this, &OutputSearchBar::changed);
+    connect(m_regex, &QToolButton::toggled, this, &OutputSearchBar::changed);
+    connect(m_caseSensitive, &QToolButton::toggled, this, &OutputSearchBar::changed);
+    connect(m_stream, &QComboBox::currentIndexChanged, this, &OutputSearchBar::changed);
+    connect(m_time, &QComboBox::currentIndexChanged, this, &OutputSearchBar::changed);
+}
+
+OutputQuery OutputSearchBar::query() const
+{
+    OutputQuery query;
+    query.text = m_text->text();
+    query.regex = m_regex->isChecked();
+    query.caseSensitive = m_caseSensitive->isChecked();
+    query.streams = m_stream->currentData().toUInt();
+    query.runId = m_runId->text().toULongLong();
+
+    // Relative to when the query is made; later lines are newer anyway
+    if (const qint64 span = TimeSpans[m_time->currentIndex()]; span > 0)
+    {
+        query.from = QDateTime::currentMSecsSinceEpoch() - span;
+    }
+    return query;
+}
+
+void OutputSearchBar::setResult(const qsizetype matches, const qint64 elapsedMs) const
+{
+    m_status->setText(tr("%n match(es) in %1 ms", nullptr, int(qMin<qsizetype>(matches, std::numeric_limits<int>::max()))).arg(elapsedMs));
+}
+
+void OutputSearchBar::changed()
+{
+    m_debounce.start();
+}
@@ -0,0 +1,57 @@
+//
+// Created by talik on 10/18/2026.
+//
+
+#ifndef OUTPUT_SEARCH_BAR_H
+#define OUTPUT_SEARCH_BAR_H
+
+#include <QTimer>
+#include <QWidget>
+
+#include "OutputIndex.h"
+
+class QComboBox;
+class QLabel;
+class QLineEdit;
+class QToolButton;
+
+/**
+ * Search and filter controls above the console: text or regex, stream, run
+ * and time span. Edits are gathered for a moment before queryChanged(), so
+ * typing a word costs one search rather than one per key.
+ */
+class OutputSearchBar final : public QWidget
+{
+    Q_OBJECT
+
+signals:
+    // A default query when the bar was cleared
+    void queryChanged(const OutputQuery& query);
+
+public:
+    explicit OutputSearchBar(QWidget* parent = nullptr);
+
+    ~OutputSearchBar() override = default;
+
+    [[nodiscard]] OutputQuery query() const;
+
+    // Shows how a search for the current query went
+    void setResult(qsizetype matches, qint64 elapsedMs) const;
+
+private:
+    static constexpr int Debounce = 150;
+
+    QLineEdit* m_text;
+    QToolButton* m_regex;
+    QToolButton* m_caseSensitive;
+    QComboBox* m_stream;
+    QLineEdit* m_runId;
+    QComboBox* m_time;
+    QLabel* m_status;
+
+    QTimer m_debounce;
+
+    void changed();
+};
+
+#endif //OUTPUT_SEARCH_BAR_H
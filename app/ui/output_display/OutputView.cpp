@@ -0,0 +1,97 @@
+//
+// Created by talik on 10/18/2026.
+//
+
+#include "OutputView.h"
+
+#include <algorithm>
+#include <QAction>
+#include <QClipboard>
+#include <QFontDatabase>
+#include <QGuiApplication>
+#include <QScrollBar>
+
+OutputView::OutputView(QAbstractItemModel* model, QWidget* parent) : QListView(parent)
+{
+    QPalette palette = this->palette();
+    palette.setColor(QPalette::Highlight, QColor(0, 120, 215));
+    palette.setColor(QPalette::Text, QColor(Qt::white));
+    setPalette(palette);
+
+    setFont(QFontDatabase::systemFont(QFontDatabase::FixedFont));
+    setUniformItemSizes(true);
+    setWordWrap(false);
+    setEditTriggers(NoEditTriggers);
+    setSelectionMode(ExtendedSelection);
+    // A scroll value is a row, which keeps the position easy to hold when rows go
+    setVerticalScrollMode(ScrollPerItem);
+    setVerticalScrollBarPolicy(Qt::ScrollBarAsNeeded);
+    setMinimumHeight(550);
+
+    const auto copy = new QAction(tr("Copy"), this);
+    copy->setShortcut(QKeySequence::Copy);
+    copy->setShortcutContext(Qt::WidgetShortcut);
+    connect(copy, &QAction::triggered, this, [this] { QGuiApplication::clipboard()->setText(selectedText()); });
+    addAction(copy);
+    setContextMenuPolicy(Qt::ActionsContextMenu);
+
+    setModel(model);
+}
+
+void OutputView::setModel(QAbstractItemModel* model)
+{
+    for (const QMetaObject::Connection& connection : std::as_const(m_modelConnections))
+    {
+        disconnect(connection);
+    }
+    m_modelConnections.clear();
+
+    QListView::setModel(model);
+    m_following = true;
+    if (model == nullptr)
+    {
+        return;
+    }
+
+    m_modelConnections = {
+        connect(model, &QAbstractItemModel::rowsAboutToBeInserted, this, [this]
+        {
+            m_following = verticalScrollBar()->value() == verticalScrollBar()->maximum();
+        }),
+        connect(model, &QAbstractItemModel::rowsInserted, this, [this]
+        {
+            if (m_following)
+            {
+                scrollToBottom();
+            }
+        }),
+        connect(model, &QAbstractItemModel::rowsAboutToBeRemoved, this, [this]
+        {
+            m_scrollValue = verticalScrollBar()->value();
+        }),
+        connect(model, &QAbstractItemModel::rowsRemoved, this,
+                [this](const QModelIndex&, const int first, const int last)
+                {
+                    // Rows only go from the top; the lines on screen stay put if all of them were above it
+                    if (first == 0 && m_scrollValue > last)
+                    {
+                        verticalScrollBar()->setValue(m_scrollValue - (last + 1));
+                    }
+                }),
+    };
+    scrollToBottom();
+}
+
+QString OutputView::selectedText() const
+{
+    QModelIndexList rows = selectionModel()->selectedRows();
+    std::ranges::sort(rows, {}, &QModelIndex::row);
+
+    QStringList lines;
+    lines.reserve(rows.size());
+    for (const QModelIndex& row : rows)
+    {
+        lines.append(row.data().toString());
+    }
+    return lines.join('\n');
+}
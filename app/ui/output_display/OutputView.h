@@ -0,0 +1,41 @@
+//
+// Created by talik on 10/18/2026.
+//
+
+#ifndef OUTPUT_VIEW_H
+#define OUTPUT_VIEW_H
+
+#include <QList>
+#include <QListView>
+
+/**
+ * Read-only console over an OutputModel or OutputFilterModel, one line per row.
+ *
+ * Rows all have the same height, so the view lays out and paints only the rows
+ * on screen however many there are. It follows new lines while scrolled to the
+ * bottom, and keeps the same lines on screen when the oldest ones are dropped
+ * while the user reads further up.
+ */
+class OutputView final : public QListView
+{
+    Q_OBJECT
+
+public:
+    explicit OutputView(QAbstractItemModel* model, QWidget* parent = nullptr);
+
+    ~OutputView() override = default;
+
+    // Shows model from its last line on, as the console switches between all lines and a search's
+    void setModel(QAbstractItemModel* model) override;
+
+    // The selected lines in order, one per line
+    [[nodiscard]] QString selectedText() const;
+
+private:
+    // To the current model, for following its rows
+    QList<QMetaObject::Connection> m_modelConnections;
+    bool m_following = true;
+    int m_scrollValue = 0;
+};
+
+#endif //OUTPUT_VIEW_H
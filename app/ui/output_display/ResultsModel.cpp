@@ -0,0 +1,699 @@
+//
+// Created by talik on 10/18/2026.
+//
+
+#include "ResultsModel.h"
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <numeric>
+#include <optional>
+#include <QLocale>
+#include <QSaveFile>
+#include <QStringMatcher>
+
+#include "TaskPool.h"
+
+namespace
+{
+    using Kind = bridge::RecordValue::Kind;
+
+    // Export writes the file in pieces of about this size
+    constexpr qsizetype ExportBuffer = 1024 * 1024;
+
+    // A sort or filter checks this often whether a newer one replaced it
+    constexpr qsizetype CheckEvery = 4096;
+
+    // Cell index of a chunk; a column the chunk does not have is null
+    bridge::RecordValue cellOf(const auto& chunk, const qsizetype index, const int column)
+    {
+        bridge::RecordValue value;
+        if (column >= qsizetype(chunk.columns.size()))
+        {
+            return value;
+        }
+
+        const auto& data = chunk.columns[std::size_t(column)];
+        const quint64 bits = data.values[std::size_t(index)];
+        value.kind = static_cast<Kind>(data.kinds[std::size_t(index)]);
+        switch (value.kind)
+        {
+        case Kind::Bool:
+            value.boolean = bits != 0;
+            break;
+        case Kind::Integer:
+            value.integer = qint64(bits);
+            break;
+        case Kind::Double:
+        case Kind::DateTime:
+            value.number = std::bit_cast<double>(bits);
+            break;
+        case Kind::Text:
+        case Kind::Bytes:
+            value.bytes = QByteArrayView(data.text).sliced(qsizetype(bits >> 32), qsizetype(bits & 0xffffffffu));
+            break;
+        case Kind::Null:
+            break;
+        }
+        return value;
+    }
+
+    // Case insensitive containment. ASCII needles are looked for in the UTF-8 of text cells without decoding them.
+    class CellMatcher
+    {
+    public:
+        explicit CellMatcher(const QString& needle) : m_matcher(needle, Qt::CaseInsensitive)
+        {
+            if (std::ranges::all_of(needle, [](const QChar ch) { return ch.unicode() < 0x80; }))
+            {
+                m_ascii = needle.toLatin1().toLower();
+            }
+        }
+
+        [[nodiscard]] bool matches(const bridge::RecordValue& value) const
+        {
+            if (value.kind == Kind::Null)
+            {
+                return false;
+            }
+            if (value.kind == Kind::Text && !m_ascii.isEmpty())
+            {
+                return std::search(value.bytes.begin(), value.bytes.end(), m_ascii.begin(), m_ascii.end(),
+                                   [](const char a, const char b)
+                                   {
+                                       return (a >= 'A' && a <= 'Z' ? char(a + ('a' - 'A')) : a) == b;
+                                   }) != value.bytes.end();
+            }
+            return m_matcher.indexIn(value.toString()) >= 0;
+        }
+
+    private:
+        QStringMatcher m_matcher;
+        QByteArray m_ascii;
+    };
+
+    // Objects of chunks in the order to show them, or nothing if a newer arrangement was asked for
+    std::optional<std::vector<quint32>> arrangeRows(const auto& chunks, const qsizetype rows, const int column,
+                                                    const Qt::SortOrder order, const QString& filter,
+                                                    const std::atomic<quint64>& latest, const quint64 generation)
+    {
+        const auto stale = [&latest, generation] { return latest.load(std::memory_order_relaxed) != generation; };
+
+        std::vector<quint32> objects;
+        if (filter.isEmpty())
+        {
+            objects.resize(std::size_t(rows));
+            std::iota(objects.begin(), objects.end(), 0u);
+        }
+        else
+        {
+            const CellMatcher matcher(filter);
+            for (qsizetype object = 0; object < rows; ++object)
+            {
+                if (object % CheckEvery == 0 && stale())
+                {
+                    return std::nullopt;
+                }
+
+                const auto& chunk = *chunks[std::size_t(object / ResultsModel::ChunkRows)];
+                const qsizetype index = object % ResultsModel::ChunkRows;
+                for (int c = 0; c < int(chunk.columns.size()); ++c)
+                {
+                    if (matcher.matches(cellOf(chunk, index, c)))
+                    {
+                        objects.push_back(quint32(object));
+                        break;
+                    }
+                }
+            }
+        }
+
+        if (column < 0)
+        {
+            return objects;
+        }
+
+        // Nulls first, then numbers, dates, text and bytes, like Sort-Object keeps kinds apart
+        struct Key
+        {
+            int rank = 0;
+            double number = 0;
+            QString text;
+        };
+
+        std::vector<Key> keys(objects.size());
+        for (std::size_t i = 0; i < objects.size(); ++i)
+        {
+            if (qsizetype(i) % CheckEvery == 0 && stale())
+            {
+                return std::nullopt;
+            }
+
+            const qsizetype object = objects[i];
+            const bridge::RecordValue value = cellOf(*chunks[std::size_t(object / ResultsModel::ChunkRows)],
+                                                     object % ResultsModel::ChunkRows, column);
+            switch (value.kind)
+            {
+            case Kind::Null:
+                break;
+            case Kind::Bool:
+                keys[i] = {1, value.boolean ? 1.0 : 0.0};
+                break;
+            case Kind::Integer:
+                keys[i] = {1, double(value.integer)};
+                break;
+            case Kind::Double:
+                keys[i] = {1, value.number};
+                break;
+            case Kind::DateTime:
+                keys[i] = {2, value.number};
+                break;
+            case Kind::Text:
+                keys[i] = {3, 0, QString::fromUtf8(value.bytes)};
+                break;
+            case Kind::Bytes:
+                keys[i] = {4, 0, value.toString()};
+                break;
+            }
+        }
+
+        const auto less = [&keys](const quint32 a, const quint32 b)
+        {
+            const Key& x = keys[a];
+            const Key& y = keys[b];
+            if (x.rank != y.rank)
+            {
+                return x.rank < y.rank;
+            }
+            return x.rank >= 3 ? x.text.compare(y.text, Qt::CaseInsensitive) < 0 : x.number < y.number;
+        };
+
+        // Positions into objects, so equal keys keep the order the objects came in
+        std::vector<quint32> positions(objects.size());
+        std::iota(positions.begin(), positions.end(), 0u);
+        if (order == Qt::AscendingOrder)
+        {
+            std::ranges::stable_sort(positions, less);
+        }
+        else
+        {
+            std::ranges::stable_sort(positions, [&less](const quint32 a, const quint32 b) { return less(b, a); });
+        }
+        if (stale())
+        {
+            return std::nullopt;
+        }
+
+        std::vector<quint32> sorted(objects.size());
+        for (std::size_t i = 0; i < positions.size(); ++i)
+        {
+            sorted[i] = objects[positions[i]];
+        }
+        return sorted;
+    }
+
+    void appendCsv(QByteArray& out, const bridge::RecordValue& value)
+    {
+        if (value.kind != Kind::Text)
+        {
+            out += value.toString().toUtf8();
+            return;
+        }
+
+        if (!value.bytes.contains(',') && !value.bytes.contains('"') && !value.bytes.contains('\n') &&
+            !value.bytes.contains('\r'))
+        {
+            out.append(value.bytes);
+            return;
+        }
+        out += '"';
+        for (const char ch : value.bytes)
+        {
+            if (ch == '"')
+            {
+                out += '"';
+            }
+            out += ch;
+        }
+        out += '"';
+    }
+
+    void appendJsonString(QByteArray& out, const QByteArrayView utf8)
+    {
+        out += '"';
+        for (const char ch : utf8)
+        {
+            switch (ch)
+            {
+            case '"':
+                out += "\\\"";
+                break;
+            case '\\':
+                out += "\\\\";
+                break;
+            case '\n':
+                out += "\\n";
+                break;
+            case '\r':
+                out += "\\r";
+                break;
+            case '\t':
+                out += "\\t";
+                break;
+            default:
+                if (static_cast<unsigned char>(ch) < 0x20)
+                {
+                    out += "\\u00";
+                    out += QByteArray::number(static_cast<unsigned char>(ch), 16).rightJustified(2, '0');
+                }
+                else
+                {
+                    out += ch;
+                }
+            }
+        }
+        out += '"';
+    }
+
+    void appendJson(QByteArray& out, const bridge::RecordValue& value)
+    {
+        switch (value.kind)
+        {
+        case Kind::Null:
+            out += "null";
+            break;
+        case Kind::Bool:
+            out += value.boolean ? "true" : "false";
+            break;
+        case Kind::Integer:
+            out += QByteArray::number(value.integer);
+            break;
+        case Kind::Double:
+            out += std::isfinite(value.number)
+                       ? QByteArray::number(value.number, 'g', QLocale::FloatingPointShortest)
+                       : QByteArray("null");
+            break;
+        case Kind::Text:
+            appendJsonString(out, value.bytes);
+            break;
+        case Kind::DateTime:
+        case Kind::Bytes:
+            appendJsonString(out, value.toString().toUtf8());
+            break;
+        }
+    }
+}
+
+ResultsModel::ResultsModel(QObject* parent)
+    : QAbstractTableModel(parent), m_generation(std::make_shared<std::atomic<quint64>>(0))
+{
+    m_rearrange.setSingleShot(true);
+    m_rearrange.setInterval(RearrangeDelay);
+    connect(&m_rearrange, &QTimer::timeout, this, &ResultsModel::arrange);
+}
+
+ResultsModel::~ResultsModel()
+{
+    m_generation->fetch_add(1, std::memory_order_relaxed);
+}
+
+void ResultsModel::append(const bridge::RecordBatch& batch)
+{
+    bridge::RecordReader reader(batch);
+    while (reader.next())
+    {
+        appendRow(reader, columnsOf(reader.type()));
+    }
+
+    // Sorted or filtered rows are arranged again once the objects stop for a moment
+    if (m_arranged)
+    {
+        if (!m_rearrange.isActive())
+        {
+            m_rearrange.start();
+        }
+        return;
+    }
+
+    if (m_rows > m_shown)
+    {
+        beginInsertRows(QModelIndex(), int(m_shown), int(m_rows - 1));
+        m_shown = m_rows;
+        endInsertRows();
+    }
+}
+
+const QList<int>& ResultsModel::columnsOf(const bridge::RecordType& type)
+{
+    // The property lists are usually shared with the batch's types, so comparing them is cheap
+    QList<TypeColumns>& known = m_typeColumns[type.name];
+    for (const TypeColumns& entry : std::as_const(known))
+    {
+        if (entry.properties == type.properties)
+        {
+            return entry.columns;
+        }
+    }
+
+    QList<int> columns;
+    columns.reserve(type.properties.size());
+    for (const QString& property : type.properties)
+    {
+        if (const auto it = m_columnByName.constFind(property); it != m_columnByName.constEnd())
+        {
+            columns.append(*it);
+            continue;
+        }
+
+        const auto column = int(m_columns.size());
+        beginInsertColumns(QModelIndex(), column, column);
+        m_columns.append(property);
+        m_columnByName.insert(property, column);
+        endInsertColumns();
+        columns.append(column);
+    }
+    known.append({type.properties, columns});
+    return known.back().columns;
+}
+
+void ResultsModel::appendRow(const bridge::RecordReader& reader, const QList<int>& columns)
+{
+    if (!m_open)
+    {
+        m_open = std::make_shared<Chunk>();
+    }
+    Chunk& chunk = *m_open;
+
+    // Columns that appeared since the chunk was started are null for its earlier rows
+    if (chunk.columns.size() < std::size_t(m_columns.size()))
+    {
+        const std::size_t first = chunk.columns.size();
+        chunk.columns.resize(std::size_t(m_columns.size()));
+        for (std::size_t c = first; c < chunk.columns.size(); ++c)
+        {
+            // Grown as rows come in: a small result of a wide type costs as much as its rows
+            ColumnData& data = chunk.columns[c];
+            data.kinds.resize(std::size_t(chunk.rows), quint8(Kind::Null));
+            data.values.resize(std::size_t(chunk.rows), 0);
+        }
+    }
+
+    for (ColumnData& data : chunk.columns)
+    {
+        data.kinds.push_back(quint8(Kind::Null));
+        data.values.push_back(0);
+    }
+
+    const qsizetype count = std::min(reader.size(), columns.size());
+    for (qsizetype i = 0; i < count; ++i)
+    {
+        const bridge::RecordValue& value = reader.value(i);
+        ColumnData& data = chunk.columns[std::size_t(columns[i])];
+        data.kinds.back() = quint8(value.kind);
+        switch (value.kind)
+        {
+        case Kind::Bool:
+            data.values.back() = value.boolean ? 1 : 0;
+            break;
+        case Kind::Integer:
+            data.values.back() = quint64(value.integer);
+            break;
+        case Kind::Double:
+        case Kind::DateTime:
+            data.values.back() = std::bit_cast<quint64>(value.number);
+            break;
+        case Kind::Text:
+        case Kind::Bytes:
+            data.values.back() = quint64(data.text.size()) << 32 | quint64(value.bytes.size());
+            data.text.append(value.bytes);
+            break;
+        case Kind::Null:
+            break;
+        }
+    }
+
+    ++chunk.rows;
+    ++m_rows;
+
+    // Full chunks never change again, so sorts and exports share them
+    if (chunk.rows == ChunkRows)
+    {
+        for (ColumnData& data : chunk.columns)
+        {
+            data.kinds.shrink_to_fit();
+            data.values.shrink_to_fit();
+            data.text.squeeze();
+        }
+        m_full.push_back(std::move(m_open));
+        m_open.reset();
+    }
+}
+
+ResultsModel::Chunks ResultsModel::snapshot() const
+{
+    Chunks chunks = m_full;
+    if (m_open)
+    {
+        chunks.push_back(std::make_shared<const Chunk>(*m_open));
+    }
+    return chunks;
+}
+
+bridge::RecordValue ResultsModel::value(const qsizetype object, const int column) const
+{
+    const auto chunk = std::size_t(object / ChunkRows);
+    return cellOf(chunk < m_full.size() ? *m_full[chunk] : *m_open, object % ChunkRows, column);
+}
+
+int ResultsModel::rowCount(const QModelIndex& parent) const
+{
+    if (parent.isValid())
+    {
+        return 0;
+    }
+    return m_arranged ? int(m_order.size()) : int(m_shown);
+}
+
+int ResultsModel::columnCount(const QModelIndex& parent) const
+{
+    return parent.isValid() ? 0 : int(m_columns.size());
+}
+
+QVariant ResultsModel::data(const QModelIndex& index, const int role) const
+{
+    if (!index.isValid() || index.row() >= rowCount() || index.column() >= columnCount())
+    {
+        return {};
+    }
+
+    const qsizetype object = m_arranged ? m_order[std::size_t(index.row())] : index.row();
+    switch (role)
+    {
+    case Qt::DisplayRole:
+        {
+            // Formatted only now, for the cells on screen; rows are one line high
+            QString text = value(object, index.column()).toString();
+            if (const qsizetype newline = text.indexOf('\n'); newline >= 0)
+            {
+                text = text.left(newline) + " …";
+            }
+            return text;
+        }
+    case Qt::ToolTipRole:
+        {
+            const bridge::RecordValue cell = value(object, index.column());
+            if (cell.kind == Kind::Text && cell.bytes.size() > 80)
+            {
+                return cell.toString();
+            }
+            return {};
+        }
+    case Qt::TextAlignmentRole:
+        {
+            const Kind kind = value(object, index.column()).kind;
+            if (kind == Kind::Integer || kind == Kind::Double)
+            {
+                return QVariant::fromValue(Qt::AlignRight | Qt::AlignVCenter);
+            }
+            return {};
+        }
+    default:
+        return {};
+    }
+}
+
+QVariant ResultsModel::headerData(const int section, const Qt::Orientation orientation, const int role) const
+{
+    if (role != Qt::DisplayRole || section < 0)
+    {
+        return {};
+    }
+    if (orientation == Qt::Horizontal)
+    {
+        return section < m_columns.size() ? m_columns[section] : QVariant();
+    }
+
+    // The number of the object in the order it came, whatever the order shown
+    if (section >= rowCount())
+    {
+        return {};
+    }
+    return qlonglong(m_arranged ? m_order[std::size_t(section)] : section) + 1;
+}
+
+void ResultsModel::sort(const int column, const Qt::SortOrder order)
+{
+    m_sortColumn = column;
+    m_sortOrder = order;
+    arrange();
+}
+
+void ResultsModel::setFilter(const QString& text)
+{
+    if (text == m_filter)
+    {
+        return;
+    }
+    m_filter = text;
+    arrange();
+}
+
+void ResultsModel::arrange()
+{
+    m_rearrange.stop();
+    const quint64 generation = m_generation->fetch_add(1, std::memory_order_relaxed) + 1;
+
+    if (m_sortColumn < 0 && m_filter.isEmpty())
+    {
+        beginResetModel();
+        m_arranged = false;
+        std::vector<quint32>().swap(m_order);
+        m_shown = m_rows;
+        endResetModel();
+        emit busyChanged(false);
+        return;
+    }
+
+    emit busyChanged(true);
+    TaskPool::instance().run([chunks = snapshot(), rows = m_rows, column = m_sortColumn, order = m_sortOrder,
+            filter = m_filter, latest = m_generation, generation]
+        {
+            return arrangeRows(chunks, rows, column, order, filter, *latest, generation);
+        })
+        .then(this, [this, generation](const std::optional<std::vector<quint32>>& order)
+        {
+            // A newer arrangement is on its way
+            if (!order || generation != m_generation->load(std::memory_order_relaxed))
+            {
+                return;
+            }
+
+            beginResetModel();
+            m_arranged = true;
+            m_order = *order;
+            endResetModel();
+            emit busyChanged(false);
+        });
+}
+
+QFuture<qsizetype> ResultsModel::exportTo(const QString& path, const ExportFormat format) const
+{
+    return TaskPool::instance().run([chunks = snapshot(), rows = m_rows, arranged = m_arranged,
+            order = m_arranged ? m_order : std::vector<quint32>(), columns = m_columns, path, format]() -> qsizetype
+    {
+        QSaveFile file(path);
+        if (!file.open(QIODevice::WriteOnly))
+        {
+            return -1;
+        }
+
+        QByteArray out;
+        out.reserve(ExportBuffer + 64 * 1024);
+
+        // Names are escaped once, rows are written straight from the chunks
+        QList<QByteArray> names;
+        for (const QString& column : columns)
+        {
+            QByteArray name;
+            if (format == ExportFormat::Csv)
+            {
+                bridge::RecordValue value;
+                value.kind = Kind::Text;
+                const QByteArray utf8 = column.toUtf8();
+                value.bytes = utf8;
+                appendCsv(name, value);
+            }
+            else
+            {
+                appendJsonString(name, column.toUtf8());
+                name += ':';
+            }
+            names.append(name);
+        }
+
+        if (format == ExportFormat::Csv)
+        {
+            out += names.join(',') + "\r\n";
+        }
+        else
+        {
+            out += "[\n";
+        }
+
+        const qsizetype count = arranged ? qsizetype(order.size()) : rows;
+        for (qsizetype row = 0; row < count; ++row)
+        {
+            const qsizetype object = arranged ? order[std::size_t(row)] : row;
+            const auto& chunk = *chunks[std::size_t(object / ChunkRows)];
+            const qsizetype index = object % ChunkRows;
+
+            if (format == ExportFormat::Csv)
+            {
+                for (int c = 0; c < int(columns.size()); ++c)
+                {
+                    if (c > 0)
+                    {
+                        out += ',';
+                    }
+                    appendCsv(out, cellOf(chunk, index, c));
+                }
+                out += "\r\n";
+            }
+            else
+            {
+                out += row > 0 ? ",\n{" : "{";
+                for (int c = 0; c < int(columns.size()); ++c)
+                {
+                    if (c > 0)
+                    {
+                        out += ',';
+                    }
+                    out += names[c];
+                    appendJson(out, cellOf(chunk, index, c));
+                }
+                out += '}';
+            }
+
+            if (out.size() >= ExportBuffer)
+            {
+                if (file.write(out) != out.size())
+                {
+                    file.cancelWriting();
+                    return -1;
+                }
+                out.resize(0);
+            }
+        }
+
+        if (format == ExportFormat::Json)
+        {
+            out += "\n]\n";
+        }
+        if (file.write(out) != out.size() || !file.commit())
+        {
+            return -1;
+        }
+        return count;
+    });
+}
@@ -0,0 +1,141 @@
+//
+// Created by talik on 10/18/2026.
+//
+
+#ifndef RESULTS_MODEL_H
+#define RESULTS_MODEL_H
+
+#include <atomic>
+#include <memory>
+#include <vector>
+#include <QAbstractTableModel>
+#include <QFuture>
+#include <QHash>
+#include <QStringList>
+#include <QTimer>
+
+#include "clients/PSClient/RecordReader.h"
+
+/**
+ * The objects a run wrote, one row per object and one column per property.
+ *
+ * Values are kept a column at a time in chunks of ChunkRows rows, as the
+ * bridge sent them: numbers as numbers and text as UTF-8, so a row costs
+ * about nine bytes per column plus its text, and nothing is turned into a
+ * QString until a view asks for a cell on screen. Objects of several types
+ * share the columns of the properties they have in common.
+ *
+ * Sorting and filtering run on the TaskPool over a snapshot: the full chunks,
+ * which never change again, and a copy of the one being filled. The result is
+ * the order of the rows to show; rows arriving meanwhile are arranged again
+ * shortly after. Export streams the rows in the order shown straight from
+ * the chunks, also on a worker.
+ */
+class ResultsModel final : public QAbstractTableModel
+{
+    Q_OBJECT
+
+signals:
+    // True while the rows are being sorted or filtered
+    void busyChanged(bool busy);
+
+public:
+    enum class ExportFormat
+    {
+        Csv,
+        Json,
+    };
+
+    static constexpr qsizetype ChunkRows = 16 * 1024;
+
+    explicit ResultsModel(QObject* parent = nullptr);
+
+    // Stops the sort or filter in flight
+    ~ResultsModel() override;
+
+    void append(const bridge::RecordBatch& batch);
+
+    [[nodiscard]] int rowCount(const QModelIndex& parent = QModelIndex()) const override;
+
+    [[nodiscard]] int columnCount(const QModelIndex& parent = QModelIndex()) const override;
+
+    [[nodiscard]] QVariant data(const QModelIndex& index, int role = Qt::DisplayRole) const override;
+
+    [[nodiscard]] QVariant headerData(int section, Qt::Orientation orientation,
+                                      int role = Qt::DisplayRole) const override;
+
+    // On a worker; column -1 restores the order the objects came in
+    void sort(int column, Qt::SortOrder order = Qt::AscendingOrder) override;
+
+    // Shows the rows with a value containing text, whatever the case; on a worker
+    void setFilter(const QString& text);
+
+    // Every object received, shown or not
+    [[nodiscard]] qsizetype totalRows() const { return m_rows; }
+
+    // Writes the rows shown, in their order; the result is the number of rows written, or -1 on failure
+    [[nodiscard]] QFuture<qsizetype> exportTo(const QString& path, ExportFormat format) const;
+
+private:
+    // Waits this long after rows arrived before sorting and filtering again
+    static constexpr int RearrangeDelay = 300;
+
+    // One column of a chunk. Text and bytes are values (offset << 32 | length) into text.
+    struct ColumnData
+    {
+        std::vector<quint8> kinds;
+        std::vector<quint64> values;
+        QByteArray text;
+    };
+
+    struct Chunk
+    {
+        qsizetype rows = 0;
+        // Columns seen after the chunk was started may be missing, their cells are null
+        std::vector<ColumnData> columns;
+    };
+
+    using Chunks = std::vector<std::shared_ptr<const Chunk>>;
+
+    // Column of every property of a type seen
+    struct TypeColumns
+    {
+        QStringList properties;
+        QList<int> columns;
+    };
+
+    QStringList m_columns;
+    QHash<QString, int> m_columnByName;
+    // By type name; types such as PSCustomObject and Hashtable come with many property lists under one name
+    QHash<QString, QList<TypeColumns>> m_typeColumns;
+
+    Chunks m_full;
+    std::shared_ptr<Chunk> m_open;
+    qsizetype m_rows = 0;
+    // Rows views know of; with neither sort nor filter, row r is object r
+    qsizetype m_shown = 0;
+
+    // Objects in the order shown, while sorted or filtered
+    bool m_arranged = false;
+    std::vector<quint32> m_order;
+    int m_sortColumn = -1;
+    Qt::SortOrder m_sortOrder = Qt::AscendingOrder;
+    QString m_filter;
+
+    // Bumped by every arrangement asked for; older ones stop early and are dropped
+    std::shared_ptr<std::atomic<quint64>> m_generation;
+    QTimer m_rearrange;
+
+    // The full chunks and a copy of the open one
+    [[nodiscard]] Chunks snapshot() const;
+
+    [[nodiscard]] const QList<int>& columnsOf(const bridge::RecordType& type);
+
+    void appendRow(const bridge::RecordReader& reader, const QList<int>& columns);
+
+    [[nodiscard]] bridge::RecordValue value(qsizetype object, int column) const;
+
+    void arrange();
+};
+
+#endif //RESULTS_MODEL_H
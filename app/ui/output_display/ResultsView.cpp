@@ -0,0 +1,116 @@
+//
+// Created by talik on 10/18/2026.
+//
+
+#include "ResultsView.h"
+
+#include <QFileDialog>
+#include <QFontMetrics>
+#include <QHBoxLayout>
+#include <QHeaderView>
+#include <QLabel>
+#include <QLineEdit>
+#include <QPushButton>
+#include <QTableView>
+#include <QVBoxLayout>
+
+#include "ResultsModel.h"
+
+ResultsView::ResultsView(QWidget* parent) : QWidget(parent), m_model(new ResultsModel(this))
+{
+    m_filter = new QLineEdit(this);
+    m_filter->setPlaceholderText(tr("Filter objects"));
+    m_filter->setClearButtonEnabled(true);
+
+    m_status = new QLabel(this);
+    m_export = new QPushButton(tr("Export..."), this);
+
+    const auto top = new QHBoxLayout;
+    top->setContentsMargins(4, 2, 4, 2);
+    top->addWidget(m_filter, 1);
+    top->addWidget(m_status);
+    top->addWidget(m_export);
+
+    m_table = new QTableView(this);
+    m_table->setModel(m_model);
+    m_table->setWordWrap(false);
+    m_table->setTextElideMode(Qt::ElideRight);
+    m_table->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    m_table->setSelectionBehavior(QAbstractItemView::SelectRows);
+    m_table->setHorizontalScrollMode(QAbstractItemView::ScrollPerPixel);
+
+    // Fixed rows and interactive columns: nothing is measured beyond what is on screen
+    const int rowHeight = QFontMetrics(m_table->font()).height() + 6;
+    m_table->verticalHeader()->setSectionResizeMode(QHeaderView::Fixed);
+    m_table->verticalHeader()->setDefaultSectionSize(rowHeight);
+    m_table->horizontalHeader()->setSectionResizeMode(QHeaderView::Interactive);
+    m_table->horizontalHeader()->setDefaultSectionSize(160);
+    m_table->horizontalHeader()->setSortIndicatorShown(true);
+
+    // Objects stay in the order they came until a header is clicked
+    m_table->horizontalHeader()->setSortIndicator(-1, Qt::AscendingOrder);
+    m_table->setSortingEnabled(true);
+
+    const auto layout = new QVBoxLayout(this);
+    layout->setContentsMargins(0, 0, 0, 0);
+    layout->setSpacing(0);
+    layout->addLayout(top);
+    layout->addWidget(m_table, 1);
+
+    m_debounce.setSingleShot(true);
+    m_debounce.setInterval(Debounce);
+    connect(&m_debounce, &QTimer::timeout, this, [this] { m_model->setFilter(m_filter->text()); });
+    connect(m_filter, &QLineEdit::textChanged, &m_debounce, qOverload<>(&QTimer::start));
+
+    connect(m_export, &QPushButton::clicked, this, &ResultsView::exportRows);
+    connect(m_model, &ResultsModel::busyChanged, this, [this](const bool busy)
+    {
+        m_busy = busy;
+        updateStatus();
+    });
+    connect(m_model, &QAbstractItemModel::rowsInserted, this, &ResultsView::updateStatus);
+    connect(m_model, &QAbstractItemModel::modelReset, this, &ResultsView::updateStatus);
+
+    updateStatus();
+}
+
+void ResultsView::append(const bridge::RecordBatch& batch)
+{
+    m_model->append(batch);
+}
+
+void ResultsView::updateStatus() const
+{
+    QString text = m_model->rowCount() == m_model->totalRows()
+                       ? tr("%1 objects").arg(m_model->totalRows())
+                       : tr("%1 of %2 objects").arg(m_model->rowCount()).arg(m_model->totalRows());
+    if (m_busy)
+    {
+        text += tr(", arranging...");
+    }
+    m_status->setText(text);
+}
+
+void ResultsView::exportRows()
+{
+    QString format;
+    const QString path = QFileDialog::getSaveFileName(this, tr("Export objects"), QString(),
+                                                      tr("CSV (*.csv);;JSON (*.json)"), &format);
+    if (path.isEmpty())
+    {
+        return;
+    }
+
+    // Rows as shown now; objects arriving meanwhile are left out
+    const ResultsModel::ExportFormat exportFormat = format.startsWith("JSON") || path.endsWith(".json")
+                                                        ? ResultsModel::ExportFormat::Json
+                                                        : ResultsModel::ExportFormat::Csv;
+    m_export->setEnabled(false);
+    m_model->exportTo(path, exportFormat).then(this, [this, path](const qsizetype rows)
+    {
+        m_export->setEnabled(true);
+        m_status->setText(rows < 0
+                              ? tr("Could not write %1").arg(path)
+                              : tr("%1 objects written to %2").arg(rows).arg(path));
+    });
+}
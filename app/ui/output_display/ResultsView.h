@@ -0,0 +1,53 @@
+//
+// Created by talik on 10/18/2026.
+//
+
+#ifndef RESULTS_VIEW_H
+#define RESULTS_VIEW_H
+
+#include <QTimer>
+#include <QWidget>
+
+#include "clients/PSClient/RecordReader.h"
+
+class QLabel;
+class QLineEdit;
+class QPushButton;
+class QTableView;
+class ResultsModel;
+
+/**
+ * Grid of the objects a run wrote, over a ResultsModel: a filter field, the
+ * table and export to CSV or JSON. Rows have a fixed height and columns are
+ * never sized to their contents, so the table only ever formats the cells on
+ * screen. Clicking a column header sorts by it.
+ */
+class ResultsView final : public QWidget
+{
+    Q_OBJECT
+
+public:
+    explicit ResultsView(QWidget* parent = nullptr);
+
+    ~ResultsView() override = default;
+
+    void append(const bridge::RecordBatch& batch);
+
+private:
+    static constexpr int Debounce = 200;
+
+    ResultsModel* m_model;
+    QLineEdit* m_filter;
+    QLabel* m_status;
+    QPushButton* m_export;
+    QTableView* m_table;
+
+    QTimer m_debounce;
+    bool m_busy = false;
+
+    void updateStatus() const;
+
+    void exportRows();
+};
+
+#endif //RESULTS_VIEW_H
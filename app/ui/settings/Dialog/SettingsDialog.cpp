@@ -31,6 +31,7 @@ SettingsDialog::SettingsDialog(QWidget *parent)
     m_tabWidget = new QTabWidget(this);
     m_tabWidget->addTab(createAppearancePage(), "Appearance");
     m_tabWidget->addTab(createEditorPage(), "Editor");
+    m_tabWidget->addTab(createPowerShellPage(), "PowerShell");
     m_tabWidget->addTab(createAccountPage(), "Account");
 
     // --- Bottom Button Box (OK, Cancel, Apply) ---
@@ -138,6 +139,61 @@ QWidget* SettingsDialog::createEditorPage()
     return pageWidget;
 }
 
+QWidget* SettingsDialog::createPowerShellPage()
+{
+    QWidget *pageWidget = new QWidget(this);
+    QFormLayout *layout = new QFormLayout(pageWidget);
+    layout->setSpacing(15);
+
+    QSpinBox *scriptTimeoutSpinBox = new QSpinBox(this);
+    scriptTimeoutSpinBox->setRange(0, 24 * 60 * 60);
+    scriptTimeoutSpinBox->setSpecialValueText("None");
+    scriptTimeoutSpinBox->setSuffix(" s");
+    scriptTimeoutSpinBox->setValue(userPreference.scriptTimeoutSeconds);
+    connect(scriptTimeoutSpinBox, &QSpinBox::valueChanged, this, [this](const int seconds)
+    {
+        userPreference.scriptTimeoutSeconds = seconds;
+    });
+
+    QSpinBox *poolSizeSpinBox = new QSpinBox(this);
+    poolSizeSpinBox->setRange(1, 32);
+    poolSizeSpinBox->setValue(userPreference.runspacePoolSize);
+    connect(poolSizeSpinBox, &QSpinBox::valueChanged, this, [this](const int size)
+    {
+        userPreference.runspacePoolSize = size;
+    });
+
+    QLineEdit *modulesLineEdit = new QLineEdit(this);
+    modulesLineEdit->setPlaceholderText("e.g. Microsoft.Online.SharePoint.PowerShell, ActiveDirectory");
+    modulesLineEdit->setText(userPreference.preloadModules.join(", "));
+    connect(modulesLineEdit, &QLineEdit::textChanged, this, [this](const QString& text)
+    {
+        userPreference.preloadModules.clear();
+        for (const QString& module : text.split(u',', Qt::SkipEmptyParts))
+        {
+            if (const QString name = module.trimmed(); !name.isEmpty())
+            {
+                userPreference.preloadModules.append(name);
+            }
+        }
+    });
+
+    QCheckBox *stickySessionCheckBox = new QCheckBox("Keep variables and imports between runs", this);
+    stickySessionCheckBox->setChecked(userPreference.stickySession);
+    connect(stickySessionCheckBox, &QCheckBox::toggled, this, [this](const bool checked)
+    {
+        userPreference.stickySession = checked;
+    });
+
+    layout->addRow("Script Timeout:", scriptTimeoutSpinBox);
+    layout->addRow("Runspaces:", poolSizeSpinBox);
+    layout->addRow("Preload Modules:", modulesLineEdit);
+    layout->addRow(stickySessionCheckBox);
+
+    pageWidget->setLayout(layout);
+    return pageWidget;
+}
+
 QWidget* SettingsDialog::createAccountPage()
 {
     QWidget *pageWidget = new QWidget(this);
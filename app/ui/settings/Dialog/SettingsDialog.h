@@ -39,6 +39,7 @@ private:
     // Helper functions to create each page of the settings dialog
     QWidget* createAppearancePage();
     QWidget* createEditorPage();
+    QWidget* createPowerShellPage();
     QWidget* createAccountPage();
 
     // Main UI elements
@@ -21,6 +21,11 @@ void SettingsManager::saveSettings(const UserSettings& settings)
     qsettings.setValue("windowPosition", settings.windowPosition);
     qsettings.setValue("wordWrap", settings.wordWrapEnabled);
     qsettings.setValue("editorFontSize", settings.editorFontSize);
+    qsettings.setValue("editJournal", settings.editJournalEnabled);
+    qsettings.setValue("scriptTimeout", settings.scriptTimeoutSeconds);
+    qsettings.setValue("runspacePoolSize", settings.runspacePoolSize);
+    qsettings.setValue("preloadModules", settings.preloadModules);
+    qsettings.setValue("stickySession", settings.stickySession);
 
     qsettings.endGroup();
 }
@@ -65,6 +70,11 @@ UserSettings SettingsManager::loadSettings()
         settings.windowPosition = qsettings.value("windowPosition", QVariant::fromValue(settings.windowPosition)).toPoint();
         settings.wordWrapEnabled = qsettings.value("wordWrap", QVariant::fromValue(settings.wordWrapEnabled)).toBool();
         settings.editorFontSize = qsettings.value("editorFontSize", QVariant::fromValue(settings.editorFontSize)).toInt();
+        settings.editJournalEnabled = qsettings.value("editJournal", QVariant::fromValue(settings.editJournalEnabled)).toBool();
+        settings.scriptTimeoutSeconds = qsettings.value("scriptTimeout", QVariant::fromValue(settings.scriptTimeoutSeconds)).toInt();
+        settings.runspacePoolSize = qsettings.value("runspacePoolSize", QVariant::fromValue(settings.runspacePoolSize)).toInt();
+        settings.preloadModules = qsettings.value("preloadModules", QVariant::fromValue(settings.preloadModules)).toStringList();
+        settings.stickySession = qsettings.value("stickySession", QVariant::fromValue(settings.stickySession)).toBool();
     }
     catch (...)
     {
@@ -6,6 +6,7 @@
 #define USERSETTINGS_H
 
 #include <QString>
+#include <QStringList>
 #include <QSize>
 #include <QPoint>
 
@@ -18,6 +19,15 @@ struct UserSettings {
     QPoint windowPosition = QPoint(100, 100);
     bool wordWrapEnabled = true;
     int editorFontSize = 11;
+    // Auto save appends edits to a journal and rewrites the file only when idle
+    bool editJournalEnabled = true;
+    // Scripts still running after this long are stopped, 0 lets them run forever
+    int scriptTimeoutSeconds = 0;
+    // Runspaces the PowerShell bridge keeps open, with these modules imported
+    int runspacePoolSize = 4;
+    QStringList preloadModules;
+    // Run scripts in one runspace that keeps variables and imports between runs
+    bool stickySession = false;
 };
 
 #endif // USERSETTINGS_H
@@ -0,0 +1,84 @@
+//
+// Created by talik on 10/18/2026.
+//
+
+#ifndef SPSC_QUEUE_H
+#define SPSC_QUEUE_H
+
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <memory>
+#include <utility>
+
+/**
+ * Bounded lock-free queue between one producer thread and one consumer thread.
+ *
+ * The slots form a ring indexed by two counters that only ever grow: the
+ * producer alone writes the tail and the consumer alone writes the head, so
+ * neither side waits for the other or takes a lock. A full queue refuses
+ * push() rather than blocking the producer.
+ */
+template <typename T>
+class SpscQueue final
+{
+public:
+    // Holds capacity rounded up to a power of two
+    explicit SpscQueue(const std::size_t capacity)
+        : m_capacity(std::bit_ceil(capacity)), m_slots(std::make_unique<T[]>(m_capacity))
+    {
+    }
+
+    SpscQueue(const SpscQueue&) = delete;
+
+    SpscQueue& operator=(const SpscQueue&) = delete;
+
+    // Producer only. False when the queue is full, value is left as it was.
+    bool push(T&& value)
+    {
+        const std::size_t tail = m_tail.load(std::memory_order_relaxed);
+        if (tail - m_head.load(std::memory_order_acquire) == m_capacity)
+        {
+            return false;
+        }
+
+        m_slots[tail & (m_capacity - 1)] = std::move(value);
+        m_tail.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Consumer only. False when the queue is empty.
+    bool pop(T& value)
+    {
+        const std::size_t head = m_head.load(std::memory_order_relaxed);
+        if (head == m_tail.load(std::memory_order_acquire))
+        {
+            return false;
+        }
+
+        // The slot lets go of what it held, it may not be written again for a while
+        value = std::exchange(m_slots[head & (m_capacity - 1)], T());
+        m_head.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Either side; may be stale by the time it returns
+    [[nodiscard]] std::size_t size() const
+    {
+        // Head first: the tail read after it is never behind it
+        const std::size_t head = m_head.load(std::memory_order_acquire);
+        return m_tail.load(std::memory_order_acquire) - head;
+    }
+
+    [[nodiscard]] std::size_t capacity() const { return m_capacity; }
+
+private:
+    const std::size_t m_capacity;
+    std::unique_ptr<T[]> m_slots;
+
+    // On cache lines of their own, so the two threads do not take them from each other
+    alignas(64) std::atomic<std::size_t> m_head{0};
+    alignas(64) std::atomic<std::size_t> m_tail{0};
+};
+
+#endif //SPSC_QUEUE_H
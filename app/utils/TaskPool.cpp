@@ -0,0 +1,202 @@
+//
+// Created by talik on 10/18/2026.
+//
+
+#include "TaskPool.h"
+
+#include <algorithm>
+#include <QDebug>
+
+namespace
+{
+    // Set on the pool's own threads, so that tasks they post stay with them
+    thread_local const TaskPool* currentPool = nullptr;
+    thread_local unsigned currentWorker = 0;
+
+    void runTask(const TaskPool::Task& task)
+    {
+        try
+        {
+            task();
+        }
+        catch (const std::exception& e)
+        {
+            qWarning() << "Background task failed:" << e.what();
+        }
+        catch (...)
+        {
+            qWarning() << "Background task failed: Unknown exception";
+        }
+    }
+}
+
+TaskPool& TaskPool::instance()
+{
+    static TaskPool pool;
+    return pool;
+}
+
+TaskPool::TaskPool(const unsigned workerCount)
+{
+    // hardware_concurrency() may not know
+    const unsigned count = std::max(1u, workerCount);
+
+    m_workers.reserve(count);
+    for (unsigned i = 0; i < count; ++i)
+    {
+        m_workers.push_back(std::make_unique<Worker>());
+    }
+
+    m_threads.reserve(count);
+    for (unsigned i = 0; i < count; ++i)
+    {
+        m_threads.emplace_back(&TaskPool::work, this, i);
+    }
+}
+
+TaskPool::~TaskPool()
+{
+    {
+        std::lock_guard lock(m_sleepMutex);
+        m_stopping = true;
+    }
+    m_wake.notify_all();
+
+    for (std::thread& thread : m_threads)
+    {
+        thread.join();
+    }
+}
+
+void TaskPool::post(Task task)
+{
+    const unsigned index = currentPool == this
+                               ? currentWorker
+                               : m_nextWorker.fetch_add(1, std::memory_order_relaxed) % workerCount();
+    {
+        Worker& worker = *m_workers[index];
+        std::lock_guard lock(worker.mutex);
+        worker.tasks.push_back(std::move(task));
+    }
+
+    // Counted under the sleep mutex, so a worker about to sleep cannot miss it
+    {
+        std::lock_guard lock(m_sleepMutex);
+        m_pending.fetch_add(1, std::memory_order_relaxed);
+    }
+    m_wake.notify_one();
+}
+
+void TaskPool::work(const unsigned index)
+{
+    currentPool = this;
+    currentWorker = index;
+
+    Task task;
+    while (true)
+    {
+        if (take(index, task))
+        {
+            runTask(task);
+            task = nullptr;
+            continue;
+        }
+
+        std::unique_lock lock(m_sleepMutex);
+        if (m_pending.load(std::memory_order_relaxed) > 0)
+        {
+            // Another worker took the task but has not counted it yet
+            lock.unlock();
+            std::this_thread::yield();
+            continue;
+        }
+
+        if (m_stopping)
+        {
+            return;
+        }
+
+        m_wake.wait(lock, [this] { return m_stopping || m_pending.load(std::memory_order_relaxed) > 0; });
+    }
+}
+
+bool TaskPool::take(const unsigned index, Task& task)
+{
+    // Newest first from its own deque, the tasks a running task just posted are still warm
+    {
+        Worker& own = *m_workers[index];
+        std::lock_guard lock(own.mutex);
+        if (!own.tasks.empty())
+        {
+            task = std::move(own.tasks.back());
+            own.tasks.pop_back();
+            m_pending.fetch_sub(1, std::memory_order_relaxed);
+            return true;
+        }
+    }
+
+    // Oldest first from the others
+    const unsigned count = workerCount();
+    for (unsigned i = 1; i < count; ++i)
+    {
+        Worker& victim = *m_workers[(index + i) % count];
+        std::unique_lock lock(victim.mutex, std::try_to_lock);
+        if (lock.owns_lock() && !victim.tasks.empty())
+        {
+            task = std::move(victim.tasks.front());
+            victim.tasks.pop_front();
+            m_pending.fetch_sub(1, std::memory_order_relaxed);
+            return true;
+        }
+    }
+
+    return false;
+}
+
+TaskStrand::TaskStrand(TaskPool& pool) : m_pool(pool), m_state(std::make_shared<State>())
+{
+}
+
+TaskStrand::~TaskStrand()
+{
+    wait();
+}
+
+void TaskStrand::post(TaskPool::Task task)
+{
+    {
+        std::lock_guard lock(m_state->mutex);
+        m_state->tasks.push_back(std::move(task));
+        if (m_state->scheduled)
+        {
+            // The running drain() picks it up
+            return;
+        }
+        m_state->scheduled = true;
+    }
+
+    m_pool.post([state = m_state] { drain(state); });
+}
+
+void TaskStrand::wait()
+{
+    std::unique_lock lock(m_state->mutex);
+    m_state->drained.wait(lock, [this] { return !m_state->scheduled; });
+}
+
+void TaskStrand::drain(const std::shared_ptr<State>& state)
+{
+    std::unique_lock lock(state->mutex);
+    while (!state->tasks.empty())
+    {
+        const TaskPool::Task task = std::move(state->tasks.front());
+        state->tasks.pop_front();
+
+        lock.unlock();
+        runTask(task);
+        lock.lock();
+    }
+
+    state->scheduled = false;
+    state->drained.notify_all();
+}
@@ -0,0 +1,157 @@
+//
+// Created by talik on 10/18/2026.
+//
+
+#ifndef TASK_POOL_H
+#define TASK_POOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+#include <QFuture>
+#include <QPromise>
+
+/**
+ * The application's worker threads, one per core.
+ *
+ * Every worker owns a deque of tasks. A task posted from a worker goes to the
+ * back of that worker's deque and is taken from there again, while idle
+ * workers steal from the front of the others; tasks posted from any other
+ * thread are dealt to the workers in turn. Background work of every kind
+ * shares these threads instead of starting threads of its own.
+ *
+ * run() returns a QFuture, so results are picked up on the GUI thread with
+ * QFuture::then(context, ...), which calls the continuation in the thread of
+ * context. Work that has to run in order, like everything done on behalf of
+ * one editor, goes through a TaskStrand.
+ *
+ * Tasks must not wait on each other; a blocked task holds its worker.
+ */
+class TaskPool final
+{
+public:
+    using Task = std::function<void()>;
+
+    // Workers are joined when the application exits, after finishing every task posted
+    static TaskPool& instance();
+
+    explicit TaskPool(unsigned workerCount = std::thread::hardware_concurrency());
+
+    ~TaskPool();
+
+    TaskPool(const TaskPool&) = delete;
+
+    TaskPool& operator=(const TaskPool&) = delete;
+
+    void post(Task task);
+
+    /**
+     * Runs task on a worker and returns its result. An exception thrown by
+     * task is rethrown where the result is read, or reaches onFailed().
+     */
+    template <typename F>
+    auto run(F&& task) -> QFuture<std::invoke_result_t<std::decay_t<F>>>
+    {
+        using Result = std::invoke_result_t<std::decay_t<F>>;
+
+        // QPromise cannot be copied into a std::function
+        auto promise = std::make_shared<QPromise<Result>>();
+        QFuture<Result> future = promise->future();
+        promise->start();
+
+        post([promise, task = std::forward<F>(task)]() mutable
+        {
+            try
+            {
+                if constexpr (std::is_void_v<Result>)
+                {
+                    task();
+                }
+                else
+                {
+                    promise->addResult(task());
+                }
+            }
+            catch (...)
+            {
+                promise->setException(std::current_exception());
+            }
+            promise->finish();
+        });
+
+        return future;
+    }
+
+    [[nodiscard]] unsigned workerCount() const { return static_cast<unsigned>(m_workers.size()); }
+
+private:
+    struct Worker
+    {
+        std::mutex mutex;
+        std::deque<Task> tasks;
+    };
+
+    std::vector<std::unique_ptr<Worker>> m_workers;
+    std::vector<std::thread> m_threads;
+
+    // Posted tasks not taken by a worker yet
+    std::atomic<int> m_pending{0};
+    std::atomic<unsigned> m_nextWorker{0};
+
+    std::mutex m_sleepMutex;
+    std::condition_variable m_wake;
+    bool m_stopping = false;
+
+    void work(unsigned index);
+
+    bool take(unsigned index, Task& task);
+};
+
+/**
+ * Runs the tasks posted to it one after the other, in the order they were
+ * posted, on the workers of a TaskPool. Different strands run side by side.
+ *
+ * The destructor waits for the tasks already posted, so whatever they use
+ * has to outlive the strand.
+ */
+class TaskStrand final
+{
+public:
+    explicit TaskStrand(TaskPool& pool = TaskPool::instance());
+
+    ~TaskStrand();
+
+    TaskStrand(const TaskStrand&) = delete;
+
+    TaskStrand& operator=(const TaskStrand&) = delete;
+
+    void post(TaskPool::Task task);
+
+    // Blocks until every task posted so far has run
+    void wait();
+
+private:
+    struct State
+    {
+        std::mutex mutex;
+        std::condition_variable drained;
+        std::deque<TaskPool::Task> tasks;
+        // A drain() is posted to the pool or running
+        bool scheduled = false;
+    };
+
+    TaskPool& m_pool;
+    // Shared with the drain() in flight
+    std::shared_ptr<State> m_state;
+
+    static void drain(const std::shared_ptr<State>& state);
+};
+
+#endif //TASK_POOL_H
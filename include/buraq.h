@@ -27,9 +27,9 @@
 #ifndef BURAQ_API_H
 #define BURAQ_API_H
 
+#include <cstdint>
 #include <filesystem>
 #include <string>
-#include <set>
 #include <map>
 
 namespace buraq
@@ -42,30 +42,37 @@ namespace buraq
         std::map<std::string, std::string> plugins;
     };
 
+    /**
+     * What the line number gutter needs to know about the editor.
+     *
+     * Plain values only, so it is copied without allocating on every cursor move.
+     * The editor bumps revision whenever a field changes.
+     */
     struct EditorState
     {
-        bool hasText;
-        bool isBlockValid;
-        bool isSelected;
-        int blockCount;
-        int cursorBlockNumber;
-        int blockNumber;
-        int lineHeight;
-        int currentLineHeight;
-        std::set<int> selectedBlockNumbers;
+        int blockCount = 0;
+        int cursorBlockNumber = 0;
+        int lineHeight = 0;
+        // First block shown by the editor and the y of its top edge, in viewport coordinates
+        int firstVisibleBlock = 0;
+        int firstVisibleBlockTop = 0;
+        // First and last block touched by the selection, both -1 without a selection
+        int selectionFirstBlock = -1;
+        int selectionLastBlock = -1;
+        std::uint64_t revision = 0;
 
-        // For the updateEditorState check if states are different
-        bool operator!=(const EditorState& other) const
-        {
-            return blockCount != other.blockCount ||
-                blockNumber != other.blockNumber ||
-                cursorBlockNumber != other.cursorBlockNumber;
-        }
+        [[nodiscard]] bool hasSelection() const { return selectionFirstBlock >= 0; }
 
-        bool operator==(const EditorState& other) const
+        // Whether the blocks move on screen, as opposed to only the cursor or the selection
+        [[nodiscard]] bool hasSameGeometry(const EditorState& other) const
         {
-            return !(*this != other);
+            return blockCount == other.blockCount &&
+                lineHeight == other.lineHeight &&
+                firstVisibleBlock == other.firstVisibleBlock &&
+                firstVisibleBlockTop == other.firstVisibleBlockTop;
         }
+
+        bool operator==(const EditorState& other) const = default;
     };
 }
 